@@ -48,6 +48,17 @@ class LengthHeaderCodec : muduo::noncopyable
     }
   }
 
+  // the frame of message, to be shared by many connections
+  muduo::string encode(const muduo::StringPiece& message) const
+  {
+    muduo::string frame(kHeaderLen, '\0');
+    int32_t len = static_cast<int32_t>(message.size());
+    int32_t be32 = muduo::net::sockets::hostToNetwork32(len);
+    memcpy(&*frame.begin(), &be32, sizeof be32);
+    frame.append(message.data(), message.size());
+    return frame;
+  }
+
   // FIXME: TcpConnectionPtr
   void send(muduo::net::TcpConnection* conn,
             const muduo::StringPiece& message)
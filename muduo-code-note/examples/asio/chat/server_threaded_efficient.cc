@@ -68,13 +68,9 @@ class ChatServer : noncopyable
                        const string& message,
                        Timestamp)
   {
-    ConnectionListPtr connections = getConnectionList();;
-    for (ConnectionList::iterator it = connections->begin();
-        it != connections->end();
-        ++it)
-    {
-      codec_.send(get_pointer(*it), message);
-    }
+    ConnectionListPtr connections = getConnectionList();
+    std::shared_ptr<const string> frame(new string(codec_.encode(message)));
+    TcpServer::broadcast(*connections, frame);
   }
 
   ConnectionListPtr getConnectionList()
@@ -42,13 +42,9 @@ class Topic : public muduo::copyable
   {
     content_ = content;
     lastPubTime_ = time;
-    string message = makeMessage();
-    for (std::set<TcpConnectionPtr>::iterator it = audiences_.begin();
-         it != audiences_.end();
-         ++it)
-    {
-      (*it)->send(message);
-    }
+    // shared by all audiences, instead of one copy each
+    std::shared_ptr<const string> message(new string(makeMessage()));
+    TcpServer::broadcast(audiences_, message);
   }
 
  private:
@@ -0,0 +1,120 @@
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+// RFC 862
+// One timer per connection, re-armed on every message.
+// With the timing wheel, runAfter() and cancel() are O(1),
+// no need to bucket connections by hand as echo.cc does.
+class EchoServer
+{
+ public:
+  EchoServer(EventLoop* loop,
+             const InetAddress& listenAddr,
+             int idleSeconds);
+
+  void start()
+  {
+    server_.start();
+  }
+
+ private:
+  void onConnection(const TcpConnectionPtr& conn);
+
+  void onMessage(const TcpConnectionPtr& conn,
+                 Buffer* buf,
+                 Timestamp time);
+
+  void resetTimer(const TcpConnectionPtr& conn);
+
+  static void onIdle(const std::weak_ptr<TcpConnection>& weakConn);
+
+  EventLoop* loop_;
+  TcpServer server_;
+  int idleSeconds_;
+};
+
+EchoServer::EchoServer(EventLoop* loop,
+                       const InetAddress& listenAddr,
+                       int idleSeconds)
+  : loop_(loop),
+    server_(loop, listenAddr, "EchoServer"),
+    idleSeconds_(idleSeconds)
+{
+  server_.setConnectionCallback(
+      std::bind(&EchoServer::onConnection, this, _1));
+  server_.setMessageCallback(
+      std::bind(&EchoServer::onMessage, this, _1, _2, _3));
+}
+
+void EchoServer::onConnection(const TcpConnectionPtr& conn)
+{
+  LOG_INFO << "EchoServer - " << conn->peerAddress().toIpPort() << " -> "
+           << conn->localAddress().toIpPort() << " is "
+           << (conn->connected() ? "UP" : "DOWN");
+
+  if (conn->connected())
+  {
+    resetTimer(conn);
+  }
+  else if (!conn->getContext().empty())
+  {
+    loop_->cancel(boost::any_cast<TimerId>(conn->getContext()));
+  }
+}
+
+void EchoServer::onMessage(const TcpConnectionPtr& conn,
+                           Buffer* buf,
+                           Timestamp time)
+{
+  string msg(buf->retrieveAllAsString());
+  LOG_INFO << conn->name() << " echo " << msg.size()
+           << " bytes at " << time.toString();
+  conn->send(msg);
+  resetTimer(conn);
+}
+
+void EchoServer::resetTimer(const TcpConnectionPtr& conn)
+{
+  if (!conn->getContext().empty())
+  {
+    loop_->cancel(boost::any_cast<TimerId>(conn->getContext()));
+  }
+  std::weak_ptr<TcpConnection> weakConn(conn);
+  conn->setContext(loop_->runAfter(idleSeconds_,
+                                   std::bind(&EchoServer::onIdle, weakConn)));
+}
+
+void EchoServer::onIdle(const std::weak_ptr<TcpConnection>& weakConn)
+{
+  TcpConnectionPtr conn = weakConn.lock();
+  if (conn && conn->connected())
+  {
+    conn->shutdown();
+    LOG_INFO << "shutting down " << conn->name();
+    conn->forceCloseWithDelay(3.5);  // > round trip of the whole Internet.
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  // before EventLoop is created, unless set by user.
+  ::setenv("MUDUO_USE_TIMERWHEEL", "1", 0);
+  EventLoop loop;
+  InetAddress listenAddr(2007);
+  int idleSeconds = 10;
+  if (argc > 1)
+  {
+    idleSeconds = atoi(argv[1]);
+  }
+  LOG_INFO << "pid = " << getpid() << ", idle seconds = " << idleSeconds;
+  EchoServer server(&loop, listenAddr, idleSeconds);
+  server.start();
+  loop.loop();
+}
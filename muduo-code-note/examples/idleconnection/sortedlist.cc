@@ -37,7 +37,7 @@ class EchoServer
 
   struct Node : public muduo::copyable
   {
-    Timestamp lastReceiveTime;
+    MonotonicTime lastReceiveTime;
     WeakConnectionList::iterator position;
   };
 
@@ -69,7 +69,7 @@ void EchoServer::onConnection(const TcpConnectionPtr& conn)
   if (conn->connected())
   {
     Node node;
-    node.lastReceiveTime = Timestamp::now();
+    node.lastReceiveTime = conn->getLoop()->now();
     connectionList_.push_back(conn);
     node.position = --connectionList_.end();
     conn->setContext(node);
@@ -94,7 +94,7 @@ void EchoServer::onMessage(const TcpConnectionPtr& conn,
 
   assert(!conn->getContext().empty());
   Node* node = boost::any_cast<Node>(conn->getMutableContext());
-  node->lastReceiveTime = time;
+  node->lastReceiveTime = conn->getLoop()->now();
   connectionList_.splice(connectionList_.end(), connectionList_, node->position);
   assert(node->position == --connectionList_.end());
 
@@ -104,7 +104,7 @@ void EchoServer::onMessage(const TcpConnectionPtr& conn,
 void EchoServer::onTimer()
 {
   dumpConnectionList();
-  Timestamp now = Timestamp::now();
+  MonotonicTime now = server_.getLoop()->now();
   for (WeakConnectionList::iterator it = connectionList_.begin();
       it != connectionList_.end();)
   {
@@ -122,11 +122,6 @@ void EchoServer::onTimer()
           conn->forceCloseWithDelay(3.5);  // > round trip of the whole Internet.
         }
       }
-      else if (age < 0)
-      {
-        LOG_WARN << "Time jump";
-        n->lastReceiveTime = now;
-      }
       else
       {
         break;
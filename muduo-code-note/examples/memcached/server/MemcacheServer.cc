@@ -158,6 +158,8 @@ void MemcacheServer::onConnection(const TcpConnectionPtr& conn)
 {
   if (conn->connected())
   {
+    // multi-get and pipelined commands reply in one write
+    conn->setAutoCork(options_.autoCork);
     SessionPtr session(new Session(this, conn));
     MutexLockGuard lock(mutex_);
     assert(sessions_.find(conn->name()) == sessions_.end());
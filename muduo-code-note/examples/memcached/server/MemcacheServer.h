@@ -22,6 +22,7 @@ class MemcacheServer : muduo::noncopyable
     uint16_t udpport;
     uint16_t gperfport;
     int threads;
+    bool autoCork;
   };
 
   MemcacheServer(muduo::net::EventLoop* loop, const Options&);
@@ -22,6 +22,7 @@ bool parseCommandLine(int argc, char* argv[], MemcacheServer::Options* options)
       ("udpport,U", po::value<uint16_t>(&options->udpport), "UDP port")
       ("gperf,g", po::value<uint16_t>(&options->gperfport), "port for gperftools")
       ("threads,t", po::value<int>(&options->threads), "Number of worker threads")
+      ("autocork", po::bool_switch(&options->autoCork), "Coalesce replies of one read")
       ;
 
   po::variables_map vm;
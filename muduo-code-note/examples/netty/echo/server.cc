@@ -9,12 +9,15 @@
 #include <utility>
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 using namespace muduo;
 using namespace muduo::net;
 
 int numThreads = 0;
+bool completionMode = false;  // needs MUDUO_USE_URING
+bool edgeTriggered = false;  // needs the default EPollPoller
 
 class EchoServer
 {
@@ -29,6 +32,8 @@ class EchoServer
     server_.setMessageCallback(
         std::bind(&EchoServer::onMessage, this, _1, _2, _3));
     server_.setThreadNum(numThreads);
+    server_.setCompletionMode(completionMode);
+    server_.setEdgeTriggered(edgeTriggered);
     loop->runEvery(3.0, std::bind(&EchoServer::printThroughput, this));
   }
 
@@ -85,6 +90,11 @@ int main(int argc, char* argv[])
   {
     numThreads = atoi(argv[1]);
   }
+  if (argc > 2)
+  {
+    completionMode = strcmp(argv[2], "completion") == 0;
+    edgeTriggered = strcmp(argv[2], "edge") == 0;
+  }
   EventLoop loop;
   InetAddress listenAddr(2007);
   EchoServer server(&loop, listenAddr);
@@ -9,6 +9,7 @@
 #include <utility>
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 using namespace muduo;
@@ -31,7 +32,7 @@ int main(int argc, char* argv[])
 {
   if (argc < 4)
   {
-    fprintf(stderr, "Usage: server <address> <port> <threads>\n");
+    fprintf(stderr, "Usage: server <address> <port> <threads> [completion|edge]\n");
   }
   else
   {
@@ -49,6 +50,10 @@ int main(int argc, char* argv[])
 
     server.setConnectionCallback(onConnection);
     server.setMessageCallback(onMessage);
+    // needs MUDUO_USE_URING
+    server.setCompletionMode(argc > 4 && strcmp(argv[4], "completion") == 0);
+    // needs the default EPollPoller
+    server.setEdgeTriggered(argc > 4 && strcmp(argv[4], "edge") == 0);
 
     if (threadCount > 1)
     {
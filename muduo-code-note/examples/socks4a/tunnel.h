@@ -5,6 +5,7 @@
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/InetAddress.h>
 #include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpRelay.h>
 #include <muduo/net/TcpServer.h>
 
 class Tunnel : public std::enable_shared_from_this<Tunnel>,
@@ -36,10 +37,6 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
         std::bind(&Tunnel::onClientConnection, shared_from_this(), _1));
     client_.setMessageCallback(
         std::bind(&Tunnel::onClientMessage, shared_from_this(), _1, _2, _3));
-    serverConn_->setHighWaterMarkCallback(
-        std::bind(&Tunnel::onHighWaterMarkWeak,
-                  std::weak_ptr<Tunnel>(shared_from_this()), kServer, _1, _2),
-        1024*1024);
   }
 
   void connect()
@@ -49,6 +46,10 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
 
   void disconnect()
   {
+    if (relay_)
+    {
+      relay_->stop();
+    }
     client_.disconnect();
     // serverConn_.reset();
   }
@@ -58,6 +59,11 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
   {
     client_.setConnectionCallback(muduo::net::defaultConnectionCallback);
     client_.setMessageCallback(muduo::net::defaultMessageCallback);
+    if (relay_)
+    {
+      relay_->stop();
+      relay_.reset();
+    }
     if (serverConn_)
     {
       serverConn_->setContext(boost::any());
@@ -68,24 +74,16 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
 
   void onClientConnection(const muduo::net::TcpConnectionPtr& conn)
   {
-    using std::placeholders::_1;
-    using std::placeholders::_2;
-
     LOG_DEBUG << (conn->connected() ? "UP" : "DOWN");
     if (conn->connected())
     {
       conn->setTcpNoDelay(true);
-      conn->setHighWaterMarkCallback(
-          std::bind(&Tunnel::onHighWaterMarkWeak,
-                    std::weak_ptr<Tunnel>(shared_from_this()), kClient, _1, _2),
-          1024*1024);
       serverConn_->setContext(conn);
-      serverConn_->startRead();
       clientConn_ = conn;
-      if (serverConn_->inputBuffer()->readableBytes() > 0)
-      {
-        conn->send(serverConn_->inputBuffer());
-      }
+      // forwards what the server connection has read so far,
+      // pauses either side when the other can't keep up
+      relay_.reset(new muduo::net::TcpRelay(serverConn_, conn));
+      relay_->start();
     }
     else
     {
@@ -97,98 +95,16 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
                        muduo::net::Buffer* buf,
                        muduo::Timestamp)
   {
+    // relay_ takes over once connected
     LOG_DEBUG << conn->name() << " " << buf->readableBytes();
-    if (serverConn_)
-    {
-      serverConn_->send(buf);
-    }
-    else
-    {
-      buf->retrieveAll();
-      abort();
-    }
-  }
-
-  enum ServerClient
-  {
-    kServer, kClient
-  };
-
-  void onHighWaterMark(ServerClient which,
-                       const muduo::net::TcpConnectionPtr& conn,
-                       size_t bytesToSent)
-  {
-    using std::placeholders::_1;
-
-    LOG_INFO << (which == kServer ? "server" : "client")
-             << " onHighWaterMark " << conn->name()
-             << " bytes " << bytesToSent;
-
-    if (which == kServer)
-    {
-      if (serverConn_->outputBuffer()->readableBytes() > 0)
-      {
-        clientConn_->stopRead();
-        serverConn_->setWriteCompleteCallback(
-            std::bind(&Tunnel::onWriteCompleteWeak,
-                      std::weak_ptr<Tunnel>(shared_from_this()), kServer, _1));
-      }
-    }
-    else
-    {
-      if (clientConn_->outputBuffer()->readableBytes() > 0)
-      {
-        serverConn_->stopRead();
-        clientConn_->setWriteCompleteCallback(
-            std::bind(&Tunnel::onWriteCompleteWeak,
-                      std::weak_ptr<Tunnel>(shared_from_this()), kClient, _1));
-      }
-    }
-  }
-
-  static void onHighWaterMarkWeak(const std::weak_ptr<Tunnel>& wkTunnel,
-                                  ServerClient which,
-                                  const muduo::net::TcpConnectionPtr& conn,
-                                  size_t bytesToSent)
-  {
-    std::shared_ptr<Tunnel> tunnel = wkTunnel.lock();
-    if (tunnel)
-    {
-      tunnel->onHighWaterMark(which, conn, bytesToSent);
-    }
-  }
-
-  void onWriteComplete(ServerClient which, const muduo::net::TcpConnectionPtr& conn)
-  {
-    LOG_INFO << (which == kServer ? "server" : "client")
-             << " onWriteComplete " << conn->name();
-    if (which == kServer)
-    {
-      clientConn_->startRead();
-      serverConn_->setWriteCompleteCallback(muduo::net::WriteCompleteCallback());
-    }
-    else
-    {
-      serverConn_->startRead();
-      clientConn_->setWriteCompleteCallback(muduo::net::WriteCompleteCallback());
-    }
-  }
-
-  static void onWriteCompleteWeak(const std::weak_ptr<Tunnel>& wkTunnel,
-                                  ServerClient which,
-                                  const muduo::net::TcpConnectionPtr& conn)
-  {
-    std::shared_ptr<Tunnel> tunnel = wkTunnel.lock();
-    if (tunnel)
-    {
-      tunnel->onWriteComplete(which, conn);
-    }
+    buf->retrieveAll();
   }
 
  private:
   muduo::net::TcpClient client_;
   muduo::net::TcpConnectionPtr serverConn_;
   muduo::net::TcpConnectionPtr clientConn_;
+  muduo::net::TcpRelayPtr relay_;
 };
 typedef std::shared_ptr<Tunnel> TunnelPtr;
 
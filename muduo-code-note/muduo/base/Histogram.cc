@@ -0,0 +1,104 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/base/Histogram.h>
+
+#include <stdio.h>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+using namespace muduo;
+
+const int Histogram::kSubBucketBits;
+const int Histogram::kSubBuckets;
+const int Histogram::kMaxBits;
+const int Histogram::kNumBuckets;
+
+Histogram::Histogram()
+{
+  reset();
+}
+
+void Histogram::reset()
+{
+  for (int i = 0; i < kNumBuckets; ++i)
+  {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::merge(const Histogram& other)
+{
+  for (int i = 0; i < kNumBuckets; ++i)
+  {
+    increment(&counts_[i], other.counts_[i].load(std::memory_order_relaxed));
+  }
+  increment(&count_, other.count_.load(std::memory_order_relaxed));
+  increment(&sum_, other.sum_.load(std::memory_order_relaxed));
+  if (other.max() > max())
+  {
+    max_.store(other.max(), std::memory_order_relaxed);
+  }
+}
+
+int64_t Histogram::highestOf(int bucket)
+{
+  if (bucket < kSubBuckets)
+  {
+    return bucket;
+  }
+  int shift = bucket / kSubBuckets - 1;
+  int64_t lowest = static_cast<int64_t>(bucket % kSubBuckets + kSubBuckets) << shift;
+  return lowest + (int64_t(1) << shift) - 1;
+}
+
+double Histogram::mean() const
+{
+  int64_t n = count();
+  return n > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+}
+
+int64_t Histogram::percentile(double percent) const
+{
+  int64_t n = count();
+  if (n == 0)
+  {
+    return 0;
+  }
+  int64_t rank = static_cast<int64_t>(static_cast<double>(n) * percent / 100.0 + 0.5);
+  if (rank < 1)
+  {
+    rank = 1;
+  }
+  int64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i)
+  {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+    {
+      // never above the largest recorded
+      int64_t highest = highestOf(i);
+      int64_t largest = max();
+      return highest < largest ? highest : largest;
+    }
+  }
+  return max();
+}
+
+string Histogram::toString() const
+{
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           "count %" PRId64 " mean %.1f p50 %" PRId64 " p90 %" PRId64
+           " p99 %" PRId64 " p999 %" PRId64 " max %" PRId64,
+           count(), mean(), percentile(50), percentile(90),
+           percentile(99), percentile(99.9), max());
+  return buf;
+}
@@ -0,0 +1,102 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef MUDUO_BASE_HISTOGRAM_H
+#define MUDUO_BASE_HISTOGRAM_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Types.h>
+
+#include <atomic>
+
+namespace muduo
+{
+
+///
+/// Histogram of non-negative integers, with HDR style buckets.
+///
+/// Values below 16 have a bucket each, above they are grouped by powers
+/// of two, each split into 16 buckets, so a percentile is at most 1/16
+/// above the actual value. Values of 2^40 and above are counted as
+/// 2^40-1, about 12 days in microseconds.
+///
+/// record() is a few plain stores, for one writer thread, e.g. an
+/// EventLoop recording always. Other threads may read at any time,
+/// what they see is a slightly inconsistent snapshot.
+class Histogram : noncopyable
+{
+ public:
+  static const int kSubBucketBits = 4;
+  static const int kSubBuckets = 1 << kSubBucketBits;
+  static const int kMaxBits = 40;
+  static const int kNumBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+  Histogram();
+
+  /// In the writer thread.
+  void record(int64_t value)
+  {
+    if (value < 0)
+    {
+      value = 0;
+    }
+    increment(&counts_[bucketOf(value)], 1);
+    increment(&count_, 1);
+    increment(&sum_, value);
+    if (value > max_.load(std::memory_order_relaxed))
+    {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  int64_t count() const { return count_.load(std::memory_order_relaxed); }
+  int64_t max() const { return max_.load(std::memory_order_relaxed); }
+  double mean() const;
+  /// The value @c percent of all are at or below, 0 if empty.
+  int64_t percentile(double percent) const;
+
+  /// "count 10 mean 1.5 p50 1 p90 3 p99 7 p999 7 max 7"
+  string toString() const;
+
+  /// In the writer thread, or while nobody records. record() racing
+  /// with it may store counts from before the reset back.
+  void reset();
+  /// Adds counts of @c other, e.g. histograms of several writers, into
+  /// one that nobody records. Thread safe for @c other.
+  void merge(const Histogram& other);
+
+  static int bucketOf(int64_t value)
+  {
+    if (value < kSubBuckets)
+    {
+      return static_cast<int>(value);
+    }
+    if (value >= (int64_t(1) << kMaxBits))
+    {
+      value = (int64_t(1) << kMaxBits) - 1;
+    }
+    int msb = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+  }
+
+  /// The largest value counted in @c bucket.
+  static int64_t highestOf(int bucket);
+
+ private:
+  static void increment(std::atomic<int64_t>* counter, int64_t delta)
+  {
+    // only one writer, no need of a locked add
+    counter->store(counter->load(std::memory_order_relaxed) + delta,
+                   std::memory_order_relaxed);
+  }
+
+  std::atomic<int64_t> counts_[kNumBuckets];
+  std::atomic<int64_t> count_;
+  std::atomic<int64_t> sum_;
+  std::atomic<int64_t> max_;
+};
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_HISTOGRAM_H
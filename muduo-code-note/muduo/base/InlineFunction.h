@@ -0,0 +1,221 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef MUDUO_BASE_INLINEFUNCTION_H
+#define MUDUO_BASE_INLINEFUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <assert.h>
+
+namespace muduo
+{
+
+template<typename Signature, size_t Size = 64>
+class InlineFunction;
+
+///
+/// A move-only std::function, with @c Size bytes of inline storage.
+///
+/// Callables up to @c Size bytes, such as std::bind() of a member function
+/// with this pointer, a string and a shared_ptr, are stored without
+/// allocating, so are lambdas capturing a move-only object.
+/// Bigger ones go to heap, as std::function does.
+/// A null function pointer or an empty std::function makes an empty one.
+template<typename R, typename... Args, size_t Size>
+class InlineFunction<R(Args...), Size>
+{
+ public:
+  InlineFunction() noexcept
+    : invoke_(NULL),
+      manage_(NULL)
+  {
+  }
+
+  InlineFunction(std::nullptr_t) noexcept
+    : invoke_(NULL),
+      manage_(NULL)
+  {
+  }
+
+  template<typename F,
+           typename = typename std::enable_if<
+               !std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+  InlineFunction(F&& f)
+    : invoke_(NULL),
+      manage_(NULL)
+  {
+    if (isNull(f))
+    {
+      return;
+    }
+    typedef typename std::decay<F>::type Functor;
+    typedef typename std::conditional<isInline<Functor>(),
+                                      InlineStore<Functor>,
+                                      HeapStore<Functor> >::type Store;
+    Store::create(&storage_, std::forward<F>(f));
+    invoke_ = &Store::invoke;
+    manage_ = &Store::manage;
+  }
+
+  InlineFunction(InlineFunction&& rhs) noexcept
+    : invoke_(NULL),
+      manage_(NULL)
+  {
+    moveFrom(rhs);
+  }
+
+  ~InlineFunction()
+  {
+    reset();
+  }
+
+  InlineFunction& operator=(InlineFunction&& rhs) noexcept
+  {
+    if (this != &rhs)
+    {
+      reset();
+      moveFrom(rhs);
+    }
+    return *this;
+  }
+
+  InlineFunction& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  explicit operator bool() const noexcept
+  {
+    return invoke_ != NULL;
+  }
+
+  R operator()(Args... args) const
+  {
+    assert(invoke_);
+    return invoke_(&storage_, std::forward<Args>(args)...);
+  }
+
+  /// Whether a callable of type @c F is stored without allocating.
+  template<typename F>
+  static constexpr bool isInline()
+  {
+    return sizeof(F) <= Size
+        && alignof(F) <= alignof(Storage)
+        && std::is_nothrow_move_constructible<F>::value;
+  }
+
+ private:
+  typedef typename std::aligned_storage<Size>::type Storage;
+  enum Operation { kMove, kDestroy };
+  typedef R (*Invoker)(Storage*, Args&&...);
+  typedef void (*Manager)(Operation, Storage* src, Storage* dest);
+
+  template<typename F>
+  struct InlineStore
+  {
+    template<typename G>
+    static void create(Storage* storage, G&& g)
+    {
+      ::new (static_cast<void*>(storage)) F(std::forward<G>(g));
+    }
+
+    static F* get(Storage* storage)
+    {
+      return reinterpret_cast<F*>(storage);
+    }
+
+    static R invoke(Storage* storage, Args&&... args)
+    {
+      return (*get(storage))(std::forward<Args>(args)...);
+    }
+
+    static void manage(Operation op, Storage* src, Storage* dest)
+    {
+      if (op == kMove)
+      {
+        ::new (static_cast<void*>(dest)) F(std::move(*get(src)));
+      }
+      get(src)->~F();
+    }
+  };
+
+  template<typename F>
+  struct HeapStore
+  {
+    template<typename G>
+    static void create(Storage* storage, G&& g)
+    {
+      *pointer(storage) = new F(std::forward<G>(g));
+    }
+
+    static F** pointer(Storage* storage)
+    {
+      return reinterpret_cast<F**>(storage);
+    }
+
+    static R invoke(Storage* storage, Args&&... args)
+    {
+      return (**pointer(storage))(std::forward<Args>(args)...);
+    }
+
+    static void manage(Operation op, Storage* src, Storage* dest)
+    {
+      if (op == kMove)
+      {
+        *pointer(dest) = *pointer(src);
+      }
+      else
+      {
+        delete *pointer(src);
+      }
+    }
+  };
+
+  // callables that std::function would take as empty
+  template<typename F>
+  static bool isNull(const F&) { return false; }
+  template<typename F>
+  static bool isNull(F* f) { return f == NULL; }
+  template<typename Signature, size_t N>
+  static bool isNull(const InlineFunction<Signature, N>& f) { return !f; }
+  template<typename Signature>
+  static bool isNull(const std::function<Signature>& f) { return !f; }
+
+  void moveFrom(InlineFunction& rhs) noexcept
+  {
+    if (rhs.manage_)
+    {
+      rhs.manage_(kMove, &rhs.storage_, &storage_);
+      invoke_ = rhs.invoke_;
+      manage_ = rhs.manage_;
+      rhs.invoke_ = NULL;
+      rhs.manage_ = NULL;
+    }
+  }
+
+  void reset() noexcept
+  {
+    if (manage_)
+    {
+      manage_(kDestroy, &storage_, NULL);
+      invoke_ = NULL;
+      manage_ = NULL;
+    }
+  }
+
+  mutable Storage storage_;
+  Invoker invoke_;
+  Manager manage_;
+};
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_INLINEFUNCTION_H
@@ -108,13 +108,14 @@ void defaultFlush()
 Logger::OutputFunc g_output = defaultOutput;
 Logger::FlushFunc g_flush = defaultFlush;
 TimeZone g_logTimeZone;
+bool g_logCoarseTime = false;
 
 }  // namespace muduo
 
 using namespace muduo;
 
 Logger::Impl::Impl(LogLevel level, int savedErrno, const SourceFile& file, int line)
-  : time_(Timestamp::now()),
+  : time_(g_logCoarseTime ? Timestamp::nowCoarse() : Timestamp::now()),
     stream_(),
     level_(level),
     line_(line),
@@ -225,3 +226,8 @@ void Logger::setTimeZone(const TimeZone& tz)
 {
   g_logTimeZone = tz;
 }
+
+void Logger::setCoarseTime(bool on)
+{
+  g_logCoarseTime = on;
+}
@@ -76,6 +76,9 @@ class Logger
   static void setOutput(OutputFunc);
   static void setFlush(FlushFunc);
   static void setTimeZone(const TimeZone& tz);
+  /// Stamps lines with Timestamp::nowCoarse(), the microseconds shown
+  /// are those of the last clock tick.
+  static void setCoarseTime(bool on);
 
  private:
 
@@ -0,0 +1,62 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/base/MonotonicTime.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+using namespace muduo;
+
+static_assert(sizeof(MonotonicTime) == sizeof(int64_t),
+              "MonotonicTime is same size as int64_t");
+
+namespace
+{
+
+int64_t microSecondsOf(clockid_t clock)
+{
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  int64_t seconds = ts.tv_sec;
+  return seconds * MonotonicTime::kMicroSecondsPerSecond + ts.tv_nsec / 1000;
+}
+
+}  // namespace
+
+string MonotonicTime::toString() const
+{
+  char buf[32] = {0};
+  int64_t seconds = microSeconds_ / kMicroSecondsPerSecond;
+  int64_t microseconds = microSeconds_ % kMicroSecondsPerSecond;
+  snprintf(buf, sizeof(buf)-1, "%" PRId64 ".%06" PRId64 "", seconds, microseconds);
+  return buf;
+}
+
+MonotonicTime MonotonicTime::now()
+{
+  return MonotonicTime(microSecondsOf(CLOCK_MONOTONIC));
+}
+
+MonotonicTime MonotonicTime::nowCoarse()
+{
+  return MonotonicTime(microSecondsOf(CLOCK_MONOTONIC_COARSE));
+}
+
+MonotonicTime MonotonicTime::fromTimestamp(Timestamp time)
+{
+  int64_t delta = time.microSecondsSinceEpoch() - Timestamp::now().microSecondsSinceEpoch();
+  return MonotonicTime(now().microSeconds() + delta);
+}
+
+Timestamp MonotonicTime::toTimestamp() const
+{
+  int64_t delta = microSeconds_ - now().microSeconds();
+  return Timestamp(Timestamp::now().microSecondsSinceEpoch() + delta);
+}
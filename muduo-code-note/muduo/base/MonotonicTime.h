@@ -0,0 +1,111 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef MUDUO_BASE_MONOTONICTIME_H
+#define MUDUO_BASE_MONOTONICTIME_H
+
+#include <muduo/base/copyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/base/Types.h>
+
+#include <boost/operators.hpp>
+
+namespace muduo
+{
+
+///
+/// Time on CLOCK_MONOTONIC, in microseconds resolution.
+///
+/// Counts from an unspecified point, usually the boot, it's for durations
+/// and deadlines only, never steps with NTP or the system clock being set.
+/// Use Timestamp for the time of day.
+///
+/// This class is immutable, pass it by value like Timestamp.
+///
+class MonotonicTime : public muduo::copyable,
+                      public boost::equality_comparable<MonotonicTime>,
+                      public boost::less_than_comparable<MonotonicTime>
+{
+ public:
+  ///
+  /// Constucts an invalid MonotonicTime.
+  ///
+  MonotonicTime()
+    : microSeconds_(0)
+  {
+  }
+
+  explicit MonotonicTime(int64_t microSecondsArg)
+    : microSeconds_(microSecondsArg)
+  {
+  }
+
+  // default copy/assignment/dtor are Okay
+
+  string toString() const;
+
+  bool valid() const { return microSeconds_ > 0; }
+
+  int64_t microSeconds() const { return microSeconds_; }
+
+  ///
+  /// Get time of now, with clock_gettime(CLOCK_MONOTONIC).
+  ///
+  static MonotonicTime now();
+  ///
+  /// Likewise with CLOCK_MONOTONIC_COARSE, the time of the last tick,
+  /// a few milliseconds behind at most, cheaper for hot paths.
+  ///
+  static MonotonicTime nowCoarse();
+  static MonotonicTime invalid()
+  {
+    return MonotonicTime();
+  }
+
+  ///
+  /// Converts a wall clock time, with the offset of the two clocks now.
+  /// Later steps of the wall clock don't move the result.
+  ///
+  static MonotonicTime fromTimestamp(Timestamp time);
+  ///
+  /// Converts to the wall clock, with the offset of the two clocks now.
+  ///
+  Timestamp toTimestamp() const;
+
+  static const int kMicroSecondsPerSecond = 1000 * 1000;
+
+ private:
+  int64_t microSeconds_;
+};
+
+inline bool operator<(MonotonicTime lhs, MonotonicTime rhs)
+{
+  return lhs.microSeconds() < rhs.microSeconds();
+}
+
+inline bool operator==(MonotonicTime lhs, MonotonicTime rhs)
+{
+  return lhs.microSeconds() == rhs.microSeconds();
+}
+
+///
+/// Gets time difference of two monotonic times, result in seconds.
+///
+inline double timeDifference(MonotonicTime high, MonotonicTime low)
+{
+  int64_t diff = high.microSeconds() - low.microSeconds();
+  return static_cast<double>(diff) / MonotonicTime::kMicroSecondsPerSecond;
+}
+
+///
+/// Add @c seconds to given monotonic time.
+///
+inline MonotonicTime addTime(MonotonicTime time, double seconds)
+{
+  int64_t delta = static_cast<int64_t>(seconds * MonotonicTime::kMicroSecondsPerSecond);
+  return MonotonicTime(time.microSeconds() + delta);
+}
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_MONOTONICTIME_H
@@ -0,0 +1,219 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef MUDUO_BASE_MPSCQUEUE_H
+#define MUDUO_BASE_MPSCQUEUE_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <atomic>
+#include <utility>
+#include <assert.h>
+
+namespace muduo
+{
+
+///
+/// Unbounded multi-producer single-consumer queue, lock free,
+/// the intrusive node based one by Dmitry Vyukov.
+///
+/// push() is one atomic exchange, safe to call from any thread.
+/// pop() and consume() must be called in one consumer thread,
+/// they don't see an element whose push() is still in progress,
+/// so the producer has to notify the consumer after push() returns.
+///
+/// Nodes are recycled, consumers put them on a shared free stack,
+/// a producer takes the whole stack at once into its thread cache,
+/// so there is no ABA problem, and no allocation once warmed up.
+template<typename T>
+class MpscQueue : noncopyable
+{
+ public:
+  MpscQueue()
+    : head_(newNode()),
+      pushed_(0),
+      tail_(head_.load(std::memory_order_relaxed)),
+      popped_(0)
+  {
+  }
+
+  ~MpscQueue()
+  {
+    T x;
+    while (pop(&x))
+    {
+    }
+    assert(tail_ == head_.load());
+    delete tail_;
+  }
+
+  void push(const T& x)
+  {
+    Node* node = newNode();
+    node->value = x;
+    push(node);
+  }
+
+  void push(T&& x)
+  {
+    Node* node = newNode();
+    node->value = std::move(x);
+    push(node);
+  }
+
+  /// @return false if empty
+  bool pop(T* x)
+  {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == NULL)
+    {
+      return false;
+    }
+    // next becomes the stub
+    *x = std::move(next->value);
+    tail_ = next;
+    // single writer, no read-modify-write
+    popped_.store(popped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    freeNode(tail);
+    return true;
+  }
+
+  /// Pops and calls @c func on elements pushed before this call,
+  /// not those pushed by @c func.
+  /// @return number of elements popped
+  template<typename Func>
+  size_t consume(Func&& func)
+  {
+    Node* last = head_.load(std::memory_order_acquire);
+    size_t n = 0;
+    T x;
+    while (tail_ != last && pop(&x))
+    {
+      func(x);
+      ++n;
+    }
+    return n;
+  }
+
+  /// Approximate, for statistics.
+  size_t size() const
+  {
+    size_t pushed = pushed_.load(std::memory_order_relaxed);
+    size_t popped = popped_.load(std::memory_order_relaxed);
+    return pushed > popped ? pushed - popped : 0;
+  }
+
+ private:
+  struct Node : noncopyable
+  {
+    Node() : next(NULL), value() { }
+
+    std::atomic<Node*> next;
+    T value;  // moved out when popped
+  };
+
+  // free nodes taken by a producer thread
+  struct NodeCache : noncopyable
+  {
+    NodeCache() : head(NULL), size(0) { }
+
+    ~NodeCache()
+    {
+      while (head)
+      {
+        Node* node = head;
+        head = node->next.load(std::memory_order_relaxed);
+        delete node;
+      }
+    }
+
+    // keeps kMaxCachedNodes, frees the rest
+    void trim()
+    {
+      Node* node = head;
+      for (size = 0; node && size < kMaxCachedNodes; ++size)
+      {
+        Node* next = node->next.load(std::memory_order_relaxed);
+        if (size + 1 == kMaxCachedNodes)
+        {
+          node->next.store(NULL, std::memory_order_relaxed);
+        }
+        node = next;
+      }
+      while (node)
+      {
+        Node* next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        node = next;
+      }
+    }
+
+    Node* head;
+    size_t size;
+  };
+
+  static const size_t kMaxCachedNodes = 4096;
+
+  static Node* newNode()
+  {
+    NodeCache& cache = t_cache;
+    if (cache.head == NULL)
+    {
+      cache.head = s_freeNodes.exchange(NULL, std::memory_order_acquire);
+      cache.trim();
+    }
+    Node* node = cache.head;
+    if (node == NULL)
+    {
+      return new Node;
+    }
+    cache.head = node->next.load(std::memory_order_relaxed);
+    --cache.size;
+    node->next.store(NULL, std::memory_order_relaxed);
+    return node;
+  }
+
+  static void freeNode(Node* node)
+  {
+    Node* head = s_freeNodes.load(std::memory_order_relaxed);
+    do
+    {
+      node->next.store(head, std::memory_order_relaxed);
+    } while (!s_freeNodes.compare_exchange_weak(head, node,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+  }
+
+  void push(Node* node)
+  {
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // consumer stops at prev until this store
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // producers' cache line
+  std::atomic<Node*> head_;  // last pushed, shared by producers
+  std::atomic<size_t> pushed_;
+  char padding_[64 - sizeof(std::atomic<Node*>) - sizeof(std::atomic<size_t>)];
+  // consumer's cache line
+  Node* tail_;  // stub, owned by consumer
+  std::atomic<size_t> popped_;
+
+  static std::atomic<Node*> s_freeNodes;
+  static thread_local NodeCache t_cache;
+};
+
+template<typename T>
+std::atomic<typename MpscQueue<T>::Node*> MpscQueue<T>::s_freeNodes(NULL);
+
+template<typename T>
+thread_local typename MpscQueue<T>::NodeCache MpscQueue<T>::t_cache;
+
+template<typename T>
+const size_t MpscQueue<T>::kMaxCachedNodes;
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_MPSCQUEUE_H
@@ -14,6 +14,7 @@
 #include <pwd.h>
 #include <stdio.h> // snprintf
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/resource.h>
 #include <sys/times.h>
@@ -50,6 +51,29 @@ int scanDir(const char *dirpath, int (*filter)(const struct dirent *))
   return result;
 }
 
+// "0-3,8-11"
+std::vector<int> parseCpuList(const string& list)
+{
+  std::vector<int> cpus;
+  const char* p = list.c_str();
+  while (::isdigit(*p))
+  {
+    char* end = NULL;
+    int first = static_cast<int>(::strtol(p, &end, 10));
+    int last = first;
+    if (*end == '-')
+    {
+      last = static_cast<int>(::strtol(end + 1, &end, 10));
+    }
+    for (int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+    p = *end == ',' ? end + 1 : end;
+  }
+  return cpus;
+}
+
 Timestamp g_startTime = Timestamp::now();
 // assume those won't change during the life time of a process.
 int g_clockTicks = static_cast<int>(::sysconf(_SC_CLK_TCK));
@@ -244,3 +268,33 @@ std::vector<pid_t> ProcessInfo::threads()
   return result;
 }
 
+int ProcessInfo::numaNodeOfCpu(int cpu)
+{
+  // /sys/devices/system/cpu/cpuN/nodeM
+  char path[64];
+  snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%d", cpu);
+  int node = -1;
+  DIR* dir = ::opendir(path);
+  if (dir)
+  {
+    while (struct dirent* d = ::readdir(dir))
+    {
+      if (::strncmp(d->d_name, "node", 4) == 0 && ::isdigit(d->d_name[4]))
+      {
+        node = ::atoi(d->d_name + 4);
+        break;
+      }
+    }
+    ::closedir(dir);
+  }
+  return node;
+}
+
+std::vector<int> ProcessInfo::cpusOfNumaNode(int node)
+{
+  char path[64];
+  snprintf(path, sizeof path, "/sys/devices/system/node/node%d/cpulist", node);
+  string list;
+  FileUtil::readFile(path, 4096, &list);
+  return parseCpuList(list);
+}
@@ -59,6 +59,12 @@ namespace ProcessInfo
 
   int numThreads();
   std::vector<pid_t> threads();
+
+  /// NUMA node of cpu, -1 if unknown.
+  int numaNodeOfCpu(int cpu);
+
+  /// read /sys/devices/system/node/nodeN/cpulist
+  std::vector<int> cpusOfNumaNode(int node);
 }  // namespace ProcessInfo
 
 }  // namespace muduo
@@ -7,10 +7,12 @@
 #include <muduo/base/CurrentThread.h>
 #include <muduo/base/Exception.h>
 #include <muduo/base/Logging.h>
+#include <muduo/base/ProcessInfo.h>
 
 #include <type_traits>
 
 #include <errno.h>
+#include <sched.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/prctl.h>
@@ -66,6 +68,45 @@ class ThreadNameInitializer    //线程初始化
 
 ThreadNameInitializer init;
 
+// pins the calling thread to cpus, and prefers their NUMA node for its memory
+void setCpuAffinity(const std::vector<int>& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+  {
+    if (0 <= cpu && cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &set);
+    }
+  }
+  if (::sched_setaffinity(0, sizeof set, &set) < 0)
+  {
+    LOG_SYSERR << "sched_setaffinity";
+    return;
+  }
+
+  int node = ProcessInfo::numaNodeOfCpu(cpus.front());
+  for (int cpu : cpus)
+  {
+    if (ProcessInfo::numaNodeOfCpu(cpu) != node)
+    {
+      node = -1;
+      break;
+    }
+  }
+  const int kMpolPreferred = 1;  // MPOL_PREFERRED in <numaif.h>
+  const int kMaxNodes = 8 * static_cast<int>(sizeof(unsigned long));
+  if (0 <= node && node < kMaxNodes)
+  {
+    unsigned long nodemask = 1UL << node;
+    if (::syscall(SYS_set_mempolicy, kMpolPreferred, &nodemask, kMaxNodes + 1) < 0)
+    {
+      LOG_SYSERR << "set_mempolicy";
+    }
+  }
+}
+
 struct ThreadData     			//线程数据类，观察者模式
 {
   typedef muduo::Thread::ThreadFunc ThreadFunc;
@@ -73,19 +114,26 @@ struct ThreadData     			//线程数据类，观察者模式
   string name_;
   pid_t* tid_;
   CountDownLatch* latch_;
+  std::vector<int> cpus_;
 
   ThreadData(ThreadFunc func,
              const string& name,
              pid_t* tid,
-             CountDownLatch* latch)
+             CountDownLatch* latch,
+             const std::vector<int>& cpus)
     : func_(std::move(func)),
       name_(name),
       tid_(tid),
-      latch_(latch)
+      latch_(latch),
+      cpus_(cpus)
   { }
 
   void runInThread()        			//线程运行
   {
+    if (!cpus_.empty())
+    {
+      setCpuAffinity(cpus_);
+    }
     *tid_ = muduo::CurrentThread::tid();
     tid_ = NULL;
     latch_->countDown();
@@ -199,7 +247,7 @@ void Thread::start()			//线程启动
   assert(!started_);
   started_ = true;
   // FIXME: move(func_)
-  detail::ThreadData* data = new detail::ThreadData(func_, name_, &tid_, &latch_);
+  detail::ThreadData* data = new detail::ThreadData(func_, name_, &tid_, &latch_, cpus_);
   if (pthread_create(&pthreadId_, NULL, &detail::startThread, data))
   {
     started_ = false;
@@ -12,6 +12,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 #include <pthread.h>
 
 namespace muduo
@@ -26,6 +27,11 @@ class Thread : noncopyable
   // FIXME: make it movable in C++11
   ~Thread();
 
+  /// Runs the thread on these CPUs, and allocates memory from
+  /// their NUMA node if they are on one node.
+  /// Must be called before start().
+  void setCpuAffinity(const std::vector<int>& cpus) { cpus_ = cpus; }
+
   void start();         //启动线程
   int join(); 			// return pthread_join()，等待线程结束，实现线程同步
 
@@ -46,6 +52,7 @@ class Thread : noncopyable
   ThreadFunc func_;			//线程回调函数
   string     name_;        	//线程名
   CountDownLatch latch_;    //用于多线程等待满足条件后同时工作
+  std::vector<int> cpus_;   // empty for all CPUs
 
   static AtomicInt32 numCreated_;    //原子计数器，记录线程个数
 };
@@ -43,6 +43,10 @@ void ThreadPool::start(int numThreads)		//开启线程池
 																	//第二个参数是线程池类的实例
           std::bind(&ThreadPool::runInThread, this), name_+id));	//runinTread是每个线程的线程运行函数，
 																	//线程执行任务情况下会阻塞
+    if (!cpuSets_.empty())
+    {
+      threads_[i]->setCpuAffinity(cpuSets_[i % cpuSets_.size()]);
+    }
     threads_[i]->start();		//启动每个线程，但是由于线程运行函数是runThread，所以会阻塞
   }
   if (numThreads == 0 && threadInitCallback_)		//如果线程池线程数为0，且设置了回调函数
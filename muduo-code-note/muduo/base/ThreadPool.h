@@ -40,6 +40,9 @@ class ThreadPool : noncopyable
   void setMaxQueueSize(int maxSize) { maxQueueSize_ = maxSize; }     //设置线程池最大线程数目
   void setThreadInitCallback(const Task& cb)       //设置线程执行前的回调函数
   { threadInitCallback_ = cb; }
+  // the N-th thread runs on cpuSets[N % cpuSets.size()], see Thread::setCpuAffinity()
+  void setCpuAffinity(const std::vector<std::vector<int>>& cpuSets)
+  { cpuSets_ = cpuSets; }
 
   void start(int numThreads);
   void stop();
@@ -62,6 +65,7 @@ class ThreadPool : noncopyable
   Condition notFull_ GUARDED_BY(mutex_);	//是否已满condition
   string name_;
   Task threadInitCallback_;					//线程执行前的回调函数
+  std::vector<std::vector<int>> cpuSets_;
   std::vector<std::unique_ptr<muduo::Thread>> threads_;		//线程池   线程数组（容器）
   std::deque<Task> queue_ GUARDED_BY(mutex_);		//任务队列
   size_t maxQueueSize_;					//因为deque是通过push_back增加线程数目的，
@@ -63,6 +63,12 @@ class Timestamp : public muduo::copyable,     //表示是可复制的，值语
   /// Get time of now.
   ///
   static Timestamp now();              //返回当前时间
+  ///
+  /// Likewise with clock_gettime(CLOCK_REALTIME_COARSE), the time of
+  /// the last tick, a few milliseconds behind at most, cheaper for
+  /// hot paths, e.g. log lines.
+  ///
+  static Timestamp nowCoarse();
   static Timestamp invalid()           //这个类是否有效？通过构造函数实现？
   {
     return Timestamp();
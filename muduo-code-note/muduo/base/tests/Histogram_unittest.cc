@@ -0,0 +1,79 @@
+#include <muduo/base/Histogram.h>
+
+//#define BOOST_TEST_MODULE HistogramTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+
+using muduo::Histogram;
+
+BOOST_AUTO_TEST_CASE(testHistogramBuckets)
+{
+  // every value falls in a bucket whose highest is at or above it,
+  // and at most 1/16 above
+  int last = 0;
+  for (int64_t v = 0; v < (int64_t(1) << 20); ++v)
+  {
+    int b = Histogram::bucketOf(v);
+    if (b != last && b != last + 1)
+    {
+      BOOST_FAIL("bucket of " << v << " is " << b << " after " << last);
+    }
+    last = b;
+    int64_t highest = Histogram::highestOf(b);
+    if (highest < v || highest - v > v / Histogram::kSubBuckets)
+    {
+      BOOST_FAIL("highest of bucket " << b << " is " << highest << " for " << v);
+    }
+  }
+  int top = Histogram::bucketOf(int64_t(1) << 50);
+  BOOST_CHECK_EQUAL(top, Histogram::kNumBuckets - 1);
+  BOOST_CHECK_EQUAL(Histogram::highestOf(top), (int64_t(1) << Histogram::kMaxBits) - 1);
+}
+
+BOOST_AUTO_TEST_CASE(testHistogramPercentiles)
+{
+  Histogram h;
+  BOOST_CHECK_EQUAL(h.count(), 0);
+  BOOST_CHECK_EQUAL(h.percentile(99), 0);
+  for (int i = 1; i <= 1000; ++i)
+  {
+    h.record(i);
+  }
+  BOOST_CHECK_EQUAL(h.count(), 1000);
+  BOOST_CHECK_EQUAL(h.max(), 1000);
+  BOOST_CHECK_EQUAL(h.mean(), 500.5);
+  int64_t p50 = h.percentile(50);
+  int64_t p99 = h.percentile(99);
+  BOOST_CHECK(p50 >= 500 && p50 <= 500 + 500 / 16);
+  BOOST_CHECK(p99 >= 990 && p99 <= 1000);
+  BOOST_CHECK_EQUAL(h.percentile(100), 1000);
+  printf("%s\n", h.toString().c_str());
+
+  h.record(-5);  // counted as 0
+  BOOST_CHECK_EQUAL(h.percentile(0), 0);
+  h.reset();
+  BOOST_CHECK_EQUAL(h.count(), 0);
+  BOOST_CHECK_EQUAL(h.max(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testHistogramMerge)
+{
+  Histogram a;
+  Histogram b;
+  for (int i = 1; i <= 100; ++i)
+  {
+    a.record(i);
+    b.record(i + 100);
+  }
+  Histogram total;
+  total.merge(a);
+  total.merge(b);
+  BOOST_CHECK_EQUAL(total.count(), 200);
+  BOOST_CHECK_EQUAL(total.max(), 200);
+  BOOST_CHECK_EQUAL(total.mean(), 100.5);
+  int64_t p50 = total.percentile(50);
+  BOOST_CHECK(p50 >= 100 && p50 <= 100 + 100 / 16);
+}
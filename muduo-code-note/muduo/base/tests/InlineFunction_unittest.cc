@@ -0,0 +1,65 @@
+#include <muduo/base/InlineFunction.h>
+
+//#define BOOST_TEST_MODULE InlineFunctionTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <memory>
+
+using muduo::InlineFunction;
+
+int twice(int x)
+{
+  return 2 * x;
+}
+
+BOOST_AUTO_TEST_CASE(testInlineFunctionCall)
+{
+  InlineFunction<int(int)> f(twice);
+  BOOST_CHECK(f);
+  BOOST_CHECK_EQUAL(f(21), 42);
+
+  std::unique_ptr<int> owned(new int(1));
+  InlineFunction<int(int)> g(std::bind([](const std::unique_ptr<int>& p, int x) { return x + *p; },
+                                       std::move(owned), std::placeholders::_1));
+  BOOST_CHECK_EQUAL(g(41), 42);
+  f = std::move(g);
+  BOOST_CHECK(!g);
+  BOOST_CHECK_EQUAL(f(1), 2);
+
+  // bigger than the inline storage
+  std::array<char, 100> big;
+  big.fill('x');
+  auto heap = [big](int x) { return x + static_cast<int>(big.size()); };
+  BOOST_CHECK(!InlineFunction<int(int)>::isInline<decltype(heap)>());
+  InlineFunction<int(int)> h(heap);
+  InlineFunction<int(int)> moved(std::move(h));
+  BOOST_CHECK_EQUAL(moved(1), 101);
+  moved = nullptr;
+  BOOST_CHECK(!moved);
+}
+
+BOOST_AUTO_TEST_CASE(testInlineFunctionNull)
+{
+  // empty as std::function would be, so "if (cb)" guards hold
+  int (*pointer)(int) = NULL;
+  InlineFunction<int(int)> fromPointer(pointer);
+  BOOST_CHECK(!fromPointer);
+
+  std::function<int(int)> empty;
+  InlineFunction<int(int)> fromFunction(empty);
+  BOOST_CHECK(!fromFunction);
+  InlineFunction<int(int)> fromMoved(std::move(empty));
+  BOOST_CHECK(!fromMoved);
+
+  InlineFunction<int(int), 32> small;
+  InlineFunction<int(int)> fromInline(std::move(small));
+  BOOST_CHECK(!fromInline);
+
+  std::function<int(int)> full(twice);
+  InlineFunction<int(int)> fromFull(full);
+  BOOST_CHECK(fromFull);
+  BOOST_CHECK_EQUAL(fromFull(2), 4);
+}
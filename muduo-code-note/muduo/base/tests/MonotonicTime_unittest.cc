@@ -0,0 +1,87 @@
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/base/Timestamp.h>
+
+//#define BOOST_TEST_MODULE MonotonicTimeTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using muduo::MonotonicTime;
+using muduo::Timestamp;
+
+BOOST_AUTO_TEST_CASE(testMonotonic)
+{
+  MonotonicTime last(MonotonicTime::now());
+  BOOST_CHECK(last.valid());
+  for (int i = 0; i < 1000 * 1000; ++i)
+  {
+    MonotonicTime now(MonotonicTime::now());
+    if (now < last)
+    {
+      BOOST_FAIL("went back " << last.microSeconds() - now.microSeconds() << "us");
+    }
+    last = now;
+  }
+
+  MonotonicTime later(addTime(last, 1.5));
+  BOOST_CHECK(last < later);
+  BOOST_CHECK_EQUAL(timeDifference(later, last), 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(testCoarse)
+{
+  // the coarse clocks lag behind by a tick at most, a few milliseconds
+  MonotonicTime coarse(MonotonicTime::nowCoarse());
+  MonotonicTime precise(MonotonicTime::now());
+  double lag = timeDifference(precise, coarse);
+  printf("monotonic coarse lags %.6f\n", lag);
+  BOOST_CHECK(lag >= 0 && lag < 0.1);
+
+  Timestamp wallCoarse(Timestamp::nowCoarse());
+  Timestamp wall(Timestamp::now());
+  lag = timeDifference(wall, wallCoarse);
+  printf("realtime coarse lags %.6f\n", lag);
+  BOOST_CHECK(lag >= 0 && lag < 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(testConversion)
+{
+  Timestamp wall(addTime(Timestamp::now(), 10.0));
+  MonotonicTime mono(MonotonicTime::fromTimestamp(wall));
+  double ahead = timeDifference(mono, MonotonicTime::now());
+  BOOST_CHECK(ahead > 9.9 && ahead <= 10.0);
+  double error = timeDifference(mono.toTimestamp(), wall);
+  BOOST_CHECK(error > -0.01 && error < 0.01);
+}
+
+template<typename Clock>
+void benchmark(const char* name, Clock clock)
+{
+  const int kNumber = 10*1000*1000;
+  volatile int64_t sink = 0;
+  Timestamp start(Timestamp::now());
+  for (int i = 0; i < kNumber; ++i)
+  {
+    sink = clock();
+  }
+  (void)sink;
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("%-26s %6.1f ns\n", name, seconds * 1e9 / kNumber);
+}
+
+// monotonictime_unittest -- 1
+BOOST_AUTO_TEST_CASE(testClockCost)
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  if (argc > 1 && atoi(argv[1]) > 0)
+  {
+    benchmark("Timestamp::now", [] { return Timestamp::now().microSecondsSinceEpoch(); });
+    benchmark("Timestamp::nowCoarse", [] { return Timestamp::nowCoarse().microSecondsSinceEpoch(); });
+    benchmark("MonotonicTime::now", [] { return MonotonicTime::now().microSeconds(); });
+    benchmark("MonotonicTime::nowCoarse", [] { return MonotonicTime::nowCoarse().microSeconds(); });
+  }
+}
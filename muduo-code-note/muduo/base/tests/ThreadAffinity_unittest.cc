@@ -0,0 +1,94 @@
+#include <muduo/base/ProcessInfo.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/ThreadPool.h>
+#include <muduo/base/CountDownLatch.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+using namespace muduo;
+
+// the CPUs this thread may run on
+std::vector<int> allowedCpus()
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  int ret = ::sched_getaffinity(0, sizeof set, &set);
+  assert(ret == 0); (void) ret;
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (CPU_ISSET(cpu, &set))
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// -1 if not MPOL_PREFERRED
+int preferredNode()
+{
+  int mode = 0;
+  unsigned long nodemask = 0;
+  if (::syscall(SYS_get_mempolicy, &mode, &nodemask, 8 * sizeof nodemask + 1, NULL, 0) < 0
+      || mode != 1 || nodemask == 0)
+  {
+    return -1;
+  }
+  return __builtin_ctzl(nodemask);
+}
+
+int main()
+{
+  std::vector<int> cpus = allowedCpus();
+  assert(!cpus.empty());
+  int cpu = cpus.back();
+  int node = ProcessInfo::numaNodeOfCpu(cpu);
+  printf("cpu %d on node %d\n", cpu, node);
+  if (node >= 0)
+  {
+    std::vector<int> nodeCpus = ProcessInfo::cpusOfNumaNode(node);
+    assert(std::find(nodeCpus.begin(), nodeCpus.end(), cpu) != nodeCpus.end());
+  }
+
+  std::vector<int> pinned;
+  int pinnedNode = -2;
+  Thread thread([&] {
+    pinned = allowedCpus();
+    pinnedNode = preferredNode();
+  });
+  thread.setCpuAffinity(std::vector<int>(1, cpu));
+  thread.start();
+  thread.join();
+  assert(pinned == std::vector<int>(1, cpu));
+  assert(pinnedNode == node);
+
+  ThreadPool pool("AffinityPool");
+  std::vector<std::vector<int>> cpuSets;
+  for (int c : cpus)
+  {
+    cpuSets.push_back(std::vector<int>(1, c));
+  }
+  pool.setCpuAffinity(cpuSets);
+  pool.start(static_cast<int>(cpus.size()) * 2);
+  CountDownLatch latch(static_cast<int>(cpus.size()) * 2);
+  for (size_t i = 0; i < cpus.size() * 2; ++i)
+  {
+    pool.run([&] {
+      assert(allowedCpus().size() == 1);
+      latch.countDown();
+    });
+  }
+  latch.wait();
+  pool.stop();
+
+  // the main thread is not affected
+  assert(allowedCpus() == cpus);
+  printf("OK\n");
+}
@@ -16,7 +16,7 @@
 #include <errno.h>
 #include <fcntl.h>
 //#include <sys/types.h>
-//#include <sys/stat.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 using namespace muduo;
@@ -27,11 +27,27 @@ Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reusepor
     acceptSocket_(sockets::createNonblockingOrDie(listenAddr.family())),
     acceptChannel_(loop, acceptSocket_.fd()),
     listenning_(false),
+    acceptBatch_(kDefaultAcceptBatch),
     idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC))
 {
   assert(idleFd_ >= 0);
-  acceptSocket_.setReuseAddr(true);
-  acceptSocket_.setReusePort(reuseport);
+  if (listenAddr.isUnixDomain())
+  {
+    // nothing to reuse, but a socket file left by a previous run
+    // fails bind() with EADDRINUSE.
+    string path = listenAddr.unixPath();
+    struct stat st;
+    if (!path.empty() && path[0] != '@'
+        && ::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+    {
+      ::unlink(path.c_str());
+    }
+  }
+  else
+  {
+    acceptSocket_.setReuseAddr(true);
+    acceptSocket_.setReusePort(reuseport);
+  }
   acceptSocket_.bindAddress(listenAddr);
   acceptChannel_.setReadCallback(
       std::bind(&Acceptor::handleRead, this));
@@ -52,38 +68,52 @@ void Acceptor::listen()
   acceptChannel_.enableReading();
 }
 
+void Acceptor::setAcceptBatch(int batch)
+{
+  assert(batch > 0);
+  acceptBatch_ = batch;
+}
+
 void Acceptor::handleRead()
 {
   loop_->assertInLoopThread();
-  InetAddress peerAddr;
-  //FIXME loop until no more
-  int connfd = acceptSocket_.accept(&peerAddr);
-  if (connfd >= 0)
+  // drains a burst of connections in one poll round trip,
+  // the limit keeps other channels of the loop served
+  for (int i = 0; i < acceptBatch_; ++i)
   {
-    // string hostport = peerAddr.toIpPort();
-    // LOG_TRACE << "Accepts of " << hostport;
-    if (newConnectionCallback_)
+    InetAddress peerAddr;
+    int connfd = acceptSocket_.accept(&peerAddr);
+    if (connfd >= 0)
     {
-      newConnectionCallback_(connfd, peerAddr);
+      // string hostport = peerAddr.toIpPort();
+      // LOG_TRACE << "Accepts of " << hostport;
+      if (newConnectionCallback_)
+      {
+        newConnectionCallback_(connfd, peerAddr);
+      }
+      else
+      {
+        sockets::close(connfd);
+      }
     }
     else
     {
-      sockets::close(connfd);
-    }
-  }
-  else
-  {
-    LOG_SYSERR << "in Acceptor::handleRead";
-    // Read the section named "The special problem of
-    // accept()ing when you can't" in libev's doc.
-    // By Marc Lehmann, author of libev.
-    if (errno == EMFILE)
-    {
-      ::close(idleFd_);
-      idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
-      ::close(idleFd_);
-      idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+      if (errno == EAGAIN)
+      {
+        break;
+      }
+      LOG_SYSERR << "in Acceptor::handleRead";
+      // Read the section named "The special problem of
+      // accept()ing when you can't" in libev's doc.
+      // By Marc Lehmann, author of libev.
+      if (errno == EMFILE)
+      {
+        ::close(idleFd_);
+        idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
+        ::close(idleFd_);
+        idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+      }
+      break;
     }
   }
 }
-
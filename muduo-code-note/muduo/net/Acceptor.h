@@ -32,15 +32,32 @@ class Acceptor : noncopyable
  public:
   typedef std::function<void (int sockfd, const InetAddress&)> NewConnectionCallback;
 
+  static const int kDefaultAcceptBatch = 16;
+
   Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reuseport);
   ~Acceptor();
 
   void setNewConnectionCallback(const NewConnectionCallback& cb)
   { newConnectionCallback_ = cb; }
 
+  EventLoop* getLoop() const { return loop_; }
   bool listenning() const { return listenning_; }
   void listen();
 
+  /// Connections accepted per readiness event at most, accept4(2)
+  /// stops earlier on EAGAIN. 1 accepts one per poll round trip.
+  void setAcceptBatch(int batch);
+
+  // Must be called before @c listen, see Socket.
+  void setDeferAccept(int seconds)
+  { acceptSocket_.setDeferAccept(seconds); }
+  void setFastOpen(int queueLength)
+  { acceptSocket_.setFastOpen(queueLength); }
+
+  // see Socket::attachReusePortCpuFilter()
+  bool attachReusePortCpuFilter()
+  { return acceptSocket_.attachReusePortCpuFilter(); }
+
  private:
   void handleRead();
 
@@ -49,6 +66,7 @@ class Acceptor : noncopyable
   Channel acceptChannel_;
   NewConnectionCallback newConnectionCallback_;
   bool listenning_;
+  int acceptBatch_;
   int idleFd_;
 };
 
@@ -23,6 +23,11 @@ const size_t Buffer::kCheapPrepend;
 const size_t Buffer::kInitialSize;
 
 ssize_t Buffer::readFd(int fd, int* savedErrno)
+{
+  return readFd(fd, NULL, savedErrno);
+}
+
+ssize_t Buffer::readFd(int fd, std::vector<int>* receivedFds, int* savedErrno)
 {
   // saved an ioctl()/FIONREAD call to tell how much to read
   char extrabuf[65536];
@@ -35,7 +40,8 @@ ssize_t Buffer::readFd(int fd, int* savedErrno)
   // when there is enough space in this buffer, don't read into extrabuf.
   // when extrabuf is used, we read 128k-1 bytes at most.
   const int iovcnt = (writable < sizeof extrabuf) ? 2 : 1;
-  const ssize_t n = sockets::readv(fd, vec, iovcnt);
+  const ssize_t n = receivedFds ? sockets::readvWithFds(fd, vec, iovcnt, receivedFds)
+                                : sockets::readv(fd, vec, iovcnt);
   if (n < 0)
   {
     *savedErrno = errno;
@@ -29,6 +29,8 @@ namespace muduo
 namespace net
 {
 
+class BufferPool;
+
 /// A buffer class modeled after org.jboss.netty.buffer.ChannelBuffer
 ///
 /// @code
@@ -48,7 +50,8 @@ class Buffer : public muduo::copyable
   explicit Buffer(size_t initialSize = kInitialSize)
     : buffer_(kCheapPrepend + initialSize),
       readerIndex_(kCheapPrepend),
-      writerIndex_(kCheapPrepend)
+      writerIndex_(kCheapPrepend),
+      lent_(false)
   {
     assert(readableBytes() == 0);
     assert(writableBytes() == initialSize);
@@ -378,6 +381,9 @@ class Buffer : public muduo::copyable
   /// It may implement with readv(2)
   /// @return result of read(2), @c errno is saved
   ssize_t readFd(int fd, int* savedErrno);
+  /// Likewise with recvmsg(2) on a Unix domain socket, descriptors passed
+  /// with SCM_RIGHTS are appended to @c receivedFds
+  ssize_t readFd(int fd, std::vector<int>* receivedFds, int* savedErrno);
 
  private:
 
@@ -409,9 +415,14 @@ class Buffer : public muduo::copyable
   }
 
  private:
+  friend class BufferPool;  // lends and takes back buffer_
+
   std::vector<char> buffer_;
   size_t readerIndex_;
   size_t writerIndex_;
+  // storage was lent by a BufferPool, not exchanged by swap(), so the
+  // lend ends even if the storage was taken away meanwhile.
+  bool lent_;
 
   static const char kCRLF[];
 };
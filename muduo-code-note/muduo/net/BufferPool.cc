@@ -0,0 +1,122 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/BufferPool.h>
+
+#include <muduo/net/Buffer.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t BufferPool::kMaxStorageSize;
+const size_t BufferPool::kMaxCachedBytes;
+const size_t BufferPool::kMaxStubs;
+
+BufferPool::BufferPool()
+{
+}
+
+BufferPool::~BufferPool()
+{
+}
+
+bool BufferPool::hasStorage(const Buffer& buf)
+{
+  return buf.buffer_.size() > Buffer::kCheapPrepend;
+}
+
+void BufferPool::acquire(Buffer* buf)
+{
+  if (hasStorage(*buf))
+  {
+    return;
+  }
+  assert(buf->readableBytes() == 0);
+  Storage storage;
+  if (!storages_.empty())
+  {
+    storage.swap(storages_.back());
+    storages_.pop_back();
+    cached_.decrement();
+    cachedBytes_.add(-static_cast<int64_t>(storage.size()));
+    reused_.increment();
+  }
+  else
+  {
+    storage.resize(Buffer::kCheapPrepend + Buffer::kInitialSize);
+  }
+  buf->buffer_.swap(storage);
+  buf->readerIndex_ = buf->writerIndex_ = Buffer::kCheapPrepend;
+  if (!buf->lent_)
+  {
+    buf->lent_ = true;
+    acquired_.increment();
+  }
+  // storage is the old stub now
+  if (stubs_.size() < kMaxStubs)
+  {
+    stubs_.push_back(Storage());
+    stubs_.back().swap(storage);
+  }
+}
+
+void BufferPool::release(Buffer* buf)
+{
+  assert(buf->readableBytes() == 0);
+  if (buf->lent_)
+  {
+    buf->lent_ = false;
+    released_.increment();
+    if (!hasStorage(*buf))
+    {
+      // swapped out, it's freed by whoever has it
+      taken_.increment();
+      return;
+    }
+  }
+  else if (!hasStorage(*buf))
+  {
+    return;
+  }
+  // storage not lent by us is taken anyway
+  Storage storage;
+  if (!stubs_.empty())
+  {
+    storage.swap(stubs_.back());
+    stubs_.pop_back();
+  }
+  else
+  {
+    storage.resize(Buffer::kCheapPrepend);
+  }
+  buf->buffer_.swap(storage);
+  buf->readerIndex_ = buf->writerIndex_ = Buffer::kCheapPrepend;
+
+  if (storage.size() <= kMaxStorageSize
+      && cachedBytes_.get() + static_cast<int64_t>(storage.size()) <= static_cast<int64_t>(kMaxCachedBytes))
+  {
+    cachedBytes_.add(static_cast<int64_t>(storage.size()));
+    cached_.increment();
+    storages_.push_back(Storage());
+    storages_.back().swap(storage);
+  }
+  else
+  {
+    dropped_.increment();
+  }
+}
+
+string BufferPool::stats()
+{
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           "acquired %" PRId64 " reused %" PRId64 " released %" PRId64
+           " dropped %" PRId64 " taken %" PRId64 " lent %" PRId64
+           " cached %" PRId64 " cached_bytes %" PRId64,
+           numAcquired(), numReused(), numReleased(), numDropped(),
+           numTaken(), numLent(), numCached(), cachedBytes());
+  return buf;
+}
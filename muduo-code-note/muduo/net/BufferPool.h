@@ -0,0 +1,81 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_BUFFERPOOL_H
+#define MUDUO_NET_BUFFERPOOL_H
+
+#include <muduo/base/Atomic.h>
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Types.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+class Buffer;
+
+///
+/// Storage pool of input buffers, one per EventLoop.
+///
+/// A drained Buffer hands its storage back with release(), and keeps
+/// a kCheapPrepend-byte stub, so idle connections hold almost nothing.
+/// Stubs are recycled too, lending a storage costs no malloc once warmed.
+/// Storage swapped out of a lent Buffer, e.g. by ChainBuffer::append(),
+/// is counted as taken on release().
+///
+/// acquire() and release() must be called in the loop thread,
+/// counters can be read in any thread.
+class BufferPool : noncopyable
+{
+ public:
+  // storage bigger than this, or beyond the cache limit, goes back to malloc.
+  static const size_t kMaxStorageSize = 64*1024 + 8;
+  static const size_t kMaxCachedBytes = 4*1024*1024;
+  static const size_t kMaxStubs = 1024;
+
+  BufferPool();
+  ~BufferPool();
+
+  /// Gives storage to @c buf if it has none.
+  void acquire(Buffer* buf);
+
+  /// Takes storage of a drained @c buf back, ends its lend.
+  void release(Buffer* buf);
+
+  static bool hasStorage(const Buffer& buf);
+
+  int64_t numAcquired() { return acquired_.get(); }
+  int64_t numReused() { return reused_.get(); }
+  int64_t numReleased() { return released_.get(); }
+  int64_t numDropped() { return dropped_.get(); }
+  int64_t numTaken() { return taken_.get(); }
+  int64_t numLent() { return acquired_.get() - released_.get(); }
+  int64_t numCached() { return cached_.get(); }
+  int64_t cachedBytes() { return cachedBytes_.get(); }
+
+  string stats();
+
+ private:
+  typedef std::vector<char> Storage;
+
+  std::vector<Storage> storages_;
+  std::vector<Storage> stubs_;
+
+  AtomicInt64 acquired_;
+  AtomicInt64 reused_;
+  AtomicInt64 released_;
+  AtomicInt64 dropped_;
+  AtomicInt64 taken_;
+  AtomicInt64 cached_;
+  AtomicInt64 cachedBytes_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_BUFFERPOOL_H
@@ -11,10 +11,12 @@
 #ifndef MUDUO_NET_CALLBACKS_H
 #define MUDUO_NET_CALLBACKS_H
 
+#include <muduo/base/InlineFunction.h>
 #include <muduo/base/Timestamp.h>
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace muduo
 {
@@ -58,19 +60,30 @@ namespace net
 // All client visible callbacks go here.
 
 class Buffer;
+class EventLoop;
 class TcpConnection;
+class Transport;
 typedef std::shared_ptr<TcpConnection> TcpConnectionPtr;
-typedef std::function<void()> TimerCallback;
+// move-only, doesn't allocate for small closures
+typedef InlineFunction<void()> TimerCallback;
 typedef std::function<void (const TcpConnectionPtr&)> ConnectionCallback;
 typedef std::function<void (const TcpConnectionPtr&)> CloseCallback;
 typedef std::function<void (const TcpConnectionPtr&)> WriteCompleteCallback;
 typedef std::function<void (const TcpConnectionPtr&, size_t)> HighWaterMarkCallback;
+typedef std::function<void (const TcpConnectionPtr&, size_t)> LowWaterMarkCallback;
 
 // the data has been read to (buf, len)
 typedef std::function<void (const TcpConnectionPtr&,
                             Buffer*,
                             Timestamp)> MessageCallback;
 
+// picks the loop of a new connection from loops of EventLoopThreadPool,
+// see EventLoop::numConnections() etc. for metrics.
+typedef std::function<EventLoop* (const std::vector<EventLoop*>& loops)> LoopSelector;
+
+// a Transport for each new connection, see TcpServer::setTransportFactory().
+typedef std::function<std::unique_ptr<Transport> ()> TransportFactory;
+
 void defaultConnectionCallback(const TcpConnectionPtr& conn);
 void defaultMessageCallback(const TcpConnectionPtr& conn,
                             Buffer* buffer,
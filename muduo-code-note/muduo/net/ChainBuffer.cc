@@ -0,0 +1,593 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/ChainBuffer.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/net/SocketsOps.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+// free blocks cached by each thread, the rest go back to malloc.
+const int kMaxFreeBlocks = 64;
+__thread char* t_freeBlocks[kMaxFreeBlocks];
+__thread int t_numFreeBlocks = 0;
+
+char* allocBlock()
+{
+  if (t_numFreeBlocks > 0)
+  {
+    return t_freeBlocks[--t_numFreeBlocks];
+  }
+  return static_cast<char*>(::operator new(ChainBuffer::kBlockSize));
+}
+
+void freeBlock(char* block)
+{
+  if (t_numFreeBlocks < kMaxFreeBlocks)
+  {
+    t_freeBlocks[t_numFreeBlocks++] = block;
+  }
+  else
+  {
+    ::operator delete(block);
+  }
+}
+
+// the default capacity of a pipe
+const size_t kPipeSize = 64*1024;
+
+// bytes of our own pipe, which must be there
+void readPipe(int fd, char* dest, size_t len)
+{
+  while (len > 0)
+  {
+    ssize_t n = ::read(fd, dest, len);
+    if (n > 0)
+    {
+      dest += n;
+      len -= n;
+    }
+    else if (n < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else
+    {
+      LOG_SYSFATAL << "ChainBuffer - pipe is " << len << " bytes short";
+    }
+  }
+}
+
+}  // namespace
+
+// A dup(2)-ed file, offset is ignored if it's not seekable.
+// With splice(2), the next bytes of the segment are in the pipe first,
+// offset is of those after them.
+struct ChainBuffer::File : noncopyable
+{
+  explicit File(int fdArg)
+    : fd(fdArg),
+      offset(0),
+      seekable(::lseek(fdArg, 0, SEEK_CUR) >= 0),
+      useSplice(false),
+      piped(0)
+  {
+    pipefd[0] = pipefd[1] = -1;
+  }
+
+  ~File()
+  {
+    ::close(fd);
+    if (pipefd[0] >= 0)
+    {
+      ::close(pipefd[0]);
+      ::close(pipefd[1]);
+    }
+  }
+
+  // drops len bytes from the front, the piped ones first
+  void skip(size_t len)
+  {
+    char buf[4096];
+    while (piped > 0 && len > 0)
+    {
+      size_t n = std::min(std::min(piped, len), sizeof buf);
+      readPipe(pipefd[0], buf, n);
+      piped -= n;
+      len -= n;
+    }
+    offset += len;
+  }
+
+  const int fd;
+  int64_t offset;
+  const bool seekable;
+  bool useSplice;  // sendfile(2) doesn't take it
+  int pipefd[2];
+  size_t piped;
+};
+
+const char ChainBuffer::kCRLF[] = "\r\n";
+
+const size_t ChainBuffer::kBlockSize;
+const int ChainBuffer::kMaxIovecs;
+
+ChainBuffer::ChainBuffer()
+  : readable_(0)
+{
+}
+
+ChainBuffer::~ChainBuffer()
+{
+  retrieveAll();
+}
+
+void ChainBuffer::swap(ChainBuffer& rhs)
+{
+  segments_.swap(rhs.segments_);
+  std::swap(readable_, rhs.readable_);
+}
+
+size_t ChainBuffer::internalCapacity() const
+{
+  size_t blocks = 0;
+  for (const Segment& seg : segments_)
+  {
+    if (seg.block)
+    {
+      ++blocks;
+    }
+  }
+  return blocks * kBlockSize;
+}
+
+const char* ChainBuffer::peek()
+{
+  unpipe();
+  if (segments_.size() > 1)
+  {
+    // pull up
+    Segment whole;
+    char* dest = NULL;
+    if (readable_ <= kBlockSize)
+    {
+      whole.block = allocBlock();
+      dest = whole.block;
+    }
+    else
+    {
+      std::shared_ptr<string> storage(new string(readable_, '\0'));
+      dest = &(*storage)[0];
+      whole.owner = storage;
+    }
+    whole.data = dest;
+    whole.size = readable_;
+    for (const Segment& seg : segments_)
+    {
+      copyOut(seg, seg.size, dest);
+      dest += seg.size;
+    }
+    while (!segments_.empty())
+    {
+      popFront();
+    }
+    segments_.push_back(std::move(whole));
+  }
+  else if (segments_.size() == 1 && segments_.front().file)
+  {
+    readFileFront(readable_);
+  }
+  return segments_.empty() ? NULL : segments_.front().data;
+}
+
+const char* ChainBuffer::findCRLF()
+{
+  if (readable_ < 2)
+  {
+    return NULL;
+  }
+  const char* start = peek();
+  const char* end = start + readable_;
+  const char* crlf = std::search(start, end, kCRLF, kCRLF+2);
+  return crlf == end ? NULL : crlf;
+}
+
+void ChainBuffer::retrieve(size_t len)
+{
+  assert(len <= readable_);
+  readable_ -= len;
+  while (len > 0)
+  {
+    Segment& front = segments_.front();
+    if (len >= front.size)
+    {
+      len -= front.size;
+      popFront();
+    }
+    else
+    {
+      if (front.file)
+      {
+        front.file->skip(len);
+      }
+      else
+      {
+        front.data += len;
+      }
+      front.size -= len;
+      len = 0;
+    }
+  }
+}
+
+void ChainBuffer::retrieveAll()
+{
+  while (!segments_.empty())
+  {
+    popFront();
+  }
+  readable_ = 0;
+}
+
+string ChainBuffer::retrieveAsString(size_t len)
+{
+  assert(len <= readable_);
+  unpipe();
+  string result(len, '\0');
+  size_t copied = 0;
+  for (const Segment& seg : segments_)
+  {
+    if (copied == len)
+    {
+      break;
+    }
+    size_t n = std::min(seg.size, len - copied);
+    copyOut(seg, n, &result[copied]);
+    copied += n;
+  }
+  retrieve(len);
+  return result;
+}
+
+void ChainBuffer::append(const void* /*restrict*/ data, size_t len)
+{
+  const char* src = static_cast<const char*>(data);
+  while (len > 0)
+  {
+    size_t room = tailRoom();
+    if (room == 0)
+    {
+      pushBlock();
+      room = kBlockSize;
+    }
+    size_t n = std::min(room, len);
+    Segment& tail = segments_.back();
+    char* dest = tail.block + (tail.data - tail.block) + tail.size;
+    ::memcpy(dest, src, n);
+    tail.size += n;
+    readable_ += n;
+    src += n;
+    len -= n;
+  }
+}
+
+void ChainBuffer::append(const StringPiece& slice, const std::shared_ptr<const void>& owner)
+{
+  if (slice.size() > 0)
+  {
+    Segment seg;
+    seg.data = slice.data();
+    seg.size = slice.size();
+    seg.owner = owner;
+    segments_.push_back(std::move(seg));
+    readable_ += slice.size();
+  }
+}
+
+void ChainBuffer::append(Buffer* buf)
+{
+  if (buf->readableBytes() < kBlockSize)
+  {
+    append(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+  }
+  else
+  {
+    std::shared_ptr<Buffer> storage(new Buffer(0));
+    storage->swap(*buf);
+    append(storage->toStringPiece(), storage);
+  }
+}
+
+bool ChainBuffer::appendFile(int fd, int64_t offset, size_t length)
+{
+  if (length == 0)
+  {
+    return true;
+  }
+  int newfd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (newfd < 0)
+  {
+    LOG_SYSERR << "ChainBuffer::appendFile";
+    return false;
+  }
+  std::shared_ptr<File> file(new File(newfd));
+  file->offset = offset;
+  Segment seg;
+  seg.size = length;
+  seg.file = file.get();
+  seg.owner = file;
+  segments_.push_back(std::move(seg));
+  readable_ += length;
+  return true;
+}
+
+bool ChainBuffer::readFileFront(size_t len)
+{
+  assert(!segments_.empty() && segments_.front().file);
+  unpipe();
+  if (!segments_.front().file)
+  {
+    // the piped bytes came first
+    return true;
+  }
+  size_t n = std::min(len, segments_.front().size);
+  std::shared_ptr<string> storage(new string(n, '\0'));
+  bool ok = copyOut(segments_.front(), n, &(*storage)[0]);
+  retrieve(n);
+  Segment seg;
+  seg.data = storage->data();
+  seg.size = n;
+  seg.owner = storage;
+  segments_.push_front(std::move(seg));
+  readable_ += n;
+  return ok;
+}
+
+void ChainBuffer::prepend(const void* /*restrict*/ data, size_t len)
+{
+  const char* src = static_cast<const char*>(data);
+  while (len > 0)
+  {
+    size_t room = 0;
+    if (!segments_.empty() && segments_.front().block)
+    {
+      const Segment& front = segments_.front();
+      room = front.data - front.block;
+    }
+    if (room == 0)
+    {
+      Segment seg;
+      seg.block = allocBlock();
+      seg.data = seg.block + kBlockSize;
+      segments_.push_front(std::move(seg));
+      room = kBlockSize;
+    }
+    size_t n = std::min(room, len);
+    Segment& front = segments_.front();
+    front.data -= n;
+    front.size += n;
+    ::memcpy(front.block + (front.data - front.block), src + len - n, n);
+    readable_ += n;
+    len -= n;
+  }
+}
+
+int ChainBuffer::fillIovec(struct iovec* iov, int maxIov) const
+{
+  int n = 0;
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end() && !it->file && n < maxIov; ++it, ++n)
+  {
+    iov[n].iov_base = const_cast<char*>(it->data);
+    iov[n].iov_len = it->size;
+  }
+  return n;
+}
+
+ssize_t ChainBuffer::writeFd(int fd, int* savedErrno)
+{
+  ssize_t n = 0;
+  if (!segments_.empty() && segments_.front().file)
+  {
+    n = writeFile(fd, &segments_.front());
+  }
+  else
+  {
+    struct iovec vec[kMaxIovecs];
+    int iovcnt = fillIovec(vec, kMaxIovecs);
+    n = sockets::writev(fd, vec, iovcnt);
+    if (n > 0)
+    {
+      retrieve(n);
+    }
+  }
+  if (n < 0)
+  {
+    *savedErrno = errno;
+  }
+  return n;
+}
+
+ssize_t ChainBuffer::writeFile(int fd, Segment* seg)
+{
+  File* file = seg->file;
+  if (!file->useSplice)
+  {
+    off_t offset = file->offset;
+    ssize_t n = ::sendfile(fd, file->fd, file->seekable ? &offset : NULL, seg->size);
+    if (n > 0)
+    {
+      retrieve(n);
+      return n;
+    }
+    else if (n == 0)
+    {
+      LOG_ERROR << "ChainBuffer::writeFile - file is shorter than expected";
+      errno = EIO;
+      return -1;
+    }
+    else if (errno != EINVAL && errno != ENOSYS && errno != ESPIPE)
+    {
+      return -1;
+    }
+    file->useSplice = true;
+  }
+  return spliceFile(fd, seg);
+}
+
+// file -> pipe -> fd, what fd doesn't take stays in the pipe of the
+// file for the next write, it's never copied to user space.
+ssize_t ChainBuffer::spliceFile(int fd, Segment* seg)
+{
+  File* file = seg->file;
+  if (file->pipefd[0] < 0 && ::pipe2(file->pipefd, O_NONBLOCK | O_CLOEXEC) < 0)
+  {
+    LOG_SYSERR << "ChainBuffer::spliceFile - pipe2";
+    errno = EIO;
+    return -1;
+  }
+  if (file->piped < std::min(seg->size, kPipeSize))
+  {
+    loff_t offset = file->offset;
+    ssize_t nin = ::splice(file->fd, file->seekable ? &offset : NULL,
+                           file->pipefd[1], NULL,
+                           std::min(seg->size, kPipeSize) - file->piped,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (nin > 0)
+    {
+      file->offset += nin;
+      file->piped += nin;
+    }
+    else if (file->piped == 0)
+    {
+      if (nin == 0)
+      {
+        LOG_ERROR << "ChainBuffer::spliceFile - file is shorter than expected";
+      }
+      else
+      {
+        LOG_SYSERR << "ChainBuffer::spliceFile - splice from file";
+      }
+      errno = EIO;
+      return -1;
+    }
+    // else the pipe is full, with bytes of pages it can't merge
+  }
+  ssize_t nout = ::splice(file->pipefd[0], NULL, fd, NULL, file->piped,
+                          SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (nout > 0)
+  {
+    file->piped -= nout;
+    seg->size -= nout;
+    readable_ -= nout;
+    if (seg->size == 0)
+    {
+      popFront();
+    }
+  }
+  return nout;
+}
+
+// moves bytes in the pipe of a file segment into memory in front of it,
+// for those who read segments. Only the front file is ever spliced,
+// though prepend() may have put memory before it.
+void ChainBuffer::unpipe()
+{
+  for (std::deque<Segment>::iterator it = segments_.begin(); it != segments_.end(); ++it)
+  {
+    File* file = it->file;
+    if (file && file->piped > 0)
+    {
+      std::shared_ptr<string> storage(new string(file->piped, '\0'));
+      readPipe(file->pipefd[0], &(*storage)[0], file->piped);
+      Segment seg;
+      seg.data = storage->data();
+      seg.size = storage->size();
+      seg.owner = storage;
+      if (it->size == file->piped)
+      {
+        *it = std::move(seg);  // closes the file
+      }
+      else
+      {
+        it->size -= file->piped;
+        file->piped = 0;
+        segments_.insert(it, std::move(seg));
+      }
+      return;
+    }
+  }
+}
+
+bool ChainBuffer::copyOut(const Segment& seg, size_t len, char* dest)
+{
+  assert(len <= seg.size);
+  if (seg.file == NULL)
+  {
+    ::memcpy(dest, seg.data, len);
+    return true;
+  }
+  size_t copied = 0;
+  while (copied < len)
+  {
+    ssize_t n = seg.file->seekable
+        ? ::pread(seg.file->fd, dest + copied, len - copied, seg.file->offset + copied)
+        : ::read(seg.file->fd, dest + copied, len - copied);
+    if (n > 0)
+    {
+      copied += n;
+    }
+    else if (n < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else
+    {
+      LOG_SYSERR << "ChainBuffer::copyOut - file is shorter than expected or unreadable";
+      ::memset(dest + copied, 0, len - copied);
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ChainBuffer::tailRoom() const
+{
+  if (segments_.empty() || segments_.back().block == NULL)
+  {
+    return 0;
+  }
+  const Segment& tail = segments_.back();
+  return kBlockSize - (tail.data - tail.block) - tail.size;
+}
+
+void ChainBuffer::pushBlock()
+{
+  Segment seg;
+  seg.block = allocBlock();
+  seg.data = seg.block;
+  segments_.push_back(std::move(seg));
+}
+
+void ChainBuffer::popFront()
+{
+  if (segments_.front().block)
+  {
+    freeBlock(segments_.front().block);
+  }
+  segments_.pop_front();
+}
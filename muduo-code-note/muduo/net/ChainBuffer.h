@@ -0,0 +1,183 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_CHAINBUFFER_H
+#define MUDUO_NET_CHAINBUFFER_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/StringPiece.h>
+#include <muduo/base/Types.h>
+
+#include <muduo/net/Endian.h>
+
+#include <deque>
+#include <memory>
+
+struct iovec;
+
+namespace muduo
+{
+namespace net
+{
+
+class Buffer;
+
+/// A segmented buffer for output, modeled after evbuffer of libevent.
+///
+/// Data is a chain of segments, each one is either a fixed size block
+/// from a per-thread pool, a slice of external memory kept alive by
+/// a refcounted owner, or a range of a file. Appending never moves
+/// existing data, and the chain is written with writev(2) and sendfile(2),
+/// so big payloads are neither copied nor reallocated.
+///
+/// Buffer-like accessors that need contiguous memory (peek(), findCRLF())
+/// pull the whole content up into one segment first, they are for
+/// compatibility, not for the fast path.
+class ChainBuffer : noncopyable
+{
+ public:
+  static const size_t kBlockSize = 4096;
+  static const int kMaxIovecs = 64;
+
+  ChainBuffer();
+  ~ChainBuffer();
+
+  void swap(ChainBuffer& rhs);
+
+  size_t readableBytes() const
+  { return readable_; }
+
+  size_t numSegments() const
+  { return segments_.size(); }
+
+  /// Bytes of pool blocks held by this buffer.
+  size_t internalCapacity() const;
+
+  /// Makes readable bytes contiguous.
+  const char* peek();
+  const char* findCRLF();
+
+  void retrieve(size_t len);
+  void retrieveAll();
+  string retrieveAsString(size_t len);
+  string retrieveAllAsString()
+  { return retrieveAsString(readableBytes()); }
+
+  void append(const StringPiece& str)
+  { append(str.data(), str.size()); }
+  void append(const void* /*restrict*/ data, size_t len);
+
+  /// Appends without copying, @c owner keeps @c slice alive
+  /// until it is retrieved.
+  void append(const StringPiece& slice, const std::shared_ptr<const void>& owner);
+
+  /// Takes content of @c buf, which is empty afterwards.
+  /// Small content is copied, the storage of big one is stolen.
+  void append(Buffer* buf);
+
+  /// Appends @c length bytes of file @c fd from @c offset, which are
+  /// read when written out. @c fd is dup(2)-ed, caller may close it.
+  /// @return false if dup(2) fails
+  bool appendFile(int fd, int64_t offset, size_t length);
+
+  /// Reads at most @c len bytes of the leading file segment into memory,
+  /// for writers that can't take a file, see fillIovec().
+  /// @return false if the file is shorter than expected or unreadable
+  bool readFileFront(size_t len);
+
+  void prepend(const void* /*restrict*/ data, size_t len);
+
+  void appendInt64(int64_t x)
+  {
+    int64_t be64 = sockets::hostToNetwork64(x);
+    append(&be64, sizeof be64);
+  }
+
+  void appendInt32(int32_t x)
+  {
+    int32_t be32 = sockets::hostToNetwork32(x);
+    append(&be32, sizeof be32);
+  }
+
+  void appendInt16(int16_t x)
+  {
+    int16_t be16 = sockets::hostToNetwork16(x);
+    append(&be16, sizeof be16);
+  }
+
+  void appendInt8(int8_t x)
+  {
+    append(&x, sizeof x);
+  }
+
+  void prependInt64(int64_t x)
+  {
+    int64_t be64 = sockets::hostToNetwork64(x);
+    prepend(&be64, sizeof be64);
+  }
+
+  void prependInt32(int32_t x)
+  {
+    int32_t be32 = sockets::hostToNetwork32(x);
+    prepend(&be32, sizeof be32);
+  }
+
+  void prependInt16(int16_t x)
+  {
+    int16_t be16 = sockets::hostToNetwork16(x);
+    prepend(&be16, sizeof be16);
+  }
+
+  void prependInt8(int8_t x)
+  {
+    prepend(&x, sizeof x);
+  }
+
+  /// Fills @c iov with at most @c maxIov leading memory segments,
+  /// stops at the first file segment.
+  /// @return number of iovecs filled.
+  int fillIovec(struct iovec* iov, int maxIov) const;
+
+  /// Writes data directly from buffer with writev(2), or with
+  /// sendfile(2) and splice(2) for a leading file segment,
+  /// and retrieves what is written.
+  /// Failure of reading the file is reported as EIO.
+  /// @return result of writev(2), @c errno is saved
+  ssize_t writeFd(int fd, int* savedErrno);
+
+ private:
+  struct File;
+
+  struct Segment
+  {
+    Segment()
+      : data(NULL), size(0), block(NULL), file(NULL)
+    { }
+
+    const char* data;
+    size_t size;
+    char* block;  // pool block holding data, NULL for a slice
+    File* file;   // kept by owner, NULL unless a file range
+    std::shared_ptr<const void> owner;
+  };
+
+  ssize_t writeFile(int fd, Segment* seg);
+  ssize_t spliceFile(int fd, Segment* seg);
+  void unpipe();
+  static bool copyOut(const Segment& seg, size_t len, char* dest);
+  size_t tailRoom() const;
+  void pushBlock();
+  void popFront();
+
+  std::deque<Segment> segments_;
+  size_t readable_;
+
+  static const char kCRLF[];
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_CHAINBUFFER_H
@@ -28,6 +28,7 @@ Channel::Channel(EventLoop* loop, int fd__)
     revents_(0),
     index_(-1),
     logHup_(true),
+    edgeTriggered_(false),
     tied_(false),
     eventHandling_(false),
     addedToLoop_(false)
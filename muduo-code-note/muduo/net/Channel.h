@@ -64,9 +64,17 @@ class Channel : noncopyable
   void enableWriting() { events_ |= kWriteEvent; update(); }
   void disableWriting() { events_ &= ~kWriteEvent; update(); }
   void disableAll() { events_ = kNoneEvent; update(); }
+  // one update, for edge triggered channels keeping both registered
+  void enableAll() { events_ = kReadEvent | kWriteEvent; update(); }
   bool isWriting() const { return events_ & kWriteEvent; }
   bool isReading() const { return events_ & kReadEvent; }
 
+  /// Edge triggered, an event is reported once per change of readiness,
+  /// the owner must read or write until EAGAIN before waiting for more.
+  /// Only for pollers supporting it, see Poller::supportsEdgeTriggered().
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; if (addedToLoop_) update(); }
+  bool isEdgeTriggered() const { return edgeTriggered_; }
+
   // for Poller
   int index() { return index_; }
   void set_index(int idx) { index_ = idx; }
@@ -96,6 +104,7 @@ class Channel : noncopyable
   int        revents_; // it's the received event types of epoll or poll
   int        index_; // used by Poller.
   bool       logHup_;
+  bool       edgeTriggered_;
 
   std::weak_ptr<void> tie_;
   bool tied_;
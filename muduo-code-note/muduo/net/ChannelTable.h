@@ -0,0 +1,109 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_CHANNELTABLE_H
+#define MUDUO_NET_CHANNELTABLE_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <assert.h>
+#include <stdint.h>
+
+namespace muduo
+{
+namespace net
+{
+
+class Channel;
+
+///
+/// Channels registered in a Poller, indexed by fd.
+///
+/// fds are small dense integers, so a flat table replaces a map,
+/// a lookup on every event is one indexed load.
+///
+/// Each slot has a generation, bumped when a channel is added.
+/// Pollers hand it to the kernel along with the fd, an event carrying
+/// an old generation belongs to a channel removed since, maybe while
+/// its fd is reused by a new one, and is dropped.
+class ChannelTable : noncopyable
+{
+ public:
+  ChannelTable()
+    : size_(0)
+  {
+  }
+
+  /// NULL if none
+  Channel* find(int fd) const
+  {
+    assert(fd >= 0);
+    return static_cast<size_t>(fd) < slots_.size() ? slots_[fd].channel : NULL;
+  }
+
+  /// NULL if none, or registered after @c generation
+  Channel* find(int fd, uint32_t generation) const
+  {
+    Channel* channel = find(fd);
+    return channel && slots_[fd].generation == generation ? channel : NULL;
+  }
+
+  bool contains(int fd, const Channel* channel) const
+  {
+    return channel != NULL && find(fd) == channel;
+  }
+
+  /// valid if find(fd)
+  uint32_t generation(int fd) const
+  {
+    assert(find(fd) != NULL);
+    return slots_[fd].generation;
+  }
+
+  /// @return the new generation of @c fd
+  uint32_t add(int fd, Channel* channel)
+  {
+    assert(fd >= 0 && channel != NULL);
+    if (static_cast<size_t>(fd) >= slots_.size())
+    {
+      slots_.resize(std::max(static_cast<size_t>(fd) + 1, slots_.size() * 2));
+    }
+    Slot& slot = slots_[fd];
+    assert(slot.channel == NULL);
+    slot.channel = channel;
+    ++size_;
+    return ++slot.generation;
+  }
+
+  void remove(int fd)
+  {
+    assert(find(fd) != NULL);
+    slots_[fd].channel = NULL;
+    --size_;
+  }
+
+  size_t size() const
+  { return size_; }
+
+ private:
+  struct Slot
+  {
+    Slot() : channel(NULL), generation(0) { }
+
+    Channel* channel;
+    uint32_t generation;
+  };
+
+  std::vector<Slot> slots_;
+  size_t size_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_CHANNELTABLE_H
@@ -0,0 +1,141 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/ConnectionStats.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void ConnectionStats::updateBacklog(int64_t pending, bool aboveHighWater, MonotonicTime now)
+{
+  backlog.store(pending, std::memory_order_relaxed);
+  if (pending > maxBacklog.load(std::memory_order_relaxed))
+  {
+    maxBacklog.store(pending, std::memory_order_relaxed);
+  }
+  int64_t since = highWaterSince.load(std::memory_order_relaxed);
+  if (aboveHighWater && since == 0)
+  {
+    highWaterSince.store(now.microSeconds(), std::memory_order_relaxed);
+  }
+  else if (!aboveHighWater && since != 0)
+  {
+    add(&highWaterMicroSeconds, now.microSeconds() - since);
+    highWaterSince.store(0, std::memory_order_relaxed);
+  }
+}
+
+int64_t ConnectionStats::highWaterMicroSecondsAt(MonotonicTime now) const
+{
+  int64_t total = highWaterMicroSeconds.load(std::memory_order_relaxed);
+  int64_t since = highWaterSince.load(std::memory_order_relaxed);
+  if (since != 0 && now.microSeconds() > since)
+  {
+    total += now.microSeconds() - since;
+  }
+  return total;
+}
+
+string ConnectionStats::toString(MonotonicTime now) const
+{
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           " age %.3fs in %" PRId64 " out %" PRId64 " reads %" PRId64
+           " writes %" PRId64 " backlog %" PRId64 " max_backlog %" PRId64
+           " high_water %.3fs",
+           static_cast<double>(ageMicroSeconds(now)) / MonotonicTime::kMicroSecondsPerSecond,
+           bytesReceived.load(std::memory_order_relaxed),
+           bytesSent.load(std::memory_order_relaxed),
+           reads.load(std::memory_order_relaxed),
+           writes.load(std::memory_order_relaxed),
+           backlog.load(std::memory_order_relaxed),
+           maxBacklog.load(std::memory_order_relaxed),
+           static_cast<double>(highWaterMicroSecondsAt(now)) / MonotonicTime::kMicroSecondsPerSecond);
+  return name + " " + peer + buf;
+}
+
+ConnectionStatsRegistry::ConnectionStatsRegistry()
+  : closed_(0),
+    closedBytesReceived_(0),
+    closedBytesSent_(0),
+    closedReads_(0),
+    closedWrites_(0)
+{
+}
+
+void ConnectionStatsRegistry::add(const ConnectionStatsPtr& stats)
+{
+  MutexLockGuard lock(mutex_);
+  stats->index_ = live_.size();
+  live_.push_back(stats);
+}
+
+void ConnectionStatsRegistry::remove(const ConnectionStatsPtr& stats)
+{
+  MutexLockGuard lock(mutex_);
+  size_t index = stats->index_;
+  assert(index < live_.size() && live_[index] == stats);
+  // swap with the last, O(1)
+  live_[index] = live_.back();
+  live_[index]->index_ = index;
+  live_.pop_back();
+  ++closed_;
+  closedBytesReceived_ += stats->bytesReceived.load(std::memory_order_relaxed);
+  closedBytesSent_ += stats->bytesSent.load(std::memory_order_relaxed);
+  closedReads_ += stats->reads.load(std::memory_order_relaxed);
+  closedWrites_ += stats->writes.load(std::memory_order_relaxed);
+}
+
+std::vector<ConnectionStatsPtr> ConnectionStatsRegistry::snapshot() const
+{
+  MutexLockGuard lock(mutex_);
+  return live_;
+}
+
+string ConnectionStatsRegistry::toString() const
+{
+  int64_t live = 0;
+  int64_t closed = 0;
+  int64_t bytesReceived = 0;
+  int64_t bytesSent = 0;
+  int64_t reads = 0;
+  int64_t writes = 0;
+  int64_t backlog = 0;
+  int64_t maxBacklog = 0;
+  {
+  MutexLockGuard lock(mutex_);
+  live = static_cast<int64_t>(live_.size());
+  closed = closed_;
+  bytesReceived = closedBytesReceived_;
+  bytesSent = closedBytesSent_;
+  reads = closedReads_;
+  writes = closedWrites_;
+  for (const ConnectionStatsPtr& stats : live_)
+  {
+    bytesReceived += stats->bytesReceived.load(std::memory_order_relaxed);
+    bytesSent += stats->bytesSent.load(std::memory_order_relaxed);
+    reads += stats->reads.load(std::memory_order_relaxed);
+    writes += stats->writes.load(std::memory_order_relaxed);
+    int64_t b = stats->backlog.load(std::memory_order_relaxed);
+    backlog += b;
+    maxBacklog = std::max(maxBacklog, b);
+  }
+  }
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           "connections %" PRId64 " closed %" PRId64 " in %" PRId64 " out %" PRId64
+           " reads %" PRId64 " writes %" PRId64 " backlog %" PRId64 " largest_backlog %" PRId64,
+           live, closed, bytesReceived, bytesSent, reads, writes, backlog, maxBacklog);
+  return buf;
+}
@@ -0,0 +1,136 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_CONNECTIONSTATS_H
+#define MUDUO_NET_CONNECTIONSTATS_H
+
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/base/Mutex.h>
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Types.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Traffic counters of a TcpConnection.
+///
+/// Written by the loop thread of the connection, plain relaxed stores,
+/// read from any thread, also after the connection is gone.
+class ConnectionStats : noncopyable
+{
+ public:
+  ConnectionStats(const string& nameArg, const string& peerArg)
+    : name(nameArg),
+      peer(peerArg),
+      creationTime(MonotonicTime::now()),
+      bytesReceived(0),
+      bytesSent(0),
+      reads(0),
+      writes(0),
+      backlog(0),
+      maxBacklog(0),
+      highWaterMicroSeconds(0),
+      highWaterSince(0),
+      index_(0)
+  { }
+
+  const string name;
+  const string peer;
+  const MonotonicTime creationTime;
+
+  std::atomic<int64_t> bytesReceived;
+  std::atomic<int64_t> bytesSent;
+  std::atomic<int64_t> reads;   // read syscalls, or submitted reads
+  std::atomic<int64_t> writes;  // likewise
+  std::atomic<int64_t> backlog;  // pending output bytes
+  std::atomic<int64_t> maxBacklog;
+  std::atomic<int64_t> highWaterMicroSeconds;  // of finished stays above the mark
+  std::atomic<int64_t> highWaterSince;  // MonotonicTime microseconds, 0 if below
+
+  /// In the loop thread, n bytes or < 0 on error.
+  void recordRead(ssize_t n)
+  {
+    add(&reads, 1);
+    if (n > 0)
+    {
+      add(&bytesReceived, n);
+    }
+  }
+  void recordWrite(ssize_t n)
+  {
+    add(&writes, 1);
+    if (n > 0)
+    {
+      add(&bytesSent, n);
+    }
+  }
+  /// In the loop thread, after pending output changes.
+  void updateBacklog(int64_t pending, bool aboveHighWater, MonotonicTime now);
+
+  int64_t ageMicroSeconds(MonotonicTime now) const
+  { return now.microSeconds() - creationTime.microSeconds(); }
+  /// including the current stay above the high water mark
+  int64_t highWaterMicroSecondsAt(MonotonicTime now) const;
+
+  /// "name peer age 1.5s in 100 out 200 reads 3 writes 2 backlog 0 ..."
+  string toString(MonotonicTime now) const;
+
+ private:
+  friend class ConnectionStatsRegistry;
+
+  static void add(std::atomic<int64_t>* counter, int64_t delta)
+  {
+    // only one writer, no need of a locked add
+    counter->store(counter->load(std::memory_order_relaxed) + delta,
+                   std::memory_order_relaxed);
+  }
+
+  size_t index_;  // in ConnectionStatsRegistry::live_
+};
+
+typedef std::shared_ptr<ConnectionStats> ConnectionStatsPtr;
+
+///
+/// Live connections of an EventLoop and totals of closed ones,
+/// see EventLoop::connectionStats().
+///
+/// Connections are added and removed under a mutex, in their loop thread,
+/// other threads take a snapshot under it and read the counters without.
+class ConnectionStatsRegistry : noncopyable
+{
+ public:
+  ConnectionStatsRegistry();
+
+  void add(const ConnectionStatsPtr& stats);
+  void remove(const ConnectionStatsPtr& stats);
+
+  /// Thread safe, the counters keep moving.
+  std::vector<ConnectionStatsPtr> snapshot() const;
+
+  /// "connections 2 closed 5 in ... out ... reads ... writes ... backlog ..."
+  /// of live and closed ones together, thread safe.
+  string toString() const;
+
+ private:
+  mutable MutexLock mutex_;
+  std::vector<ConnectionStatsPtr> live_ GUARDED_BY(mutex_);
+  int64_t closed_ GUARDED_BY(mutex_);
+  int64_t closedBytesReceived_ GUARDED_BY(mutex_);
+  int64_t closedBytesSent_ GUARDED_BY(mutex_);
+  int64_t closedReads_ GUARDED_BY(mutex_);
+  int64_t closedWrites_ GUARDED_BY(mutex_);
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_CONNECTIONSTATS_H
@@ -15,6 +15,7 @@
 #include <muduo/net/SocketsOps.h>
 
 #include <errno.h>
+#include <stdlib.h>
 
 using namespace muduo;
 using namespace muduo::net;
@@ -26,7 +27,14 @@ Connector::Connector(EventLoop* loop, const InetAddress& serverAddr)
     serverAddr_(serverAddr),
     connect_(false),
     state_(kDisconnected),
-    retryDelayMs_(kInitRetryDelayMs)
+    initRetryDelayMs_(kInitRetryDelayMs),
+    maxRetryDelayMs_(kMaxRetryDelayMs),
+    retryDelayMs_(kInitRetryDelayMs),
+    retryJitter_(false),
+    reconnectBackoff_(false),
+    seed_(static_cast<unsigned int>(reinterpret_cast<uintptr_t>(this)) ^
+          static_cast<unsigned int>(MonotonicTime::now().microSeconds())),
+    fastOpen_(false)
 {
   LOG_DEBUG << "ctor[" << this << "]";
 }
@@ -37,6 +45,14 @@ Connector::~Connector()
   assert(!channel_);
 }
 
+void Connector::setRetryDelay(int initDelayMs, int maxDelayMs)
+{
+  assert(0 < initDelayMs && initDelayMs <= maxDelayMs);
+  initRetryDelayMs_ = initDelayMs;
+  maxRetryDelayMs_ = maxDelayMs;
+  retryDelayMs_ = initDelayMs;
+}
+
 void Connector::start()
 {
   connect_ = true;
@@ -78,6 +94,11 @@ void Connector::stopInLoop()
 void Connector::connect()
 {
   int sockfd = sockets::createNonblockingOrDie(serverAddr_.family());
+  if (fastOpen_ && !sockets::setFastOpenConnect(sockfd))
+  {
+    // falls back to the three-way handshake
+    fastOpen_ = false;
+  }
   int ret = sockets::connect(sockfd, serverAddr_.getSockAddr());
   int savedErrno = (ret == 0) ? 0 : errno;
   switch (savedErrno)
@@ -120,8 +141,15 @@ void Connector::restart()
 {
   loop_->assertInLoopThread();
   setState(kDisconnected);
-  retryDelayMs_ = kInitRetryDelayMs;
   connect_ = true;
+  if (reconnectBackoff_ &&
+      timeDifference(loop_->now(), connectedTime_) * 1000 < retryDelayMs_)
+  {
+    // the server keeps dropping us, don't reconnect in a tight loop
+    scheduleRetry();
+    return;
+  }
+  retryDelayMs_ = initRetryDelayMs_;
   startInLoop();
 }
 
@@ -177,6 +205,7 @@ void Connector::handleWrite()
     else
     {
       setState(kConnected);
+      connectedTime_ = loop_->now();
       if (connect_)
       {
         newConnectionCallback_(sockfd);
@@ -212,11 +241,7 @@ void Connector::retry(int sockfd)
   setState(kDisconnected);
   if (connect_)
   {
-    LOG_INFO << "Connector::retry - Retry connecting to " << serverAddr_.toIpPort()
-             << " in " << retryDelayMs_ << " milliseconds. ";
-    loop_->runAfter(retryDelayMs_/1000.0,
-                    std::bind(&Connector::startInLoop, shared_from_this()));
-    retryDelayMs_ = std::min(retryDelayMs_ * 2, kMaxRetryDelayMs);
+    scheduleRetry();
   }
   else
   {
@@ -224,3 +249,17 @@ void Connector::retry(int sockfd)
   }
 }
 
+void Connector::scheduleRetry()
+{
+  int delayMs = retryDelayMs_;
+  if (retryJitter_)
+  {
+    delayMs = delayMs / 2 + rand_r(&seed_) % (delayMs - delayMs / 2 + 1);
+  }
+  LOG_INFO << "Connector::retry - Retry connecting to " << serverAddr_.toIpPort()
+           << " in " << delayMs << " milliseconds. ";
+  loop_->runAfter(delayMs/1000.0,
+                  std::bind(&Connector::startInLoop, shared_from_this()));
+  retryDelayMs_ = std::min(retryDelayMs_ * 2, maxRetryDelayMs_);
+}
+
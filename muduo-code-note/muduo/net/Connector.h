@@ -11,6 +11,7 @@
 #ifndef MUDUO_NET_CONNECTOR_H
 #define MUDUO_NET_CONNECTOR_H
 
+#include <muduo/base/MonotonicTime.h>
 #include <muduo/base/noncopyable.h>
 #include <muduo/net/InetAddress.h>
 
@@ -37,6 +38,22 @@ class Connector : noncopyable,
   void setNewConnectionCallback(const NewConnectionCallback& cb)
   { newConnectionCallback_ = cb; }
 
+  // client side TCP fast open, see sockets::setFastOpenConnect()
+  void setFastOpen(bool on)
+  { fastOpen_ = on; }
+
+  // retries wait initDelayMs, doubled every time up to maxDelayMs,
+  // 500ms and 30s by default. Before start().
+  void setRetryDelay(int initDelayMs, int maxDelayMs);
+  // waits a random time in [delay/2, delay], so clients dropped together
+  // don't come back together.
+  void setRetryJitter(bool on)
+  { retryJitter_ = on; }
+  // restart() after a connection shorter than the current delay waits and
+  // doubles it as retries do, instead of connecting at once.
+  void setReconnectBackoff(bool on)
+  { reconnectBackoff_ = on; }
+
   void start();  // can be called in any thread
   void restart();  // must be called in loop thread
   void stop();  // can be called in any thread
@@ -56,6 +73,7 @@ class Connector : noncopyable,
   void handleWrite();
   void handleError();
   void retry(int sockfd);
+  void scheduleRetry();
   int removeAndResetChannel();
   void resetChannel();
 
@@ -65,7 +83,14 @@ class Connector : noncopyable,
   States state_;  // FIXME: use atomic variable
   std::unique_ptr<Channel> channel_;
   NewConnectionCallback newConnectionCallback_;
+  int initRetryDelayMs_;
+  int maxRetryDelayMs_;
   int retryDelayMs_;
+  bool retryJitter_;
+  bool reconnectBackoff_;
+  MonotonicTime connectedTime_;
+  unsigned int seed_;  // for rand_r(), in loop thread
+  bool fastOpen_;
 };
 
 }  // namespace net
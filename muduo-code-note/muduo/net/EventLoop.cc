@@ -10,7 +10,10 @@
 
 #include <muduo/base/Logging.h>
 #include <muduo/base/Mutex.h>
+#include <muduo/net/BufferPool.h>
 #include <muduo/net/Channel.h>
+#include <muduo/net/ConnectionStats.h>
+#include <muduo/net/LoopStats.h>
 #include <muduo/net/Poller.h>
 #include <muduo/net/SocketsOps.h>
 #include <muduo/net/TimerQueue.h>
@@ -18,6 +21,7 @@
 #include <algorithm>
 
 #include <signal.h>
+#include <stdlib.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
 
@@ -29,6 +33,11 @@ namespace
 __thread EventLoop* t_loopInThisThread = 0;
 
 const int kPollTimeMs = 10000;
+const int64_t kBusyWindowMicroSeconds = 100 * 1000;
+const double kWallClockCheckSeconds = 1.0;
+// one functor in this many is stamped for stats_->queueDelay
+const unsigned kQueueDelaySampling = 16;
+__thread unsigned t_queuedFunctors = 0;
 
 int createEventfd()
 {
@@ -68,12 +77,30 @@ EventLoop::EventLoop()
     callingPendingFunctors_(false),
     iteration_(0),
     threadId_(CurrentThread::tid()),
+    now_(MonotonicTime::now()),
+    wallClockOffset_(0),
     poller_(Poller::newDefaultPoller(this)),
     timerQueue_(new TimerQueue(this)),
+    bufferPool_(new BufferPool),
+    stats_(new LoopStats),
+    connectionStats_(new ConnectionStatsRegistry),
     wakeupFd_(createEventfd()),
     wakeupChannel_(new Channel(this, wakeupFd_)),
-    currentActiveChannel_(NULL)
+    currentActiveChannel_(NULL),
+    wakeupPending_(false),
+    numConnections_(0),
+    busyMicroSeconds_(0),
+    spinMicroSeconds_(0),
+    busyWindowStart_(now_),
+    busyRatio_(0.0),
+    spinRatio_(0.0),
+    pollStart_(0),
+    busyPollMicroSeconds_(0)
 {
+  if (const char* busyPoll = ::getenv("MUDUO_BUSY_POLL_US"))
+  {
+    setBusyPollMicroSeconds(::atoll(busyPoll));
+  }
   LOG_DEBUG << "EventLoop created " << this << " in thread " << threadId_;
   if (t_loopInThisThread)
   {
@@ -108,31 +135,69 @@ void EventLoop::loop()
   quit_ = false;  // FIXME: what if someone calls quit() before loop() ?
   LOG_TRACE << "EventLoop " << this << " start looping";
 
+  MonotonicTime iterationStart(MonotonicTime::now());
+  int64_t lastWork = iterationStart.microSeconds();
+  pollStart_.store(iterationStart.microSeconds(), std::memory_order_relaxed);
   while (!quit_)
   {
     activeChannels_.clear();
-    pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+    // busy polling, until nothing happens for busyPollMicroSeconds_
+    bool spinning = iterationStart.microSeconds() - lastWork
+                    < busyPollMicroSeconds_.load(std::memory_order_relaxed);
+    now_ = poller_->poll(spinning ? 0 : kPollTimeMs, &activeChannels_);
+    pollReturnTime_ = toWallClock(now_);
+    pollStart_.store(0, std::memory_order_relaxed);
     ++iteration_;
+    if (!spinning || !activeChannels_.empty())
+    {
+      stats_->pollWait.record(now_.microSeconds() - iterationStart.microSeconds());
+      stats_->activeChannels.record(static_cast<int64_t>(activeChannels_.size()));
+    }
     if (Logger::logLevel() <= Logger::TRACE)
     {
       printActiveChannels();
     }
     // TODO sort channel by priority
     eventHandling_ = true;
+    MonotonicTime handled(now_);
     for (Channel* channel : activeChannels_)
     {
       currentActiveChannel_ = channel;
       currentActiveChannel_->handleEvent(pollReturnTime_);
+      // one clock read per channel, its end is the start of the next
+      MonotonicTime end(MonotonicTime::now());
+      stats_->handleEvent.record(end.microSeconds() - handled.microSeconds());
+      handled = end;
     }
     currentActiveChannel_ = NULL;
+    size_t numCompletions = poller_->handleCompletions();
     eventHandling_ = false;
-    doPendingFunctors();
+    size_t numFunctors = doPendingFunctors();
+    MonotonicTime iterationEnd(MonotonicTime::now());
+    bool idle = activeChannels_.empty() && numCompletions == 0 && numFunctors == 0;
+    if (!idle)
+    {
+      lastWork = iterationEnd.microSeconds();
+    }
+    updateLoadStats(iterationStart, iterationEnd, spinning && idle);
+    iterationStart = iterationEnd;
   }
 
   LOG_TRACE << "EventLoop " << this << " stop looping";
   looping_ = false;
 }
 
+Timestamp EventLoop::toWallClock(MonotonicTime time)
+{
+  if (!wallClockChecked_.valid() || timeDifference(time, wallClockChecked_) >= kWallClockCheckSeconds)
+  {
+    // the other clock read, once a second
+    wallClockOffset_ = Timestamp::now().microSecondsSinceEpoch() - time.microSeconds();
+    wallClockChecked_ = time;
+  }
+  return Timestamp(time.microSeconds() + wallClockOffset_);
+}
+
 void EventLoop::quit()
 {
   quit_ = true;
@@ -159,12 +224,16 @@ void EventLoop::runInLoop(Functor cb)
 
 void EventLoop::queueInLoop(Functor cb)
 {
-  {
-  MutexLockGuard lock(mutex_);
-  pendingFunctors_.push_back(std::move(cb));
-  }
-
-  if (!isInLoopThread() || callingPendingFunctors_)
+  PendingFunctor pending;
+  pending.functor = std::move(cb);
+  // a clock read costs about as much as the push, sample it
+  pending.queuedMicroSeconds = t_queuedFunctors++ % kQueueDelaySampling == 0
+      ? MonotonicTime::now().microSeconds() : 0;
+  pendingFunctors_.push(std::move(pending));
+
+  // only the first one since the loop took functors writes the eventfd.
+  if ((!isInLoopThread() || callingPendingFunctors_)
+      && !wakeupPending_.exchange(true))
   {
     wakeup();
   }
@@ -172,24 +241,75 @@ void EventLoop::queueInLoop(Functor cb)
 
 size_t EventLoop::queueSize() const
 {
-  MutexLockGuard lock(mutex_);
   return pendingFunctors_.size();
 }
 
+double EventLoop::busyRatio() const
+{
+  int64_t pollStart = pollStart_.load(std::memory_order_relaxed);
+  if (pollStart > 0
+      && MonotonicTime::now().microSeconds() - pollStart >= kBusyWindowMicroSeconds)
+  {
+    return 0.0;
+  }
+  return busyRatio_.load(std::memory_order_relaxed);
+}
+
+double EventLoop::spinRatio() const
+{
+  int64_t pollStart = pollStart_.load(std::memory_order_relaxed);
+  if (pollStart > 0
+      && MonotonicTime::now().microSeconds() - pollStart >= kBusyWindowMicroSeconds)
+  {
+    return 0.0;
+  }
+  return spinRatio_.load(std::memory_order_relaxed);
+}
+
+void EventLoop::updateLoadStats(MonotonicTime iterationStart, MonotonicTime iterationEnd, bool idleSpin)
+{
+  if (idleSpin)
+  {
+    // the whole iteration, mostly in poll()
+    spinMicroSeconds_ += iterationEnd.microSeconds() - iterationStart.microSeconds();
+  }
+  else
+  {
+    busyMicroSeconds_ += iterationEnd.microSeconds() - now_.microSeconds();
+  }
+  int64_t window = iterationEnd.microSeconds() - busyWindowStart_.microSeconds();
+  if (window >= kBusyWindowMicroSeconds)
+  {
+    busyRatio_.store(static_cast<double>(busyMicroSeconds_) / static_cast<double>(window),
+                     std::memory_order_relaxed);
+    spinRatio_.store(static_cast<double>(spinMicroSeconds_) / static_cast<double>(window),
+                     std::memory_order_relaxed);
+    busyMicroSeconds_ = 0;
+    spinMicroSeconds_ = 0;
+    busyWindowStart_ = iterationEnd;
+  }
+  pollStart_.store(iterationEnd.microSeconds(), std::memory_order_relaxed);
+}
+
 TimerId EventLoop::runAt(Timestamp time, TimerCallback cb)
+{
+  return runAt(MonotonicTime::fromTimestamp(time), std::move(cb));
+}
+
+TimerId EventLoop::runAt(MonotonicTime time, TimerCallback cb)
 {
   return timerQueue_->addTimer(std::move(cb), time, 0.0);
 }
 
 TimerId EventLoop::runAfter(double delay, TimerCallback cb)
 {
-  Timestamp time(addTime(Timestamp::now(), delay));
+  MonotonicTime time(addTime(MonotonicTime::now(), delay));
   return runAt(time, std::move(cb));
 }
 
 TimerId EventLoop::runEvery(double interval, TimerCallback cb)
 {
-  Timestamp time(addTime(Timestamp::now(), interval));
+  MonotonicTime time(addTime(MonotonicTime::now(), interval));
   return timerQueue_->addTimer(std::move(cb), time, interval);
 }
 
@@ -224,6 +344,28 @@ bool EventLoop::hasChannel(Channel* channel)
   return poller_->hasChannel(channel);
 }
 
+bool EventLoop::supportsEdgeTriggered() const
+{
+  return poller_->supportsEdgeTriggered();
+}
+
+bool EventLoop::supportsCompletion() const
+{
+  return poller_->supportsCompletion();
+}
+
+void EventLoop::submitRead(int fd, void* buf, size_t len, CompletionCallback cb)
+{
+  assertInLoopThread();
+  poller_->submitRead(fd, buf, len, std::move(cb));
+}
+
+void EventLoop::submitWritev(int fd, const struct iovec* iov, int iovcnt, CompletionCallback cb)
+{
+  assertInLoopThread();
+  poller_->submitWritev(fd, iov, iovcnt, std::move(cb));
+}
+
 void EventLoop::abortNotInLoopThread()
 {
   LOG_FATAL << "EventLoop::abortNotInLoopThread - EventLoop " << this
@@ -251,21 +393,25 @@ void EventLoop::handleRead()
   }
 }
 
-void EventLoop::doPendingFunctors()
+size_t EventLoop::doPendingFunctors()
 {
-  std::vector<Functor> functors;
   callingPendingFunctors_ = true;
-
-  {
-  MutexLockGuard lock(mutex_);
-  functors.swap(pendingFunctors_);
-  }
-
-  for (const Functor& functor : functors)
-  {
-    functor();
-  }
+  // before taking functors, so that one pushed after this wakes us up,
+  // including one whose push is not finished when we take.
+  wakeupPending_.exchange(false);
+
+  // delays until this batch starts, one clock read for all
+  Histogram& queueDelay = stats_->queueDelay;
+  int64_t now = MonotonicTime::now().microSeconds();
+  size_t n = pendingFunctors_.consume([&queueDelay, now](const PendingFunctor& pending) {
+    if (pending.queuedMicroSeconds != 0)
+    {
+      queueDelay.record(now - pending.queuedMicroSeconds);
+    }
+    pending.functor();
+  });
   callingPendingFunctors_ = false;
+  return n;
 }
 
 void EventLoop::printActiveChannels() const
@@ -18,17 +18,24 @@
 #include <boost/any.hpp>
 
 #include <muduo/base/Mutex.h>
+#include <muduo/base/MpscQueue.h>
 #include <muduo/base/CurrentThread.h>
+#include <muduo/base/MonotonicTime.h>
 #include <muduo/base/Timestamp.h>
 #include <muduo/net/Callbacks.h>
 #include <muduo/net/TimerId.h>
 
+struct iovec;
+
 namespace muduo
 {
 namespace net
 {
 
+class BufferPool;
+struct LoopStats;
 class Channel;
+class ConnectionStatsRegistry;
 class Poller;
 class TimerQueue;
 
@@ -39,7 +46,9 @@ class TimerQueue;
 class EventLoop : noncopyable
 {
  public:
-  typedef std::function<void()> Functor;
+  // move-only, doesn't allocate for small closures, see InlineFunction
+  typedef InlineFunction<void()> Functor;
+  typedef std::function<void (ssize_t)> CompletionCallback;
 
   EventLoop();
   ~EventLoop();  // force out-line dtor, for std::unique_ptr members.
@@ -59,9 +68,19 @@ class EventLoop : noncopyable
 
   ///
   /// Time when poll returns, usually means data arrival.
+  /// Derived from now(), with the offset of the wall clock checked
+  /// once a second, so it follows a step of the wall clock in a second.
   ///
   Timestamp pollReturnTime() const { return pollReturnTime_; }
 
+  ///
+  /// Monotonic time when poll returns, taken once per iteration.
+  /// For callbacks of this iteration which need no time more precise,
+  /// e.g. idle timeouts, instead of a clock call each.
+  /// Must be called in the loop thread.
+  ///
+  MonotonicTime now() const { return now_; }
+
   int64_t iteration() const { return iteration_; }
 
   /// Runs callback immediately in the loop thread.
@@ -76,13 +95,36 @@ class EventLoop : noncopyable
 
   size_t queueSize() const;
 
+  // live metrics, safe to read from other threads, see LoopSelector
+
+  /// Number of TcpConnection objects of this loop.
+  int numConnections() const
+  { return numConnections_.load(std::memory_order_relaxed); }
+  /// Fraction of time spent out of poll(), in the last 100ms or so,
+  /// 0 if the loop has been waiting in poll() for longer than that.
+  double busyRatio() const;
+  /// Fraction of time spent busy polling for nothing, likewise.
+  double spinRatio() const;
+
+  /// Busy polling, polls without blocking until nothing has happened
+  /// for @c microSeconds, then blocks in poll() as usual.
+  /// Saves the wakeup latency of a blocked thread, at the cost of CPU.
+  /// 0 disables it, defaults to MUDUO_BUSY_POLL_US environment variable.
+  /// Safe to call from other threads.
+  void setBusyPollMicroSeconds(int64_t microSeconds)
+  { busyPollMicroSeconds_.store(microSeconds, std::memory_order_relaxed); }
+
   // timers
 
   ///
   /// Runs callback at 'time'.
   /// Safe to call from other threads.
   ///
+  /// The wall clock time is converted to the monotonic clock now,
+  /// later steps of the wall clock don't move the timer.
+  ///
   TimerId runAt(Timestamp time, TimerCallback cb);
+  TimerId runAt(MonotonicTime time, TimerCallback cb);
   ///
   /// Runs callback after @c delay seconds.
   /// Safe to call from other threads.
@@ -104,6 +146,25 @@ class EventLoop : noncopyable
   void updateChannel(Channel* channel);
   void removeChannel(Channel* channel);
   bool hasChannel(Channel* channel);
+  // see Poller::supportsEdgeTriggered()
+  bool supportsEdgeTriggered() const;
+
+  // completion based I/O, see Poller::submitRead()
+  bool supportsCompletion() const;
+  void submitRead(int fd, void* buf, size_t len, CompletionCallback cb);
+  void submitWritev(int fd, const struct iovec* iov, int iovcnt, CompletionCallback cb);
+
+  // storage of input buffers, see BufferPool
+  BufferPool* bufferPool() { return bufferPool_.get(); }
+
+  // histograms of this loop, readable from any thread, see LoopStats
+  LoopStats& stats() { return *stats_; }
+  // connections of this loop, thread safe, see ConnectionStatsRegistry
+  ConnectionStatsRegistry& connectionStats() { return *connectionStats_; }
+
+  // by TcpConnection ctor and connectDestroyed()
+  void updateConnectionCount(int delta)
+  { numConnections_.fetch_add(delta, std::memory_order_relaxed); }
 
   // pid_t threadId() const { return threadId_; }
   void assertInLoopThread()
@@ -131,7 +192,9 @@ class EventLoop : noncopyable
  private:
   void abortNotInLoopThread();
   void handleRead();  // waked up
-  void doPendingFunctors();
+  size_t doPendingFunctors();
+  Timestamp toWallClock(MonotonicTime time);
+  void updateLoadStats(MonotonicTime iterationStart, MonotonicTime iterationEnd, bool idleSpin);
 
   void printActiveChannels() const; // DEBUG
 
@@ -144,8 +207,14 @@ class EventLoop : noncopyable
   int64_t iteration_;
   const pid_t threadId_;
   Timestamp pollReturnTime_;
+  MonotonicTime now_;
+  int64_t wallClockOffset_;  // Timestamp - MonotonicTime, microseconds
+  MonotonicTime wallClockChecked_;
   std::unique_ptr<Poller> poller_;
   std::unique_ptr<TimerQueue> timerQueue_;
+  std::unique_ptr<BufferPool> bufferPool_;
+  std::unique_ptr<LoopStats> stats_;
+  std::unique_ptr<ConnectionStatsRegistry> connectionStats_;
   int wakeupFd_;
   // unlike in TimerQueue, which is an internal class,
   // we don't expose Channel to client.
@@ -156,8 +225,25 @@ class EventLoop : noncopyable
   ChannelList activeChannels_;
   Channel* currentActiveChannel_;
 
-  mutable MutexLock mutex_;
-  std::vector<Functor> pendingFunctors_ GUARDED_BY(mutex_);
+  struct PendingFunctor
+  {
+    Functor functor;
+    int64_t queuedMicroSeconds;  // MonotonicTime, for stats_->queueDelay, 0 if not sampled
+  };
+  MpscQueue<PendingFunctor> pendingFunctors_;
+  // set by the first queueInLoop() that writes wakeupFd_,
+  // cleared when the loop takes the functors.
+  std::atomic<bool> wakeupPending_;
+
+  std::atomic<int> numConnections_;
+  // busy and spinning time of the current window, see busyRatio()
+  int64_t busyMicroSeconds_;
+  int64_t spinMicroSeconds_;
+  MonotonicTime busyWindowStart_;
+  std::atomic<double> busyRatio_;
+  std::atomic<double> spinRatio_;
+  std::atomic<int64_t> pollStart_;  // MonotonicTime microseconds, 0 if not in poll()
+  std::atomic<int64_t> busyPollMicroSeconds_;
 };
 
 }  // namespace net
@@ -30,6 +30,10 @@ class EventLoopThread : noncopyable
   EventLoopThread(const ThreadInitCallback& cb = ThreadInitCallback(),
                   const string& name = string());
   ~EventLoopThread();
+  // see Thread::setCpuAffinity(), before startLoop(),
+  // the loop and its Poller are created in the thread, so on the NUMA node.
+  void setCpuAffinity(const std::vector<int>& cpus)
+  { thread_.setCpuAffinity(cpus); }
   EventLoop* startLoop();
 
  private:
@@ -11,11 +11,98 @@
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/EventLoopThread.h>
 
+#include <random>
+
 #include <stdio.h>
 
 using namespace muduo;
 using namespace muduo::net;
 
+namespace
+{
+
+typedef double (*LoopMetric)(EventLoop*);
+
+double connections(EventLoop* loop)
+{
+  return loop->numConnections();
+}
+
+double pendingFunctors(EventLoop* loop)
+{
+  return static_cast<double>(loop->queueSize());
+}
+
+double busyRatio(EventLoop* loop)
+{
+  return loop->busyRatio();
+}
+
+// the least of all loops, scanning from the one after last pick
+class LeastSelector
+{
+ public:
+  explicit LeastSelector(LoopMetric metric)
+    : metric_(metric),
+      next_(0)
+  {
+  }
+
+  EventLoop* operator()(const std::vector<EventLoop*>& loops)
+  {
+    size_t n = loops.size();
+    size_t best = next_ % n;
+    double least = metric_(loops[best]);
+    for (size_t i = 1; i < n; ++i)
+    {
+      size_t j = (next_ + i) % n;
+      double value = metric_(loops[j]);
+      if (value < least)
+      {
+        best = j;
+        least = value;
+      }
+    }
+    next_ = best + 1;
+    return loops[best];
+  }
+
+ private:
+  LoopMetric metric_;
+  size_t next_;
+};
+
+// the lesser of two loops, so a stale metric doesn't send a burst to one loop
+class TwoChoicesSelector
+{
+ public:
+  explicit TwoChoicesSelector(LoopMetric metric)
+    : metric_(metric),
+      next_(0)
+  {
+  }
+
+  EventLoop* operator()(const std::vector<EventLoop*>& loops)
+  {
+    size_t n = loops.size();
+    EventLoop* first = loops[next_++ % n];
+    if (n == 1)
+    {
+      return first;
+    }
+    EventLoop* second = loops[(next_ + random_() % (n - 1)) % n];
+    return metric_(second) < metric_(first) ? second : first;
+  }
+
+ private:
+  LoopMetric metric_;
+  size_t next_;
+  std::minstd_rand random_;
+};
+
+}  // namespace
+
+
 EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop, const string& nameArg)
   : baseLoop_(baseLoop),
     name_(nameArg),
@@ -42,6 +129,10 @@ void EventLoopThreadPool::start(const ThreadInitCallback& cb)
     char buf[name_.size() + 32];
     snprintf(buf, sizeof buf, "%s%d", name_.c_str(), i);
     EventLoopThread* t = new EventLoopThread(cb, buf);
+    if (!cpuSets_.empty())
+    {
+      t->setCpuAffinity(cpuSets_[i % cpuSets_.size()]);
+    }
     threads_.push_back(std::unique_ptr<EventLoopThread>(t));
     loops_.push_back(t->startLoop());
   }
@@ -57,7 +148,11 @@ EventLoop* EventLoopThreadPool::getNextLoop()
   assert(started_);
   EventLoop* loop = baseLoop_;
 
-  if (!loops_.empty())
+  if (!loops_.empty() && selector_)
+  {
+    loop = selector_(loops_);
+  }
+  else if (!loops_.empty())
   {
     // round-robin
     loop = loops_[next_];
@@ -95,3 +190,18 @@ std::vector<EventLoop*> EventLoopThreadPool::getAllLoops()
     return loops_;
   }
 }
+
+LoopSelector EventLoopThreadPool::leastConnections()
+{
+  return LeastSelector(connections);
+}
+
+LoopSelector EventLoopThreadPool::leastPendingFunctors()
+{
+  return LeastSelector(pendingFunctors);
+}
+
+LoopSelector EventLoopThreadPool::leastBusy()
+{
+  return TwoChoicesSelector(busyRatio);
+}
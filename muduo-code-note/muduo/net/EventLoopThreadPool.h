@@ -13,6 +13,7 @@
 
 #include <muduo/base/noncopyable.h>
 #include <muduo/base/Types.h>
+#include <muduo/net/Callbacks.h>
 
 #include <functional>
 #include <memory>
@@ -35,10 +36,27 @@ class EventLoopThreadPool : noncopyable
   EventLoopThreadPool(EventLoop* baseLoop, const string& nameArg);
   ~EventLoopThreadPool();
   void setThreadNum(int numThreads) { numThreads_ = numThreads; }
+  /// Pins the N-th loop thread to cpuSets[N % cpuSets.size()],
+  /// see EventLoopThread::setCpuAffinity(). Before start().
+  void setCpuAffinity(const std::vector<std::vector<int>>& cpuSets)
+  { cpuSets_ = cpuSets; }
   void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
+  /// Replaces round-robin of getNextLoop().
+  void setLoopSelector(const LoopSelector& selector)
+  { selector_ = selector; }
+
+  // built-in selectors, they break ties round-robin.
+  /// Fewest TcpConnection objects.
+  static LoopSelector leastConnections();
+  /// Fewest functors queued by runInLoop().
+  static LoopSelector leastPendingFunctors();
+  /// Lower EventLoop::busyRatio() of two loops, one round-robin,
+  /// one random, as the ratio lags behind a burst of new connections.
+  static LoopSelector leastBusy();
+
   // valid after calling start()
-  /// round-robin
+  /// round-robin, unless setLoopSelector()
   EventLoop* getNextLoop();
 
   /// with the same hash code, it will always return the same EventLoop
@@ -59,6 +77,8 @@ class EventLoopThreadPool : noncopyable
   bool started_;
   int numThreads_;
   int next_;
+  std::vector<std::vector<int>> cpuSets_;
+  LoopSelector selector_;
   std::vector<std::unique_ptr<EventLoopThread>> threads_;
   std::vector<EventLoop*> loops_;
 };
@@ -14,6 +14,7 @@
 
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 
 // INADDR_ANY use (type)value casting.
 #pragma GCC diagnostic ignored "-Wold-style-cast"
@@ -45,12 +46,19 @@ static const in_addr_t kInaddrLoopback = INADDR_LOOPBACK;
 using namespace muduo;
 using namespace muduo::net;
 
-static_assert(sizeof(InetAddress) == sizeof(struct sockaddr_in6),
-              "InetAddress is same size as sockaddr_in6");
+//     struct sockaddr_un {
+//         sa_family_t     sun_family;    /* AF_UNIX */
+//         char            sun_path[108]; /* pathname, or NUL and
+//                                           an abstract name */
+//     };
+
+static_assert(sizeof(InetAddress) == (sizeof(struct sockaddr_un) + 3) / 4 * 4,
+              "InetAddress is sockaddr_un padded to the alignment of sockaddr_in6");
 static_assert(offsetof(sockaddr_in, sin_family) == 0, "sin_family offset 0");
 static_assert(offsetof(sockaddr_in6, sin6_family) == 0, "sin6_family offset 0");
 static_assert(offsetof(sockaddr_in, sin_port) == 2, "sin_port offset 2");
 static_assert(offsetof(sockaddr_in6, sin6_port) == 2, "sin6_port offset 2");
+static_assert(offsetof(sockaddr_un, sun_family) == 0, "sun_family offset 0");
 
 InetAddress::InetAddress(uint16_t port, bool loopbackOnly, bool ipv6)
 {
@@ -88,8 +96,69 @@ InetAddress::InetAddress(StringArg ip, uint16_t port, bool ipv6)
   }
 }
 
+InetAddress InetAddress::unixDomain(StringArg path, bool abstractNamespace)
+{
+  InetAddress addr;
+  memZero(&addr.addrUn_, sizeof addr.addrUn_);
+  addr.addrUn_.sun_family = AF_UNIX;
+  char* dest = abstractNamespace ? addr.addrUn_.sun_path + 1 : addr.addrUn_.sun_path;
+  size_t maxLen = sizeof addr.addrUn_.sun_path - (abstractNamespace ? 1 : 0) - 1;
+  size_t len = ::strlen(path.c_str());
+  if (len > maxLen)
+  {
+    LOG_ERROR << "InetAddress::unixDomain path too long " << path.c_str();
+    len = maxLen;
+  }
+  memcpy(dest, path.c_str(), len);
+  return addr;
+}
+
+InetAddress InetAddress::localAddressOf(int sockfd)
+{
+  InetAddress addr;
+  memZero(&addr.addrUn_, sizeof addr.addrUn_);
+  socklen_t addrlen = static_cast<socklen_t>(sizeof addr.addrUn_);
+  if (::getsockname(sockfd, sockets::sockaddr_cast(&addr.addr6_), &addrlen) < 0)
+  {
+    LOG_SYSERR << "InetAddress::localAddressOf";
+  }
+  return addr;
+}
+
+InetAddress InetAddress::peerAddressOf(int sockfd)
+{
+  InetAddress addr;
+  memZero(&addr.addrUn_, sizeof addr.addrUn_);
+  socklen_t addrlen = static_cast<socklen_t>(sizeof addr.addrUn_);
+  if (::getpeername(sockfd, sockets::sockaddr_cast(&addr.addr6_), &addrlen) < 0)
+  {
+    LOG_SYSERR << "InetAddress::peerAddressOf";
+  }
+  return addr;
+}
+
+string InetAddress::unixPath() const
+{
+  assert(isUnixDomain());
+  const char* path = addrUn_.sun_path;
+  const size_t maxLen = sizeof addrUn_.sun_path;
+  if (path[0] != '\0')
+  {
+    return string(path, ::strnlen(path, maxLen));
+  }
+  else if (path[1] != '\0')
+  {
+    return "@" + string(path + 1, ::strnlen(path + 1, maxLen - 1));
+  }
+  return string();
+}
+
 string InetAddress::toIpPort() const
 {
+  if (isUnixDomain())
+  {
+    return "unix:" + unixPath();
+  }
   char buf[64] = "";
   sockets::toIpPort(buf, sizeof buf, getSockAddr());
   return buf;
@@ -97,6 +166,10 @@ string InetAddress::toIpPort() const
 
 string InetAddress::toIp() const
 {
+  if (isUnixDomain())
+  {
+    return unixPath();
+  }
   char buf[64] = "";
   sockets::toIp(buf, sizeof buf, getSockAddr());
   return buf;
@@ -15,6 +15,7 @@
 #include <muduo/base/StringPiece.h>
 
 #include <netinet/in.h>
+#include <sys/un.h>
 
 namespace muduo
 {
@@ -26,7 +27,7 @@ const struct sockaddr* sockaddr_cast(const struct sockaddr_in6* addr);
 }
 
 ///
-/// Wrapper of sockaddr_in.
+/// Wrapper of sockaddr_in, sockaddr_in6 or sockaddr_un.
 ///
 /// This is an POD interface class.
 class InetAddress : public muduo::copyable
@@ -50,10 +51,27 @@ class InetAddress : public muduo::copyable
     : addr6_(addr)
   { }
 
+  explicit InetAddress(const struct sockaddr_un& addr)
+    : addrUn_(addr)
+  { }
+
+  /// Constructs a Unix domain endpoint, for TcpServer and TcpClient as well.
+  /// @c path is a file system path, or a name in the Linux abstract
+  /// namespace if @c abstractNamespace, which needs no file to unlink.
+  static InetAddress unixDomain(StringArg path, bool abstractNamespace = false);
+
+  /// Address of either end of a connected or bound socket, of any family.
+  static InetAddress localAddressOf(int sockfd);
+  static InetAddress peerAddressOf(int sockfd);
+
   sa_family_t family() const { return addr_.sin_family; }
   string toIp() const;
   string toIpPort() const;
   uint16_t toPort() const;
+  bool isUnixDomain() const { return family() == AF_UNIX; }
+  /// path of a Unix domain endpoint, "@name" in the abstract namespace,
+  /// empty if unnamed.
+  string unixPath() const;
 
   // default copy/assignment are Okay
 
@@ -61,7 +79,7 @@ class InetAddress : public muduo::copyable
   void setSockAddrInet6(const struct sockaddr_in6& addr6) { addr6_ = addr6; }
 
   uint32_t ipNetEndian() const;
-  uint16_t portNetEndian() const { return addr_.sin_port; }
+  uint16_t portNetEndian() const { return isUnixDomain() ? 0 : addr_.sin_port; }
 
   // resolve hostname to IP address, not changing port or sin_family
   // return true on success.
@@ -74,6 +92,7 @@ class InetAddress : public muduo::copyable
   {
     struct sockaddr_in addr_;
     struct sockaddr_in6 addr6_;
+    struct sockaddr_un addrUn_;
   };
 };
 
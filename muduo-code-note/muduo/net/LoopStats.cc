@@ -0,0 +1,27 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/LoopStats.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+string LoopStats::toString() const
+{
+  string result;
+  result += "  poll_wait_us      " + pollWait.toString() + "\n";
+  result += "  active_channels   " + activeChannels.toString() + "\n";
+  result += "  handle_event_us   " + handleEvent.toString() + "\n";
+  result += "  queue_delay_us    " + queueDelay.toString() + "\n";
+  result += "  timer_lateness_us " + timerLateness.toString() + "\n";
+  return result;
+}
+
+void LoopStats::reset()
+{
+  pollWait.reset();
+  activeChannels.reset();
+  handleEvent.reset();
+  queueDelay.reset();
+  timerLateness.reset();
+}
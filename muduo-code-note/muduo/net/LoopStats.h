@@ -0,0 +1,44 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_LOOPSTATS_H
+#define MUDUO_NET_LOOPSTATS_H
+
+#include <muduo/base/Histogram.h>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Always on histograms of an EventLoop, recorded in its thread,
+/// readable from any thread, see EventLoop::stats().
+///
+/// Durations are in microseconds, on the monotonic clock.
+struct LoopStats : noncopyable
+{
+  /// time blocked in poll(), not counted while busy polling finds nothing
+  Histogram pollWait;
+  /// channels with events, per poll() as above
+  Histogram activeChannels;
+  /// time in each Channel::handleEvent()
+  Histogram handleEvent;
+  /// time a functor waits from queueInLoop() to the loop taking its batch,
+  /// of one functor in 16 per queueing thread
+  Histogram queueDelay;
+  /// time a timer runs after its expiration
+  Histogram timerLateness;
+
+  /// one line each, indented
+  string toString() const;
+  /// In the loop thread, see Histogram::reset().
+  void reset();
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_LOOPSTATS_H
@@ -8,6 +8,7 @@
 
 #include <muduo/net/Poller.h>
 
+#include <muduo/base/Logging.h>
 #include <muduo/net/Channel.h>
 
 using namespace muduo;
@@ -23,7 +24,16 @@ Poller::~Poller() = default;
 bool Poller::hasChannel(Channel* channel) const
 {
   assertInLoopThread();
-  ChannelMap::const_iterator it = channels_.find(channel->fd());
-  return it != channels_.end() && it->second == channel;
+  return channels_.contains(channel->fd(), channel);
 }
 
+
+void Poller::submitRead(int fd, void*, size_t, EventLoop::CompletionCallback)
+{
+  LOG_FATAL << "Poller::submitRead fd = " << fd << " - completion I/O is not supported";
+}
+
+void Poller::submitWritev(int fd, const struct iovec*, int, EventLoop::CompletionCallback)
+{
+  LOG_FATAL << "Poller::submitWritev fd = " << fd << " - completion I/O is not supported";
+}
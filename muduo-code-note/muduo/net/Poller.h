@@ -11,10 +11,10 @@
 #ifndef MUDUO_NET_POLLER_H
 #define MUDUO_NET_POLLER_H
 
-#include <map>
 #include <vector>
 
-#include <muduo/base/Timestamp.h>
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/net/ChannelTable.h>
 #include <muduo/net/EventLoop.h>
 
 namespace muduo
@@ -38,7 +38,8 @@ class Poller : noncopyable
 
   /// Polls the I/O events.
   /// Must be called in the loop thread.
-  virtual Timestamp poll(int timeoutMs, ChannelList* activeChannels) = 0;
+  /// @return the time it returns, the only clock read of an iteration
+  virtual MonotonicTime poll(int timeoutMs, ChannelList* activeChannels) = 0;
 
   /// Changes the interested I/O events.
   /// Must be called in the loop thread.
@@ -50,6 +51,25 @@ class Poller : noncopyable
 
   virtual bool hasChannel(Channel* channel) const;
 
+  /// Whether Channel::setEdgeTriggered() is honored,
+  /// others report readiness level triggered regardless.
+  virtual bool supportsEdgeTriggered() const { return false; }
+
+  /// Completion based I/O, only UringPoller supports it.
+  /// Callback gets the result of read(2)/writev(2), or -errno,
+  /// it runs in handleCompletions().
+  virtual bool supportsCompletion() const { return false; }
+  virtual void submitRead(int fd, void* buf, size_t len,
+                          EventLoop::CompletionCallback cb);
+  /// iovecs are copied, the memory they point to must be kept until completion.
+  virtual void submitWritev(int fd, const struct iovec* iov, int iovcnt,
+                            EventLoop::CompletionCallback cb);
+
+  /// Runs callbacks of operations completed in last poll(),
+  /// returns the number of them.
+  /// Must be called in the loop thread.
+  virtual size_t handleCompletions() { return 0; }
+
   static Poller* newDefaultPoller(EventLoop* loop);
 
   void assertInLoopThread() const
@@ -58,8 +78,7 @@ class Poller : noncopyable
   }
 
  protected:
-  typedef std::map<int, Channel*> ChannelMap;
-  ChannelMap channels_;
+  ChannelTable channels_;
 
  private:
   EventLoop* ownerLoop_;
@@ -12,6 +12,7 @@
 #include <muduo/net/InetAddress.h>
 #include <muduo/net/SocketsOps.h>
 
+#include <linux/filter.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <stdio.h>  // snprintf
@@ -75,6 +76,11 @@ int Socket::accept(InetAddress* peeraddr)
   if (connfd >= 0)
   {
     peeraddr->setSockAddrInet6(addr);
+    if (peeraddr->isUnixDomain())
+    {
+      // a path longer than sockaddr_in6 is truncated, usually it's unnamed
+      *peeraddr = InetAddress::peerAddressOf(connfd);
+    }
   }
   return connfd;
 }
@@ -118,6 +124,45 @@ void Socket::setReusePort(bool on)
 #endif
 }
 
+bool Socket::attachReusePortCpuFilter()
+{
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+  const int SO_ATTACH_REUSEPORT_CBPF = 51;
+#endif
+  // A = cpu; return A
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU) },
+    { BPF_RET | BPF_A, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+  prog.len = static_cast<unsigned short>(sizeof code / sizeof code[0]);
+  prog.filter = code;
+  int ret = ::setsockopt(sockfd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                         &prog, static_cast<socklen_t>(sizeof prog));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "SO_ATTACH_REUSEPORT_CBPF failed.";
+  }
+  return ret == 0;
+}
+
+void Socket::setBusyPoll(int microSeconds)
+{
+#ifdef SO_BUSY_POLL
+  int ret = ::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL,
+                         &microSeconds, static_cast<socklen_t>(sizeof microSeconds));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "SO_BUSY_POLL failed.";
+  }
+#else
+  if (microSeconds > 0)
+  {
+    LOG_ERROR << "SO_BUSY_POLL is not supported.";
+  }
+#endif
+}
+
 void Socket::setKeepAlive(bool on)
 {
   int optval = on ? 1 : 0;
@@ -126,3 +171,29 @@ void Socket::setKeepAlive(bool on)
   // FIXME CHECK
 }
 
+void Socket::setDeferAccept(int seconds)
+{
+  int ret = ::setsockopt(sockfd_, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+                         &seconds, static_cast<socklen_t>(sizeof seconds));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "TCP_DEFER_ACCEPT failed.";
+  }
+}
+
+void Socket::setFastOpen(int queueLength)
+{
+#ifdef TCP_FASTOPEN
+  int ret = ::setsockopt(sockfd_, IPPROTO_TCP, TCP_FASTOPEN,
+                         &queueLength, static_cast<socklen_t>(sizeof queueLength));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "TCP_FASTOPEN failed.";
+  }
+#else
+  if (queueLength > 0)
+  {
+    LOG_ERROR << "TCP_FASTOPEN is not supported.";
+  }
+#endif
+}
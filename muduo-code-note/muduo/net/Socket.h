@@ -74,11 +74,37 @@ class Socket : noncopyable
   ///
   void setReusePort(bool on);
 
+  ///
+  /// Attach a SO_ATTACH_REUSEPORT_CBPF program to the SO_REUSEPORT group,
+  /// which picks the N-th listening socket for connections received on CPU N.
+  ///
+  bool attachReusePortCpuFilter();
+
   ///
   /// Enable/disable SO_KEEPALIVE
   ///
   void setKeepAlive(bool on);
 
+  ///
+  /// Set SO_BUSY_POLL, microseconds to busy poll the device queue
+  /// on empty reads, 0 to disable. Raising it above net.core.busy_read
+  /// needs CAP_NET_ADMIN.
+  ///
+  void setBusyPoll(int microSeconds);
+
+  ///
+  /// Set TCP_DEFER_ACCEPT on a listening socket, accept a connection
+  /// only once data arrives, or after about that many seconds.
+  ///
+  void setDeferAccept(int seconds);
+
+  ///
+  /// Set TCP_FASTOPEN on a listening socket, before listen(),
+  /// the length of the queue of pending fast open requests, 0 to disable.
+  /// Takes effect if net.ipv4.tcp_fastopen has bit 2 set.
+  ///
+  void setFastOpen(int queueLength);
+
  private:
   const int sockfd_;
 };
@@ -14,9 +14,12 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>  // snprintf
 #include <sys/socket.h>
-#include <sys/uio.h>  // readv
+#include <sys/uio.h>  // readv, writev
+#include <sys/un.h>
 #include <unistd.h>
 
 using namespace muduo;
@@ -74,10 +77,44 @@ const struct sockaddr_in6* sockets::sockaddr_in6_cast(const struct sockaddr* add
   return static_cast<const struct sockaddr_in6*>(implicit_cast<const void*>(addr));
 }
 
+const struct sockaddr_un* sockets::sockaddr_un_cast(const struct sockaddr* addr)
+{
+  return static_cast<const struct sockaddr_un*>(implicit_cast<const void*>(addr));
+}
+
+socklen_t sockets::sockaddrLength(const struct sockaddr* addr)
+{
+  if (addr->sa_family == AF_INET)
+  {
+    return static_cast<socklen_t>(sizeof(struct sockaddr_in));
+  }
+  else if (addr->sa_family == AF_UNIX)
+  {
+    // a path is NUL terminated, an abstract name is what follows the
+    // leading NUL, up to the length, unnamed if both are empty.
+    const struct sockaddr_un* addrUn = sockaddr_un_cast(addr);
+    const size_t maxLen = sizeof addrUn->sun_path;
+    size_t len = 0;
+    if (addrUn->sun_path[0] != '\0')
+    {
+      len = ::strnlen(addrUn->sun_path, maxLen - 1) + 1;
+    }
+    else if (addrUn->sun_path[1] != '\0')
+    {
+      len = ::strnlen(addrUn->sun_path + 1, maxLen - 1) + 1;
+    }
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + len);
+  }
+  else
+  {
+    return static_cast<socklen_t>(sizeof(struct sockaddr_in6));
+  }
+}
+
 int sockets::createNonblockingOrDie(sa_family_t family)
 {
 #if VALGRIND
-  int sockfd = ::socket(family, SOCK_STREAM, IPPROTO_TCP);
+  int sockfd = ::socket(family, SOCK_STREAM, family == AF_UNIX ? 0 : IPPROTO_TCP);
   if (sockfd < 0)
   {
     LOG_SYSFATAL << "sockets::createNonblockingOrDie";
@@ -85,7 +122,8 @@ int sockets::createNonblockingOrDie(sa_family_t family)
 
   setNonBlockAndCloseOnExec(sockfd);
 #else
-  int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+  int sockfd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        family == AF_UNIX ? 0 : IPPROTO_TCP);
   if (sockfd < 0)
   {
     LOG_SYSFATAL << "sockets::createNonblockingOrDie";
@@ -94,9 +132,19 @@ int sockets::createNonblockingOrDie(sa_family_t family)
   return sockfd;
 }
 
+int sockets::createUdpNonblockingOrDie(sa_family_t family)
+{
+  int sockfd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+  if (sockfd < 0)
+  {
+    LOG_SYSFATAL << "sockets::createUdpNonblockingOrDie";
+  }
+  return sockfd;
+}
+
 void sockets::bindOrDie(int sockfd, const struct sockaddr* addr)
 {
-  int ret = ::bind(sockfd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+  int ret = ::bind(sockfd, addr, sockaddrLength(addr));
   if (ret < 0)
   {
     LOG_SYSFATAL << "sockets::bindOrDie";
@@ -125,7 +173,11 @@ int sockets::accept(int sockfd, struct sockaddr_in6* addr)
   if (connfd < 0)
   {
     int savedErrno = errno;
-    LOG_SYSERR << "Socket::accept";
+    // EAGAIN is the normal end of a batch of accepts
+    if (savedErrno != EAGAIN)
+    {
+      LOG_SYSERR << "Socket::accept";
+    }
     switch (savedErrno)
     {
       case EAGAIN:
@@ -158,7 +210,22 @@ int sockets::accept(int sockfd, struct sockaddr_in6* addr)
 
 int sockets::connect(int sockfd, const struct sockaddr* addr)
 {
-  return ::connect(sockfd, addr, static_cast<socklen_t>(sizeof(struct sockaddr_in6)));
+  return ::connect(sockfd, addr, sockaddrLength(addr));
+}
+
+bool sockets::setFastOpenConnect(int sockfd)
+{
+#ifndef TCP_FASTOPEN_CONNECT
+  const int TCP_FASTOPEN_CONNECT = 30;
+#endif
+  int optval = 1;
+  if (::setsockopt(sockfd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT,
+                   &optval, static_cast<socklen_t>(sizeof optval)) < 0)
+  {
+    LOG_SYSERR << "TCP_FASTOPEN_CONNECT failed.";
+    return false;
+  }
+  return true;
 }
 
 ssize_t sockets::read(int sockfd, void *buf, size_t count)
@@ -176,6 +243,81 @@ ssize_t sockets::write(int sockfd, const void *buf, size_t count)
   return ::write(sockfd, buf, count);
 }
 
+ssize_t sockets::writev(int sockfd, const struct iovec *iov, int iovcnt)
+{
+  return ::writev(sockfd, iov, iovcnt);
+}
+
+ssize_t sockets::readvWithFds(int sockfd, const struct iovec *iov, int iovcnt,
+                              std::vector<int>* fds)
+{
+  const int kMaxFds = 16;
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int) * kMaxFds)];
+  } control;
+  struct msghdr msg;
+  memZero(&msg, sizeof msg);
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof control.buf;
+  ssize_t n = ::recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC);
+  if (n < 0)
+  {
+    return n;
+  }
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+       cmsg != NULL;
+       cmsg = CMSG_NXTHDR(&msg, cmsg))
+  {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+    {
+      size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      const unsigned char* data = CMSG_DATA(cmsg);
+      for (size_t i = 0; i < count; ++i)
+      {
+        int fd;
+        memcpy(&fd, data + i * sizeof fd, sizeof fd);
+        fds->push_back(fd);
+      }
+    }
+  }
+  if (msg.msg_flags & MSG_CTRUNC)
+  {
+    // the kernel has closed those not fitting
+    LOG_ERROR << "sockets::readvWithFds more than " << kMaxFds << " fds in a message";
+  }
+  return n;
+}
+
+ssize_t sockets::writeWithFd(int sockfd, const void *buf, size_t count, int fd)
+{
+  assert(count > 0);
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int))];
+  } control;
+  memZero(&control, sizeof control);
+  struct iovec vec;
+  vec.iov_base = const_cast<void*>(buf);
+  vec.iov_len = count;
+  struct msghdr msg;
+  memZero(&msg, sizeof msg);
+  msg.msg_iov = &vec;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof control.buf;
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof fd);
+  return ::sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+}
+
 void sockets::close(int sockfd)
 {
   if (::close(sockfd) < 0)
@@ -192,6 +334,14 @@ void sockets::shutdownWrite(int sockfd)
   }
 }
 
+void sockets::shutdownReadWrite(int sockfd)
+{
+  if (::shutdown(sockfd, SHUT_RDWR) < 0)
+  {
+    LOG_SYSERR << "sockets::shutdownReadWrite";
+  }
+}
+
 void sockets::toIpPort(char* buf, size_t size,
                        const struct sockaddr* addr)
 {
@@ -12,6 +12,9 @@
 #define MUDUO_NET_SOCKETSOPS_H
 
 #include <arpa/inet.h>
+#include <sys/un.h>
+
+#include <vector>
 
 namespace muduo
 {
@@ -24,16 +27,30 @@ namespace sockets
 /// Creates a non-blocking socket file descriptor,
 /// abort if any error.
 int createNonblockingOrDie(sa_family_t family);
+/// Likewise, of a UDP socket.
+int createUdpNonblockingOrDie(sa_family_t family);
 
 int  connect(int sockfd, const struct sockaddr* addr);
+/// TCP_FASTOPEN_CONNECT, before connect(), which then returns at once,
+/// the SYN goes with the first write. Returns false if not supported.
+bool setFastOpenConnect(int sockfd);
 void bindOrDie(int sockfd, const struct sockaddr* addr);
 void listenOrDie(int sockfd);
 int  accept(int sockfd, struct sockaddr_in6* addr);
 ssize_t read(int sockfd, void *buf, size_t count);
 ssize_t readv(int sockfd, const struct iovec *iov, int iovcnt);
 ssize_t write(int sockfd, const void *buf, size_t count);
+ssize_t writev(int sockfd, const struct iovec *iov, int iovcnt);
+/// recvmsg(2) on a Unix domain socket, descriptors passed with SCM_RIGHTS
+/// are appended to @c fds, close-on-exec.
+ssize_t readvWithFds(int sockfd, const struct iovec *iov, int iovcnt,
+                     std::vector<int>* fds);
+/// sendmsg(2) on a Unix domain socket, passes a duplicate of @c fd
+/// with the first byte of @c buf, @c count must not be zero.
+ssize_t writeWithFd(int sockfd, const void *buf, size_t count, int fd);
 void close(int sockfd);
 void shutdownWrite(int sockfd);
+void shutdownReadWrite(int sockfd);
 
 void toIpPort(char* buf, size_t size,
               const struct sockaddr* addr);
@@ -52,6 +69,9 @@ const struct sockaddr* sockaddr_cast(const struct sockaddr_in6* addr);
 struct sockaddr* sockaddr_cast(struct sockaddr_in6* addr);
 const struct sockaddr_in* sockaddr_in_cast(const struct sockaddr* addr);
 const struct sockaddr_in6* sockaddr_in6_cast(const struct sockaddr* addr);
+const struct sockaddr_un* sockaddr_un_cast(const struct sockaddr* addr);
+/// length of the address for bind() and connect(), by its family
+socklen_t sockaddrLength(const struct sockaddr* addr);
 
 struct sockaddr_in6 getLocalAddr(int sockfd);
 struct sockaddr_in6 getPeerAddr(int sockfd);
@@ -13,6 +13,7 @@
 #include <muduo/net/Connector.h>
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/SocketsOps.h>
+#include <muduo/net/Transport.h>
 
 #include <stdio.h>  // snprintf
 
@@ -59,8 +60,11 @@ TcpClient::TcpClient(EventLoop* loop,
     name_(nameArg),
     connectionCallback_(defaultConnectionCallback),
     messageCallback_(defaultMessageCallback),
+    handshakeTimeoutMs_(TcpConnection::kDefaultHandshakeTimeoutMs),
     retry_(false),
     connect_(true),
+    completionMode_(false),
+    edgeTriggered_(false),
     nextConnId_(1)
 {
   connector_->setNewConnectionCallback(
@@ -101,6 +105,26 @@ TcpClient::~TcpClient()
   }
 }
 
+void TcpClient::setFastOpen(bool on)
+{
+  connector_->setFastOpen(on);
+}
+
+void TcpClient::setRetryDelay(int initDelayMs, int maxDelayMs)
+{
+  connector_->setRetryDelay(initDelayMs, maxDelayMs);
+}
+
+void TcpClient::setRetryJitter(bool on)
+{
+  connector_->setRetryJitter(on);
+}
+
+void TcpClient::setReconnectBackoff(bool on)
+{
+  connector_->setReconnectBackoff(on);
+}
+
 void TcpClient::connect()
 {
   // FIXME: check state
@@ -132,13 +156,13 @@ void TcpClient::stop()
 void TcpClient::newConnection(int sockfd)
 {
   loop_->assertInLoopThread();
-  InetAddress peerAddr(sockets::getPeerAddr(sockfd));
+  InetAddress peerAddr(InetAddress::peerAddressOf(sockfd));
   char buf[32];
   snprintf(buf, sizeof buf, ":%s#%d", peerAddr.toIpPort().c_str(), nextConnId_);
   ++nextConnId_;
   string connName = name_ + buf;
 
-  InetAddress localAddr(sockets::getLocalAddr(sockfd));
+  InetAddress localAddr(InetAddress::localAddressOf(sockfd));
   // FIXME poll with zero timeout to double confirm the new connection
   // FIXME use make_shared if necessary
   TcpConnectionPtr conn(new TcpConnection(loop_,
@@ -152,6 +176,12 @@ void TcpClient::newConnection(int sockfd)
   conn->setWriteCompleteCallback(writeCompleteCallback_);
   conn->setCloseCallback(
       std::bind(&TcpClient::removeConnection, this, _1)); // FIXME: unsafe
+  if (transportFactory_)
+  {
+    conn->setTransport(transportFactory_(), handshakeTimeoutMs_);
+  }
+  conn->setCompletionMode(completionMode_);
+  conn->setEdgeTriggered(edgeTriggered_);
   {
     MutexLockGuard lock(mutex_);
     connection_ = conn;
@@ -45,6 +45,26 @@ class TcpClient : noncopyable
   EventLoop* getLoop() const { return loop_; }
   bool retry() const { return retry_; }
   void enableRetry() { retry_ = true; }
+  /// See TcpServer::setCompletionMode().
+  void setCompletionMode(bool on) { completionMode_ = on; }
+  /// See TcpServer::setEdgeTriggered().
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+  /// See TcpServer::setTransportFactory().
+  void setTransportFactory(const TransportFactory& factory)
+  { transportFactory_ = factory; }
+  /// See TcpServer::setHandshakeTimeout(). Before @c connect
+  void setHandshakeTimeout(int timeoutMs)
+  { handshakeTimeoutMs_ = timeoutMs; }
+  /// Client side TCP fast open, connecting finishes at once, the SYN
+  /// goes with the first send, so only for protocols where the client
+  /// speaks first. Must be called before @c connect
+  void setFastOpen(bool on);
+  /// Delay of reconnecting, see Connector. Before @c connect
+  void setRetryDelay(int initDelayMs, int maxDelayMs);
+  void setRetryJitter(bool on);
+  /// Reconnects after a short lived connection with the backoff of
+  /// retries, instead of at once. Needs enableRetry().
+  void setReconnectBackoff(bool on);
 
   const string& name() const
   { return name_; }
@@ -76,8 +96,12 @@ class TcpClient : noncopyable
   ConnectionCallback connectionCallback_;
   MessageCallback messageCallback_;
   WriteCompleteCallback writeCompleteCallback_;
+  TransportFactory transportFactory_;
+  int handshakeTimeoutMs_;
   bool retry_;   // atomic
   bool connect_; // atomic
+  bool completionMode_;
+  bool edgeTriggered_;
   // always in loop thread
   int nextConnId_;
   mutable MutexLock mutex_;
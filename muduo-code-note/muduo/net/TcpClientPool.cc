@@ -0,0 +1,298 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/TcpClientPool.h>
+
+#include <muduo/base/Histogram.h>
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/TcpClient.h>
+
+#include <stdio.h>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+struct TcpClientPool::Member
+{
+  Member()
+    : requestState(0),
+      connected(false),
+      failures(0),
+      requests(0),
+      failed(0),
+      evicted(0)
+  { }
+
+  std::unique_ptr<TcpClient> client;
+  // generation of the connection in the high 32 bits, leases of older
+  // ones are stale, its pending requests in the low 32 bits. One word,
+  // so a lease is counted in the generation it carries.
+  std::atomic<int64_t> requestState;
+
+  static int generationOf(int64_t state) { return static_cast<int>(state >> 32); }
+  static int pendingOf(int64_t state) { return static_cast<int>(state & 0xFFFFFFFF); }
+  std::atomic<bool> connected;
+  // written in the loop thread of the client
+  std::atomic<int> failures;  // in a row
+  std::atomic<int64_t> requests;
+  std::atomic<int64_t> failed;
+  std::atomic<int64_t> evicted;
+  Histogram latency;
+};
+
+namespace
+{
+
+void increment(std::atomic<int64_t>* counter)
+{
+  // only the loop thread of the client writes
+  counter->store(counter->load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+}
+
+}  // namespace
+
+TcpClientPool::TcpClientPool(EventLoop* loop, const string& nameArg)
+  : loop_(CHECK_NOTNULL(loop)),
+    name_(nameArg),
+    connectionsPerServer_(1),
+    initRetryDelayMs_(500),
+    maxRetryDelayMs_(30*1000),
+    maxFailures_(3),
+    connectionCallback_(defaultConnectionCallback),
+    messageCallback_(defaultMessageCallback),
+    threadPool_(new EventLoopThreadPool(loop, nameArg)),
+    next_(0),
+    unavailable_(0)
+{
+}
+
+TcpClientPool::~TcpClientPool()
+{
+  LOG_TRACE << "TcpClientPool::~TcpClientPool [" << name_ << "] destructing";
+  for (const auto& member : members_)
+  {
+    TcpConnectionPtr conn = member->client->connection();
+    if (conn)
+    {
+      // closed by ~TcpClient later, must not call back into us
+      ConnectionCallback cb = defaultConnectionCallback;
+      conn->getLoop()->runInLoop(
+          std::bind(&TcpConnection::setConnectionCallback, conn, cb));
+    }
+  }
+}
+
+void TcpClientPool::addServer(const InetAddress& serverAddr)
+{
+  assert(members_.empty());
+  serverAddrs_.push_back(serverAddr);
+}
+
+void TcpClientPool::setThreadNum(int numThreads)
+{
+  assert(0 <= numThreads);
+  threadPool_->setThreadNum(numThreads);
+}
+
+void TcpClientPool::start()
+{
+  loop_->assertInLoopThread();
+  assert(members_.empty() && !serverAddrs_.empty());
+  threadPool_->start(threadInitCallback_);
+  for (size_t i = 0; i < serverAddrs_.size(); ++i)
+  {
+    for (int j = 0; j < connectionsPerServer_; ++j)
+    {
+      char buf[32];
+      snprintf(buf, sizeof buf, "-%zd", members_.size());
+      std::unique_ptr<Member> member(new Member);
+      member->client.reset(new TcpClient(threadPool_->getNextLoop(), serverAddrs_[i], name_ + buf));
+      TcpClient* client = member->client.get();
+      client->enableRetry();
+      client->setRetryDelay(initRetryDelayMs_, maxRetryDelayMs_);
+      client->setRetryJitter(true);
+      client->setReconnectBackoff(true);
+      client->setConnectionCallback(
+          std::bind(&TcpClientPool::onConnection, this, member.get(), _1));
+      client->setMessageCallback(messageCallback_);
+      client->setWriteCompleteCallback(writeCompleteCallback_);
+      members_.push_back(std::move(member));
+    }
+  }
+  for (const auto& member : members_)
+  {
+    member->client->connect();
+  }
+}
+
+void TcpClientPool::onConnection(Member* member, const TcpConnectionPtr& conn)
+{
+  if (conn->connected())
+  {
+    // leases of the previous connection are released as stale
+    int64_t generation = Member::generationOf(member->requestState.load()) + 1;
+    member->requestState.store(generation << 32);
+    member->failures.store(0, std::memory_order_relaxed);
+    member->connected.store(true);
+  }
+  else
+  {
+    member->connected.store(false);
+  }
+  connectionCallback_(conn);
+}
+
+void TcpClientPool::stop()
+{
+  for (const auto& member : members_)
+  {
+    member->client->stop();
+    member->client->disconnect();
+  }
+}
+
+TcpClientPool::Lease TcpClientPool::acquire()
+{
+  Lease lease;
+  int n = static_cast<int>(members_.size());
+  if (n == 0)
+  {
+    unavailable_.fetch_add(1, std::memory_order_relaxed);
+    return lease;
+  }
+  int first = static_cast<int>(next_.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(n));
+  int best = -1;
+  int fewest = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    int index = (first + i) % n;
+    const Member& member = *members_[index];
+    if (member.connected.load())
+    {
+      int pending = Member::pendingOf(member.requestState.load(std::memory_order_relaxed));
+      if (best < 0 || pending < fewest)
+      {
+        best = index;
+        fewest = pending;
+      }
+    }
+  }
+  if (best >= 0)
+  {
+    Member& member = *members_[best];
+    lease.connection = member.client->connection();
+    if (lease.connection)
+    {
+      // a reconnect either wipes this count with the old generation, or comes first
+      lease.generation = Member::generationOf(member.requestState.fetch_add(1));
+      lease.index = best;
+      lease.start = MonotonicTime::now();
+      return lease;
+    }
+  }
+  unavailable_.fetch_add(1, std::memory_order_relaxed);
+  return Lease();
+}
+
+void TcpClientPool::release(const Lease& lease, bool success)
+{
+  if (lease.index < 0)
+  {
+    return;
+  }
+  assert(lease.connection);
+  lease.connection->getLoop()->assertInLoopThread();
+  Member& member = *members_[lease.index];
+  bool current = false;
+  int64_t state = member.requestState.load();
+  while (Member::generationOf(state) == lease.generation)
+  {
+    assert(Member::pendingOf(state) > 0);
+    if (member.requestState.compare_exchange_weak(state, state - 1))
+    {
+      current = true;
+      break;
+    }
+  }
+  increment(&member.requests);
+  member.latency.record(MonotonicTime::now().microSeconds() - lease.start.microSeconds());
+  if (!success)
+  {
+    increment(&member.failed);
+  }
+  if (!current)
+  {
+    // failures of a previous connection don't count against this one
+    return;
+  }
+  if (success)
+  {
+    member.failures.store(0, std::memory_order_relaxed);
+    return;
+  }
+
+  int failures = member.failures.load(std::memory_order_relaxed) + 1;
+  member.failures.store(failures, std::memory_order_relaxed);
+  if (maxFailures_ > 0 && failures >= maxFailures_ &&
+      member.connected.load())
+  {
+    LOG_WARN << "TcpClientPool [" << name_ << "] - evicting "
+             << lease.connection->name() << " after " << failures << " failures";
+    member.connected.store(false);
+    increment(&member.evicted);
+    // the client reconnects, with backoff if this keeps happening
+    lease.connection->forceClose();
+  }
+}
+
+int TcpClientPool::numConnected() const
+{
+  int connected = 0;
+  for (const auto& member : members_)
+  {
+    if (member->connected.load())
+    {
+      ++connected;
+    }
+  }
+  return connected;
+}
+
+void TcpClientPool::latency(Histogram* result) const
+{
+  for (const auto& member : members_)
+  {
+    result->merge(member->latency);
+  }
+}
+
+string TcpClientPool::stats() const
+{
+  int64_t requests = 0;
+  int64_t failed = 0;
+  int64_t evicted = 0;
+  for (const auto& member : members_)
+  {
+    requests += member->requests.load(std::memory_order_relaxed);
+    failed += member->failed.load(std::memory_order_relaxed);
+    evicted += member->evicted.load(std::memory_order_relaxed);
+  }
+  Histogram total;
+  latency(&total);
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           "connected %d/%d requests %" PRId64 " failed %" PRId64
+           " evicted %" PRId64 " unavailable %" PRId64 " latency ",
+           numConnected(), numClients(), requests, failed, evicted,
+           unavailable_.load(std::memory_order_relaxed));
+  return buf + total.toString();
+}
@@ -0,0 +1,134 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_TCPCLIENTPOOL_H
+#define MUDUO_NET_TCPCLIENTPOOL_H
+
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/net/TcpConnection.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace muduo
+{
+
+class Histogram;
+
+namespace net
+{
+
+class EventLoopThreadPool;
+
+///
+/// Warm connections to a few servers, spread over loop threads.
+///
+/// Each server gets setConnectionsPerServer() TcpClient, the pool keeps
+/// them connected, reconnecting with jittered exponential backoff.
+/// Requests are multiplexed: acquire() leases the connected client with
+/// the fewest pending requests, release() returns it when the response
+/// arrives, or the request failed. After setMaxFailures() failed requests
+/// in a row the connection is evicted, closed and connected again.
+///
+/// The pool knows nothing of the protocol, matching responses to requests
+/// is up to the message callback, which is shared by all clients.
+class TcpClientPool : noncopyable
+{
+ public:
+  typedef std::function<void(EventLoop*)> ThreadInitCallback;
+
+  /// A request in flight, copyable.
+  struct Lease
+  {
+    Lease() : index(-1), generation(0) { }
+
+    TcpConnectionPtr connection;  // NULL if no client is connected
+    int index;
+    int generation;
+    MonotonicTime start;
+  };
+
+  TcpClientPool(EventLoop* loop, const string& nameArg);
+  ~TcpClientPool();  // force out-line dtor, for std::unique_ptr members.
+
+  const string& name() const { return name_; }
+
+  /// Must be called before @c start
+  void addServer(const InetAddress& serverAddr);
+  /// 1 by default. Must be called before @c start
+  void setConnectionsPerServer(int n) { connectionsPerServer_ = n; }
+  /// Set the number of threads, clients are spread over them round-robin,
+  /// 0 means all clients in the base loop. Must be called before @c start
+  void setThreadNum(int numThreads);
+  void setThreadInitCallback(const ThreadInitCallback& cb)
+  { threadInitCallback_ = cb; }
+  /// See TcpClient::setRetryDelay(). Must be called before @c start
+  void setRetryDelay(int initDelayMs, int maxDelayMs)
+  {
+    initRetryDelayMs_ = initDelayMs;
+    maxRetryDelayMs_ = maxDelayMs;
+  }
+  /// 3 by default, 0 never evicts.
+  void setMaxFailures(int n) { maxFailures_ = n; }
+
+  /// Set callbacks of all clients, they run in the loop of each client.
+  /// Not thread safe, before @c start
+  void setConnectionCallback(ConnectionCallback cb)
+  { connectionCallback_ = std::move(cb); }
+  void setMessageCallback(MessageCallback cb)
+  { messageCallback_ = std::move(cb); }
+  void setWriteCompleteCallback(WriteCompleteCallback cb)
+  { writeCompleteCallback_ = std::move(cb); }
+
+  /// Connects all clients. Must be called in the base loop thread, once.
+  void start();
+  /// Shuts down all connections and stops reconnecting. Thread safe.
+  void stop();
+
+  /// The connected client with the fewest pending requests, ties broken
+  /// round-robin. Thread safe.
+  Lease acquire();
+  /// The response of a leased request arrived, or the request failed.
+  /// Call in the loop thread of the connection, e.g. in the message callback.
+  void release(const Lease& lease, bool success);
+
+  /// Thread safe.
+  int numConnected() const;
+  int numClients() const { return static_cast<int>(members_.size()); }
+  /// Latency of released requests in microseconds, of all clients.
+  /// Thread safe.
+  void latency(Histogram* result) const;
+  /// "connected 4/4 requests 100 failed 1 evicted 0 unavailable 0 latency count ..."
+  /// Thread safe.
+  string stats() const;
+
+ private:
+  struct Member;
+
+  void onConnection(Member* member, const TcpConnectionPtr& conn);
+
+  EventLoop* loop_;  // the base loop
+  const string name_;
+  std::vector<InetAddress> serverAddrs_;
+  int connectionsPerServer_;
+  int initRetryDelayMs_;
+  int maxRetryDelayMs_;
+  int maxFailures_;
+  ConnectionCallback connectionCallback_;
+  MessageCallback messageCallback_;
+  WriteCompleteCallback writeCompleteCallback_;
+  ThreadInitCallback threadInitCallback_;
+  // destroyed after members_, the clients need their loops
+  std::unique_ptr<EventLoopThreadPool> threadPool_;
+  std::vector<std::unique_ptr<Member>> members_;
+  std::atomic<uint32_t> next_;  // round-robin of ties
+  std::atomic<int64_t> unavailable_;  // acquire() without a connected client
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TCPCLIENTPOOL_H
@@ -10,16 +10,26 @@
 
 #include <muduo/base/Logging.h>
 #include <muduo/base/WeakCallback.h>
+#include <muduo/net/BufferPool.h>
 #include <muduo/net/Channel.h>
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/Socket.h>
 #include <muduo/net/SocketsOps.h>
+#include <muduo/net/Transport.h>
 
 #include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 using namespace muduo;
 using namespace muduo::net;
 
+namespace
+{
+const size_t kInitialReadSize = 4096;
+const size_t kMaxReadSize = 64*1024;
+}  // namespace
+
 void muduo::net::defaultConnectionCallback(const TcpConnectionPtr& conn)
 {
   LOG_TRACE << conn->localAddress().toIpPort() << " -> "
@@ -44,11 +54,24 @@ TcpConnection::TcpConnection(EventLoop* loop,
     name_(nameArg),
     state_(kConnecting),
     reading_(true),
+    completionMode_(false),
+    edgeTriggered_(false),
+    autoCork_(false),
+    corked_(false),
+    fdPassing_(false),
+    handshaking_(false),
+    readInFlight_(false),
+    writeInFlight_(false),
+    readSizeHint_(kInitialReadSize),
+    handshakeTimeoutMs_(kDefaultHandshakeTimeoutMs),
     socket_(new Socket(sockfd)),
     channel_(new Channel(loop, sockfd)),
     localAddr_(localAddr),
     peerAddr_(peerAddr),
-    highWaterMark_(64*1024*1024)
+    highWaterMark_(64*1024*1024),
+    lowWaterMark_(0),
+    inputBuffer_(0),  // storage comes from loop_->bufferPool()
+    stats_(new ConnectionStats(nameArg, peerAddr.toIpPort()))
 {
   channel_->setReadCallback(
       std::bind(&TcpConnection::handleRead, this, _1));
@@ -61,6 +84,8 @@ TcpConnection::TcpConnection(EventLoop* loop,
   LOG_DEBUG << "TcpConnection::ctor[" <<  name_ << "] at " << this
             << " fd=" << sockfd;
   socket_->setKeepAlive(true);
+  // counted from now, not connectEstablished(), for loop selectors
+  loop_->updateConnectionCount(1);
 }
 
 TcpConnection::~TcpConnection()
@@ -69,6 +94,10 @@ TcpConnection::~TcpConnection()
             << " fd=" << channel_->fd()
             << " state=" << stateToString();
   assert(state_ == kDisconnected);
+  for (int fd : receivedFds_)
+  {
+    sockets::close(fd);
+  }
 }
 
 bool TcpConnection::getTcpInfo(struct tcp_info* tcpi) const
@@ -109,24 +138,85 @@ void TcpConnection::send(const StringPiece& message)
   }
 }
 
-// FIXME efficiency!!!
 void TcpConnection::send(Buffer* buf)
 {
   if (state_ == kConnected)
   {
     if (loop_->isInLoopThread())
     {
-      sendInLoop(buf->peek(), buf->readableBytes());
-      buf->retrieveAll();
+      sendInLoop(buf);
     }
-    else
+    else if (buf->readableBytes() < ChainBuffer::kBlockSize)
     {
       void (TcpConnection::*fp)(const StringPiece& message) = &TcpConnection::sendInLoop;
       loop_->runInLoop(
           std::bind(fp,
                     this,     // FIXME
                     buf->retrieveAllAsString()));
-                    //std::forward<string>(message)));
+    }
+    else
+    {
+      // steal the storage, instead of copying to a string
+      std::shared_ptr<Buffer> message(new Buffer(0));
+      message->swap(*buf);
+      void (TcpConnection::*fp)(const void*, size_t, const std::shared_ptr<const void>&)
+          = &TcpConnection::sendInLoop;
+      loop_->runInLoop(
+          std::bind(fp,
+                    this,     // FIXME
+                    message->peek(),
+                    message->readableBytes(),
+                    message));
+    }
+  }
+}
+
+void TcpConnection::send(const std::shared_ptr<const string>& message)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendInLoop(message->data(), message->size(), message);
+    }
+    else
+    {
+      void (TcpConnection::*fp)(const void*, size_t, const std::shared_ptr<const void>&)
+          = &TcpConnection::sendInLoop;
+      loop_->runInLoop(
+          std::bind(fp,
+                    this,     // FIXME
+                    message->data(),
+                    message->size(),
+                    std::shared_ptr<const void>(message)));
+    }
+  }
+}
+
+void TcpConnection::sendFile(int fd, int64_t offset, size_t length)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendFileInLoop(fd, offset, length, false);
+    }
+    else
+    {
+      // caller may close fd before the loop runs
+      int newfd = ::dup(fd);
+      if (newfd < 0)
+      {
+        LOG_SYSERR << "TcpConnection::sendFile";
+        return;
+      }
+      loop_->runInLoop(
+          std::bind(&TcpConnection::sendFileInLoop,
+                    this,     // FIXME
+                    newfd,
+                    offset,
+                    length,
+                    true));
     }
   }
 }
@@ -137,24 +227,155 @@ void TcpConnection::sendInLoop(const StringPiece& message)
 }
 
 void TcpConnection::sendInLoop(const void* data, size_t len)
+{
+  sendInLoop(data, len, std::shared_ptr<const void>());
+}
+
+void TcpConnection::sendInLoop(const void* data, size_t len,
+                               const std::shared_ptr<const void>& owner)
 {
   loop_->assertInLoopThread();
-  ssize_t nwrote = 0;
-  size_t remaining = len;
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+    return;
+  }
   bool faultError = false;
+  ssize_t nwrote = writeDirectly(data, len, &faultError);
+  size_t remaining = len - nwrote;
+  if (!faultError && remaining > 0)
+  {
+    size_t oldLen = pendingOutputBytes();
+    StringPiece rest(static_cast<const char*>(data)+nwrote, static_cast<int>(remaining));
+    if (owner)
+    {
+      outputBuffer_.append(rest, owner);
+    }
+    else
+    {
+      outputBuffer_.append(rest);
+    }
+    startWriting(oldLen);
+  }
+}
+
+void TcpConnection::sendInLoop(Buffer* buf)
+{
+  loop_->assertInLoopThread();
   if (state_ == kDisconnected)
   {
     LOG_WARN << "disconnected, give up writing";
     return;
   }
+  bool faultError = false;
+  ssize_t nwrote = writeDirectly(buf->peek(), buf->readableBytes(), &faultError);
+  buf->retrieve(nwrote);
+  if (faultError)
+  {
+    buf->retrieveAll();
+  }
+  else if (buf->readableBytes() > 0)
+  {
+    size_t oldLen = pendingOutputBytes();
+    outputBuffer_.append(buf);
+    startWriting(oldLen);
+  }
+}
+
+void TcpConnection::sendFileInLoop(int fd, int64_t offset, size_t length, bool ownFd)
+{
+  loop_->assertInLoopThread();
+  size_t oldLen = pendingOutputBytes();
+  bool appended = false;
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+  }
+  else
+  {
+    appended = outputBuffer_.appendFile(fd, offset, length);
+  }
+  if (ownFd)
+  {
+    ::close(fd);
+  }
+  if (!appended || outputBuffer_.readableBytes() == 0)
+  {
+    return;
+  }
+  if (edgeTriggered_)
+  {
+    startWriting(oldLen);
+    // a file is written in pieces, drain it now, or no edge comes.
+    // Corked, flushCorked() does.
+    if (oldLen == 0 && !corked_)
+    {
+      handleWrite();
+    }
+    return;
+  }
+
+  int savedErrno = 0;
   // if no thing in output queue, try writing directly
-  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0)
+  if (!completionMode_ && !autoCork_ && !channel_->isWriting() && oldLen == 0)
+  {
+    ssize_t nwrote = writeOutput(&savedErrno);
+    stats_->recordWrite(nwrote);
+    if (nwrote >= 0)
+    {
+      if (outputBuffer_.readableBytes() == 0 && writeCompleteCallback_)
+      {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+      }
+      savedErrno = 0;
+    }
+    else if (savedErrno != EWOULDBLOCK)
+    {
+      errno = savedErrno;
+      LOG_SYSERR << "TcpConnection::sendFileInLoop";
+    }
+  }
+
+  if (savedErrno == EPIPE || savedErrno == ECONNRESET || savedErrno == EIO)
   {
-    nwrote = sockets::write(channel_->fd(), data, len);
+    outputBuffer_.retrieveAll();
+    if (savedErrno == EIO)
+    {
+      // peer is expecting bytes that we can't read
+      forceClose();
+    }
+  }
+  else if (outputBuffer_.readableBytes() > 0)
+  {
+    startWriting(oldLen);
+  }
+}
+
+// if no thing in output queue, try writing directly
+ssize_t TcpConnection::writeDirectly(const void* data, size_t len, bool* faultError)
+{
+  ssize_t nwrote = 0;
+  if (!completionMode_ && !autoCork_ && !handshaking_
+      && !isWritingOutput() && outputBuffer_.readableBytes() == 0)
+  {
+    if (transport_ && !transport_->kernelSend())
+    {
+      struct iovec vec;
+      vec.iov_base = const_cast<void*>(data);
+      vec.iov_len = len;
+      int savedErrno = 0;
+      nwrote = transport_->writev(channel_->fd(), &vec, 1, &savedErrno);
+      errno = savedErrno;
+    }
+    else
+    {
+      // a short write fills the socket, edge triggered waits for it to drain
+      nwrote = sockets::write(channel_->fd(), data, len);
+    }
+    stats_->recordWrite(nwrote);
     if (nwrote >= 0)
     {
-      remaining = len - nwrote;
-      if (remaining == 0 && writeCompleteCallback_)
+      if (implicit_cast<size_t>(nwrote) == len && writeCompleteCallback_)
       {
         loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
       }
@@ -167,26 +388,152 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
         LOG_SYSERR << "TcpConnection::sendInLoop";
         if (errno == EPIPE || errno == ECONNRESET) // FIXME: any others?
         {
-          faultError = true;
+          *faultError = true;
         }
       }
     }
   }
+  return nwrote;
+}
 
-  assert(remaining <= len);
-  if (!faultError && remaining > 0)
+ssize_t TcpConnection::writeOutput(int* savedErrno)
+{
+  if (handshaking_)
   {
-    size_t oldLen = outputBuffer_.readableBytes();
-    if (oldLen + remaining >= highWaterMark_
-        && oldLen < highWaterMark_
-        && highWaterMarkCallback_)
+    // output waits for the handshake, see continueHandshake()
+    *savedErrno = EWOULDBLOCK;
+    return -1;
+  }
+  if (!transport_ || transport_->kernelSend())
+  {
+    return outputBuffer_.writeFd(channel_->fd(), savedErrno);
+  }
+  // encrypted in user space, files are read chunk by chunk
+  ssize_t total = 0;
+  while (outputBuffer_.readableBytes() > 0)
+  {
+    struct iovec vec[ChainBuffer::kMaxIovecs];
+    int iovcnt = outputBuffer_.fillIovec(vec, ChainBuffer::kMaxIovecs);
+    if (iovcnt == 0)
     {
-      loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
+      if (!outputBuffer_.readFileFront(kMaxReadSize))
+      {
+        *savedErrno = EIO;
+        return -1;
+      }
+      iovcnt = outputBuffer_.fillIovec(vec, ChainBuffer::kMaxIovecs);
     }
-    outputBuffer_.append(static_cast<const char*>(data)+nwrote, remaining);
-    if (!channel_->isWriting())
+    ssize_t n = transport_->writev(channel_->fd(), vec, iovcnt, savedErrno);
+    if (n < 0)
     {
-      channel_->enableWriting();
+      return total > 0 ? total : n;
+    }
+    outputBuffer_.retrieve(n);
+    total += n;
+  }
+  return total;
+}
+
+size_t TcpConnection::pendingOutputBytes() const
+{
+  return outputBuffer_.readableBytes() + writingBuffer_.readableBytes();
+}
+
+void TcpConnection::checkLowWaterMark(size_t oldLen)
+{
+  size_t newLen = pendingOutputBytes();
+  stats_->updateBacklog(static_cast<int64_t>(newLen), newLen >= highWaterMark_, loop_->now());
+  if (newLen <= lowWaterMark_
+      && oldLen > lowWaterMark_
+      && lowWaterMarkCallback_)
+  {
+    loop_->queueInLoop(std::bind(lowWaterMarkCallback_, shared_from_this(), newLen));
+  }
+}
+
+void TcpConnection::startWriting(size_t oldLen)
+{
+  size_t newLen = pendingOutputBytes();
+  stats_->updateBacklog(static_cast<int64_t>(newLen), newLen >= highWaterMark_, loop_->now());
+  if (newLen >= highWaterMark_
+      && oldLen < highWaterMark_
+      && highWaterMarkCallback_)
+  {
+    loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), newLen));
+  }
+  if (completionMode_)
+  {
+    if (!writeInFlight_)
+    {
+      submitWrite();
+    }
+  }
+  else if (autoCork_ && (oldLen == 0 || corked_))
+  {
+    if (!corked_)
+    {
+      // runs after the events of this round, see EventLoop::queueInLoop()
+      corked_ = true;
+      loop_->queueInLoop(std::bind(&TcpConnection::flushCorked, shared_from_this()));
+    }
+  }
+  else if (!edgeTriggered_ && !channel_->isWriting())
+  {
+    channel_->enableWriting();
+  }
+}
+
+void TcpConnection::flushCorked()
+{
+  loop_->assertInLoopThread();
+  corked_ = false;
+  if (state_ == kDisconnected || outputBuffer_.readableBytes() == 0)
+  {
+    return;
+  }
+  if (edgeTriggered_)
+  {
+    handleWrite();
+    return;
+  }
+  if (channel_->isWriting())
+  {
+    // cork turned off meanwhile, handleWrite() takes it
+    return;
+  }
+
+  int savedErrno = 0;
+  size_t oldLen = pendingOutputBytes();
+  ssize_t n = writeOutput(&savedErrno);
+  stats_->recordWrite(n);
+  checkLowWaterMark(oldLen);
+  if (n >= 0 && outputBuffer_.readableBytes() == 0)
+  {
+    if (writeCompleteCallback_)
+    {
+      loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+    }
+    if (state_ == kDisconnecting)
+    {
+      shutdownInLoop();
+    }
+  }
+  else if (n >= 0 || savedErrno == EWOULDBLOCK)
+  {
+    channel_->enableWriting();
+  }
+  else
+  {
+    errno = savedErrno;
+    LOG_SYSERR << "TcpConnection::flushCorked";
+    if (savedErrno == EPIPE || savedErrno == ECONNRESET || savedErrno == EIO)
+    {
+      outputBuffer_.retrieveAll();
+      if (savedErrno == EIO)
+      {
+        // peer is expecting bytes that we can't read
+        forceClose();
+      }
     }
   }
 }
@@ -205,9 +552,13 @@ void TcpConnection::shutdown()
 void TcpConnection::shutdownInLoop()
 {
   loop_->assertInLoopThread();
-  if (!channel_->isWriting())
+  if (!isWritingOutput())
   {
     // we are not writing
+    if (transport_ && !handshaking_)
+    {
+      transport_->shutdown(channel_->fd());
+    }
     socket_->shutdownWrite();
   }
 }
@@ -290,6 +641,11 @@ void TcpConnection::setTcpNoDelay(bool on)
   socket_->setTcpNoDelay(on);
 }
 
+void TcpConnection::setBusyPoll(int microSeconds)
+{
+  socket_->setBusyPoll(microSeconds);
+}
+
 void TcpConnection::startRead()
 {
   loop_->runInLoop(std::bind(&TcpConnection::startReadInLoop, this));
@@ -298,7 +654,20 @@ void TcpConnection::startRead()
 void TcpConnection::startReadInLoop()
 {
   loop_->assertInLoopThread();
-  if (!reading_ || !channel_->isReading())
+  if (completionMode_)
+  {
+    reading_ = true;
+    if (!readInFlight_ && state_ != kDisconnected)
+    {
+      submitRead();
+    }
+  }
+  else if (state_ == kDisconnected)
+  {
+    // channel is out of the poller, a late startRead() must not add it back
+    reading_ = true;
+  }
+  else if (!reading_ || !channel_->isReading())
   {
     channel_->enableReading();
     reading_ = true;
@@ -313,7 +682,17 @@ void TcpConnection::stopRead()
 void TcpConnection::stopReadInLoop()
 {
   loop_->assertInLoopThread();
-  if (reading_ || channel_->isReading())
+  if (completionMode_)
+  {
+    // can't take back a submitted read, its data is delivered,
+    // but no more reads are submitted.
+    reading_ = false;
+  }
+  else if (state_ == kDisconnected)
+  {
+    reading_ = false;
+  }
+  else if (reading_ || channel_->isReading())
   {
     channel_->disableReading();
     reading_ = false;
@@ -326,11 +705,102 @@ void TcpConnection::connectEstablished()
   assert(state_ == kConnecting);
   setState(kConnected);
   channel_->tie(shared_from_this());
-  channel_->enableReading();
+  loop_->connectionStats().add(stats_);
+  if (completionMode_)
+  {
+    submitRead();
+  }
+  else
+  {
+    if (edgeTriggered_)
+    {
+      channel_->setEdgeTriggered(true);
+      channel_->enableAll();
+    }
+    else
+    {
+      channel_->enableReading();
+    }
+  }
 
+  if (transport_)
+  {
+    // connected is called back after the handshake
+    handshaking_ = true;
+    loop_->runAfter(handshakeTimeoutMs_ / 1000.0,
+                    makeWeakCallback(shared_from_this(),
+                                     &TcpConnection::handshakeTimeout));
+    continueHandshake();
+    return;
+  }
   connectionCallback_(shared_from_this());
 }
 
+void TcpConnection::setTransport(std::unique_ptr<Transport> transport, int timeoutMs)
+{
+  assert(state_ == kConnecting);
+  transport_ = std::move(transport);
+  handshakeTimeoutMs_ = timeoutMs;
+  completionMode_ = false;
+}
+
+void TcpConnection::continueHandshake()
+{
+  loop_->assertInLoopThread();
+  assert(handshaking_);
+  Transport::HandshakeResult result = transport_->handshake(channel_->fd());
+  if (!edgeTriggered_)
+  {
+    if (result == Transport::kWantWrite && !channel_->isWriting())
+    {
+      channel_->enableWriting();
+    }
+    else if (result != Transport::kWantWrite && channel_->isWriting())
+    {
+      channel_->disableWriting();
+    }
+  }
+  if (result == Transport::kHandshakeDone)
+  {
+    handshaking_ = false;
+    LOG_TRACE << "TcpConnection::continueHandshake [" << name_ << "] done, kernel send "
+              << transport_->kernelSend();
+    size_t pending = outputBuffer_.readableBytes();
+    connectionCallback_(shared_from_this());
+    if (edgeTriggered_ && reading_ && state_ != kDisconnected)
+    {
+      // data behind the last handshake message came with the same edge
+      handleRead(loop_->pollReturnTime());
+    }
+    if (pending > 0 && state_ != kDisconnected)
+    {
+      // sent while handshaking
+      if (edgeTriggered_)
+      {
+        handleWrite();
+      }
+      else if (!channel_->isWriting())
+      {
+        channel_->enableWriting();
+      }
+    }
+  }
+  else if (result == Transport::kHandshakeFailed)
+  {
+    LOG_ERROR << "TcpConnection::continueHandshake [" << name_ << "] failed";
+    handleClose();
+  }
+}
+
+void TcpConnection::handshakeTimeout()
+{
+  if (handshaking_ && state_ != kDisconnected)
+  {
+    LOG_WARN << "TcpConnection::handshakeTimeout [" << name_ << "]";
+    handleClose();
+  }
+}
+
 void TcpConnection::connectDestroyed()
 {
   loop_->assertInLoopThread();
@@ -339,46 +809,98 @@ void TcpConnection::connectDestroyed()
     setState(kDisconnected);
     channel_->disableAll();
 
-    connectionCallback_(shared_from_this());
+    if (!handshaking_)
+    {
+      connectionCallback_(shared_from_this());
+    }
   }
   channel_->remove();
+  if (!readInFlight_)
+  {
+    // unread input is gone with us, otherwise handleReadCompletion() ends the lend
+    inputBuffer_.retrieveAll();
+    loop_->bufferPool()->release(&inputBuffer_);
+  }
+  loop_->connectionStats().remove(stats_);
+  loop_->updateConnectionCount(-1);
 }
 
 void TcpConnection::handleRead(Timestamp receiveTime)
 {
   loop_->assertInLoopThread();
-  int savedErrno = 0;
-  ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
-  if (n > 0)
+  if (handshaking_)
   {
-    messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+    continueHandshake();
+    return;
   }
-  else if (n == 0)
+  int savedErrno = 0;
+  loop_->bufferPool()->acquire(&inputBuffer_);
+  ssize_t n = 0;
+  do
   {
-    handleClose();
-  }
-  else
+    if (transport_)
+    {
+      n = transport_->read(channel_->fd(), &inputBuffer_, &savedErrno);
+    }
+    else
+    {
+      n = fdPassing_ ? inputBuffer_.readFd(channel_->fd(), &receivedFds_, &savedErrno)
+                     : inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    }
+    stats_->recordRead(n);
+    if (n > 0)
+    {
+      messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+    }
+    else if (n == 0)
+    {
+      handleClose();
+    }
+    else if ((!edgeTriggered_ && !transport_) || savedErrno != EWOULDBLOCK)
+    {
+      // a transport waits for the rest of a record
+      errno = savedErrno;
+      LOG_SYSERR << "TcpConnection::handleRead";
+      handleError();
+    }
+    // edge triggered: until EAGAIN, or the user stops reading
+  } while (edgeTriggered_ && n > 0 && reading_ && state_ != kDisconnected);
+  if (inputBuffer_.readableBytes() == 0)
   {
-    errno = savedErrno;
-    LOG_SYSERR << "TcpConnection::handleRead";
-    handleError();
+    // idle connections hold no input storage
+    loop_->bufferPool()->release(&inputBuffer_);
   }
 }
 
 void TcpConnection::handleWrite()
 {
   loop_->assertInLoopThread();
-  if (channel_->isWriting())
+  if (handshaking_)
+  {
+    continueHandshake();
+    return;
+  }
+  if (isWritingOutput())
   {
-    ssize_t n = sockets::write(channel_->fd(),
-                               outputBuffer_.peek(),
-                               outputBuffer_.readableBytes());
+    int savedErrno = 0;
+    size_t oldLen = pendingOutputBytes();
+    ssize_t n = writeOutput(&savedErrno);
+    stats_->recordWrite(n);
+    // edge triggered: until EAGAIN, write interest stays registered
+    while (edgeTriggered_ && n > 0 && outputBuffer_.readableBytes() > 0)
+    {
+      n = writeOutput(&savedErrno);
+      stats_->recordWrite(n);
+    }
+    checkLowWaterMark(oldLen);
     if (n > 0)
     {
-      outputBuffer_.retrieve(n);
       if (outputBuffer_.readableBytes() == 0)
       {
-        channel_->disableWriting();
+        if (!edgeTriggered_)
+        {
+          channel_->disableWriting();
+        }
         if (writeCompleteCallback_)
         {
           loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
@@ -389,16 +911,31 @@ void TcpConnection::handleWrite()
         }
       }
     }
+    else if (edgeTriggered_ && savedErrno == EWOULDBLOCK)
+    {
+      // socket is full, wait for the next edge
+    }
     else
     {
+      errno = savedErrno;
       LOG_SYSERR << "TcpConnection::handleWrite";
+      if (savedErrno == EIO)
+      {
+        // a file in output is unreadable, peer is expecting bytes that we can't send
+        outputBuffer_.retrieveAll();
+        if (!edgeTriggered_)
+        {
+          channel_->disableWriting();
+        }
+        forceClose();
+      }
       // if (state_ == kDisconnecting)
       // {
       //   shutdownInLoop();
       // }
     }
   }
-  else
+  else if (!edgeTriggered_)
   {
     LOG_TRACE << "Connection fd = " << channel_->fd()
               << " is down, no more writing";
@@ -413,9 +950,22 @@ void TcpConnection::handleClose()
   // we don't close fd, leave it to dtor, so we can find leaks easily.
   setState(kDisconnected);
   channel_->disableAll();
+  if (readInFlight_ || writeInFlight_)
+  {
+    // completes the pending operations, they hold a reference to us.
+    sockets::shutdownReadWrite(channel_->fd());
+  }
+  if (!readInFlight_ && inputBuffer_.readableBytes() == 0)
+  {
+    loop_->bufferPool()->release(&inputBuffer_);
+  }
 
   TcpConnectionPtr guardThis(shared_from_this());
-  connectionCallback_(guardThis);
+  if (!handshaking_)
+  {
+    // never called back connected otherwise
+    connectionCallback_(guardThis);
+  }
   // must be the last line
   closeCallback_(guardThis);
 }
@@ -427,3 +977,216 @@ void TcpConnection::handleError()
             << "] - SO_ERROR = " << err << " " << strerror_tl(err);
 }
 
+
+void TcpConnection::setCompletionMode(bool on)
+{
+  assert(state_ == kConnecting);
+  completionMode_ = on && !transport_ && loop_->supportsCompletion();
+}
+
+void TcpConnection::setEdgeTriggered(bool on)
+{
+  assert(state_ == kConnecting);
+  edgeTriggered_ = on && loop_->supportsEdgeTriggered();
+}
+
+void TcpConnection::setAutoCork(bool on)
+{
+  loop_->assertInLoopThread();
+  autoCork_ = on;
+}
+
+void TcpConnection::setFdPassing(bool on)
+{
+  loop_->assertInLoopThread();
+  assert(localAddr_.isUnixDomain());
+  fdPassing_ = on && !completionMode_;
+}
+
+std::vector<int> TcpConnection::takeReceivedFds()
+{
+  loop_->assertInLoopThread();
+  std::vector<int> fds;
+  fds.swap(receivedFds_);
+  return fds;
+}
+
+bool TcpConnection::sendFd(int fd, const StringPiece& message)
+{
+  loop_->assertInLoopThread();
+  assert(localAddr_.isUnixDomain() && !transport_);
+  assert(message.size() > 0);
+  if (state_ != kConnected || isWritingOutput() || pendingOutputBytes() > 0)
+  {
+    return false;
+  }
+  ssize_t n = sockets::writeWithFd(channel_->fd(), message.data(),
+                                   static_cast<size_t>(message.size()), fd);
+  stats_->recordWrite(n);
+  if (n < 0)
+  {
+    if (errno != EWOULDBLOCK)
+    {
+      LOG_SYSERR << "TcpConnection::sendFd";
+    }
+    return false;
+  }
+  // fd went with the first byte, the rest is ordinary output
+  size_t remaining = static_cast<size_t>(message.size()) - static_cast<size_t>(n);
+  if (remaining > 0)
+  {
+    sendInLoop(message.data() + n, remaining);
+  }
+  else if (writeCompleteCallback_)
+  {
+    loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+  }
+  return true;
+}
+
+bool TcpConnection::isWritingOutput() const
+{
+  if (completionMode_)
+  {
+    return writeInFlight_;
+  }
+  if (corked_)
+  {
+    return true;
+  }
+  return edgeTriggered_ ? outputBuffer_.readableBytes() > 0 : channel_->isWriting();
+}
+
+void TcpConnection::submitRead()
+{
+  assert(completionMode_ && !readInFlight_);
+  loop_->bufferPool()->acquire(&inputBuffer_);
+  inputBuffer_.ensureWritableBytes(readSizeHint_);
+  readInFlight_ = true;
+  loop_->submitRead(channel_->fd(),
+                    inputBuffer_.beginWrite(),
+                    inputBuffer_.writableBytes(),
+                    std::bind(&TcpConnection::handleReadCompletion, shared_from_this(), _1));
+}
+
+void TcpConnection::handleReadCompletion(ssize_t n)
+{
+  loop_->assertInLoopThread();
+  readInFlight_ = false;
+  if (state_ == kDisconnected)
+  {
+    inputBuffer_.retrieveAll();
+    loop_->bufferPool()->release(&inputBuffer_);
+    return;
+  }
+  stats_->recordRead(n);
+  if (n > 0)
+  {
+    if (static_cast<size_t>(n) == inputBuffer_.writableBytes())
+    {
+      readSizeHint_ = std::min(readSizeHint_ * 2, kMaxReadSize);
+    }
+    inputBuffer_.hasWritten(n);
+    messageCallback_(shared_from_this(), &inputBuffer_, loop_->pollReturnTime());
+    if (reading_ && !readInFlight_ && state_ != kDisconnected)
+    {
+      submitRead();
+    }
+  }
+  else if (n == 0)
+  {
+    handleClose();
+  }
+  else
+  {
+    errno = static_cast<int>(-n);
+    LOG_SYSERR << "TcpConnection::handleReadCompletion";
+    handleError();
+    handleClose();
+  }
+}
+
+void TcpConnection::submitWrite()
+{
+  assert(completionMode_ && !writeInFlight_);
+  if (writingBuffer_.readableBytes() == 0)
+  {
+    writingBuffer_.swap(outputBuffer_);
+  }
+  struct iovec vec[ChainBuffer::kMaxIovecs];
+  int iovcnt = writingBuffer_.fillIovec(vec, ChainBuffer::kMaxIovecs);
+  if (iovcnt == 0 && writingBuffer_.readableBytes() > 0)
+  {
+    // writev takes memory only, read the leading file chunk by chunk.
+    if (!writingBuffer_.readFileFront(kMaxReadSize))
+    {
+      writingBuffer_.retrieveAll();
+      outputBuffer_.retrieveAll();
+      forceClose();
+      return;
+    }
+    iovcnt = writingBuffer_.fillIovec(vec, ChainBuffer::kMaxIovecs);
+  }
+  writeInFlight_ = true;
+  loop_->submitWritev(channel_->fd(), vec, iovcnt,
+                      std::bind(&TcpConnection::handleWriteCompletion, shared_from_this(), _1));
+}
+
+void TcpConnection::handleWriteCompletion(ssize_t n)
+{
+  loop_->assertInLoopThread();
+  writeInFlight_ = false;
+  if (state_ == kDisconnected)
+  {
+    LOG_TRACE << "Connection fd = " << channel_->fd()
+              << " is down, no more writing";
+    return;
+  }
+  stats_->recordWrite(n);
+  if (n >= 0)
+  {
+    size_t oldLen = pendingOutputBytes();
+    writingBuffer_.retrieve(n);
+    checkLowWaterMark(oldLen);
+    if (writingBuffer_.readableBytes() > 0 || outputBuffer_.readableBytes() > 0)
+    {
+      submitWrite();
+    }
+    else
+    {
+      if (writeCompleteCallback_)
+      {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+      }
+      if (state_ == kDisconnecting)
+      {
+        shutdownInLoop();
+      }
+    }
+  }
+  else
+  {
+    int savedErrno = static_cast<int>(-n);
+    if (savedErrno == EAGAIN || savedErrno == EINTR)
+    {
+      submitWrite();
+      return;
+    }
+    errno = savedErrno;
+    LOG_SYSERR << "TcpConnection::handleWriteCompletion";
+    // no readiness event comes to retry, the output can't be sent
+    size_t oldLen = pendingOutputBytes();
+    writingBuffer_.retrieveAll();
+    outputBuffer_.retrieveAll();
+    checkLowWaterMark(oldLen);
+    if (savedErrno == EIO)
+    {
+      // peer is expecting bytes that we can't send
+      forceClose();
+    }
+    else if (state_ == kDisconnecting)
+    {
+      shutdownInLoop();
+    }
+  }
+}
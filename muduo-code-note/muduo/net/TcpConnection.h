@@ -16,9 +16,12 @@
 #include <muduo/base/Types.h>
 #include <muduo/net/Callbacks.h>
 #include <muduo/net/Buffer.h>
+#include <muduo/net/ChainBuffer.h>
+#include <muduo/net/ConnectionStats.h>
 #include <muduo/net/InetAddress.h>
 
 #include <memory>
+#include <vector>
 
 #include <boost/any.hpp>
 
@@ -33,6 +36,7 @@ namespace net
 class Channel;
 class EventLoop;
 class Socket;
+class Transport;
 
 ///
 /// TCP connection, for both client and server usage.
@@ -42,6 +46,9 @@ class TcpConnection : noncopyable,
                       public std::enable_shared_from_this<TcpConnection>
 {
  public:
+  /// Of connections with a Transport, see setTransport().
+  static const int kDefaultHandshakeTimeoutMs = 10000;
+
   /// Constructs a TcpConnection with a connected sockfd
   ///
   /// User should not create this object.
@@ -58,6 +65,8 @@ class TcpConnection : noncopyable,
   const InetAddress& peerAddress() const { return peerAddr_; }
   bool connected() const { return state_ == kConnected; }
   bool disconnected() const { return state_ == kDisconnected; }
+  // traffic counters, readable from any thread, see ConnectionStats
+  const ConnectionStatsPtr& stats() const { return stats_; }
   // return true if success.
   bool getTcpInfo(struct tcp_info*) const;
   string getTcpInfoString() const;
@@ -67,11 +76,17 @@ class TcpConnection : noncopyable,
   void send(const StringPiece& message);
   // void send(Buffer&& message); // C++11
   void send(Buffer* message);  // this one will swap data
+  void send(const std::shared_ptr<const string>& message);  // zero copy, message is shared
+  // sends length bytes of fd from offset with sendfile(2), in order with send().
+  // fd is dup-ed, caller may close it after this returns.
+  void sendFile(int fd, int64_t offset, size_t length);
   void shutdown(); // NOT thread safe, no simultaneous calling
   // void shutdownAndForceCloseAfter(double seconds); // NOT thread safe, no simultaneous calling
   void forceClose();
   void forceCloseWithDelay(double seconds);
   void setTcpNoDelay(bool on);
+  // SO_BUSY_POLL, see Socket::setBusyPoll()
+  void setBusyPoll(int microSeconds);
   // reading or not
   void startRead();
   void stopRead();
@@ -98,17 +113,58 @@ class TcpConnection : noncopyable,
   void setHighWaterMarkCallback(const HighWaterMarkCallback& cb, size_t highWaterMark)
   { highWaterMarkCallback_ = cb; highWaterMark_ = highWaterMark; }
 
+  /// called when pending output drains from above lowWaterMark to it or below
+  void setLowWaterMarkCallback(const LowWaterMarkCallback& cb, size_t lowWaterMark)
+  { lowWaterMarkCallback_ = cb; lowWaterMark_ = lowWaterMark; }
+
   /// Advanced interface
   Buffer* inputBuffer()
   { return &inputBuffer_; }
 
-  Buffer* outputBuffer()
+  ChainBuffer* outputBuffer()
   { return &outputBuffer_; }
 
   /// Internal use only.
   void setCloseCallback(const CloseCallback& cb)
   { closeCallback_ = cb; }
 
+  // called before connectEstablished(). The connection handshakes first,
+  // and calls back connected when it's done, see Transport. It's closed
+  // if the handshake takes longer than timeoutMs.
+  // Turns off completion mode, sendFd() isn't supported.
+  void setTransport(std::unique_ptr<Transport> transport,
+                    int timeoutMs = kDefaultHandshakeTimeoutMs);
+  bool hasTransport() const { return transport_ != NULL; }
+  // called before connectEstablished(), no-op if the loop's poller
+  // doesn't support completion based I/O.
+  void setCompletionMode(bool on);
+  bool completionMode() const { return completionMode_; }
+  // called before connectEstablished(), no-op if the loop's poller
+  // doesn't support edge triggered readiness, see Channel::setEdgeTriggered().
+  // Reads and writes go on until EAGAIN, write interest stays registered,
+  // instead of an epoll_ctl each time output starts and finishes queueing.
+  void setEdgeTriggered(bool on);
+  bool edgeTriggered() const { return edgeTriggered_; }
+  // in loop thread, no-op in completion mode. Sends only append to output
+  // until the loop has handled this round of events, then all of them go
+  // in one writev(2), for callbacks that send many small replies.
+  void setAutoCork(bool on);
+  bool autoCork() const { return autoCork_; }
+  // Unix domain only, in loop thread, no-op in completion mode.
+  // Reads with recvmsg(2) and keeps descriptors passed with SCM_RIGHTS,
+  // see takeReceivedFds(), e.g. accepted sockets handed over by the
+  // old process during a restart.
+  void setFdPassing(bool on);
+  bool fdPassing() const { return fdPassing_; }
+  // in loop thread, the descriptors arrived so far, in order, the caller
+  // owns them. Those never taken are closed with the connection.
+  std::vector<int> takeReceivedFds();
+  // in loop thread, Unix domain only. Passes a duplicate of fd along with
+  // message, which must not be empty, the caller keeps its own fd.
+  // Returns false, sending nothing, if output is pending or the socket
+  // buffer is full, try again from the write complete callback.
+  bool sendFd(int fd, const StringPiece& message);
+
   // called when TcpServer accepts a new connection
   void connectEstablished();   // should be called only once
   // called when TcpServer has removed me from its map
@@ -123,6 +179,19 @@ class TcpConnection : noncopyable,
   // void sendInLoop(string&& message);
   void sendInLoop(const StringPiece& message);
   void sendInLoop(const void* message, size_t len);
+  // owner keeps message alive if it's queued.
+  void sendInLoop(const void* message, size_t len, const std::shared_ptr<const void>& owner);
+  void sendInLoop(Buffer* message);
+  void sendFileInLoop(int fd, int64_t offset, size_t length, bool ownFd);
+  ssize_t writeDirectly(const void* message, size_t len, bool* faultError);
+  // outputBuffer_.writeFd(), or through transport_
+  ssize_t writeOutput(int* savedErrno);
+  void continueHandshake();
+  void handshakeTimeout();
+  void startWriting(size_t oldLen);
+  void flushCorked();
+  size_t pendingOutputBytes() const;
+  void checkLowWaterMark(size_t oldLen);
   void shutdownInLoop();
   // void shutdownAndForceCloseInLoop(double seconds);
   void forceCloseInLoop();
@@ -130,27 +199,47 @@ class TcpConnection : noncopyable,
   const char* stateToString() const;
   void startReadInLoop();
   void stopReadInLoop();
+  // completion based I/O
+  void submitRead();
+  void submitWrite();
+  void handleReadCompletion(ssize_t n);
+  void handleWriteCompletion(ssize_t n);
+  bool isWritingOutput() const;
 
   EventLoop* loop_;
   const string name_;
   StateE state_;  // FIXME: use atomic variable
   bool reading_;
+  bool completionMode_;
+  bool edgeTriggered_;
+  bool autoCork_;
+  bool corked_;  // output waits for flushCorked()
+  bool fdPassing_;
+  bool handshaking_;
+  bool readInFlight_;
+  bool writeInFlight_;
+  size_t readSizeHint_;
+  int handshakeTimeoutMs_;
   // we don't expose those classes to client.
   std::unique_ptr<Socket> socket_;
   std::unique_ptr<Channel> channel_;
+  std::unique_ptr<Transport> transport_;
   const InetAddress localAddr_;
   const InetAddress peerAddr_;
   ConnectionCallback connectionCallback_;
   MessageCallback messageCallback_;
   WriteCompleteCallback writeCompleteCallback_;
   HighWaterMarkCallback highWaterMarkCallback_;
+  LowWaterMarkCallback lowWaterMarkCallback_;
   CloseCallback closeCallback_;
   size_t highWaterMark_;
+  size_t lowWaterMark_;
   Buffer inputBuffer_;
-  Buffer outputBuffer_; // FIXME: use list<Buffer> as output buffer.
+  ChainBuffer outputBuffer_;
+  ChainBuffer writingBuffer_;  // owned by the kernel while writeInFlight_
+  std::vector<int> receivedFds_;  // with fdPassing_, not yet taken
   boost::any context_;
-  // FIXME: creationTime_, lastReceiveTime_
-  //        bytesReceived_, bytesSent_
+  const ConnectionStatsPtr stats_;
 };
 
 typedef std::shared_ptr<TcpConnection> TcpConnectionPtr;
@@ -0,0 +1,170 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/TcpRelay.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t TcpRelay::kDefaultHighWaterMark;
+const size_t TcpRelay::kDefaultLowWaterMark;
+
+TcpRelay::TcpRelay(const TcpConnectionPtr& first, const TcpConnectionPtr& second)
+  : loop_(first->getLoop()),
+    first_(first),
+    second_(second),
+    highWaterMark_(kDefaultHighWaterMark),
+    lowWaterMark_(kDefaultLowWaterMark),
+    started_(false),
+    bytesToSecond_(0),
+    bytesToFirst_(0),
+    numPauses_(0)
+{
+  assert(first_ != second_);
+  // handing over buffers and pausing reads happen in one thread
+  assert(second_->getLoop() == loop_);
+}
+
+void TcpRelay::setWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+{
+  assert(!started_);
+  assert(lowWaterMark < highWaterMark);
+  highWaterMark_ = highWaterMark;
+  lowWaterMark_ = lowWaterMark;
+}
+
+void TcpRelay::start()
+{
+  loop_->assertInLoopThread();
+  assert(!started_);
+  started_ = true;
+  // connections keep callbacks, which must not keep us
+  std::weak_ptr<TcpRelay> weakSelf(shared_from_this());
+  for (const TcpConnectionPtr& conn : { first_, second_ })
+  {
+    conn->setMessageCallback([weakSelf](const TcpConnectionPtr& c, Buffer* buf, Timestamp) {
+      TcpRelayPtr self(weakSelf.lock());
+      if (self)
+      {
+        self->onMessage(c, buf);
+      }
+      else
+      {
+        buf->retrieveAll();
+      }
+    });
+    conn->setHighWaterMarkCallback([weakSelf](const TcpConnectionPtr& c, size_t) {
+      TcpRelayPtr self(weakSelf.lock());
+      if (self)
+      {
+        self->onHighWaterMark(c);
+      }
+    }, highWaterMark_);
+    conn->setLowWaterMarkCallback([weakSelf](const TcpConnectionPtr& c, size_t) {
+      TcpRelayPtr self(weakSelf.lock());
+      if (self)
+      {
+        self->onLowWaterMark(c);
+      }
+    }, lowWaterMark_);
+  }
+  LOG_DEBUG << "TcpRelay " << first_->name() << " <-> " << second_->name();
+
+  for (const TcpConnectionPtr& conn : { first_, second_ })
+  {
+    if (conn->connected())
+    {
+      conn->startRead();
+    }
+    if (conn->inputBuffer()->readableBytes() > 0)
+    {
+      onMessage(conn, conn->inputBuffer());
+    }
+  }
+}
+
+void TcpRelay::stop()
+{
+  loop_->assertInLoopThread();
+  if (!started_)
+  {
+    return;
+  }
+  started_ = false;
+  for (const TcpConnectionPtr& conn : { first_, second_ })
+  {
+    conn->setMessageCallback(defaultMessageCallback);
+    conn->setHighWaterMarkCallback(HighWaterMarkCallback(), 0);
+    conn->setLowWaterMarkCallback(LowWaterMarkCallback(), 0);
+    if (conn->connected())
+    {
+      // reads the close of a paused side
+      conn->startRead();
+      conn->shutdown();
+    }
+  }
+  // their sockets are closed when the last owner lets go
+  first_.reset();
+  second_.reset();
+}
+
+const TcpConnectionPtr& TcpRelay::peerOf(const TcpConnectionPtr& conn) const
+{
+  assert(conn == first_ || conn == second_);
+  return conn == first_ ? second_ : first_;
+}
+
+void TcpRelay::onMessage(const TcpConnectionPtr& conn, Buffer* buf)
+{
+  if (!started_ || !peerOf(conn)->connected())
+  {
+    buf->retrieveAll();
+    return;
+  }
+  const TcpConnectionPtr& peer = peerOf(conn);
+  int64_t n = static_cast<int64_t>(buf->readableBytes());
+  if (conn == first_)
+  {
+    bytesToSecond_ += n;
+  }
+  else
+  {
+    bytesToFirst_ += n;
+  }
+  peer->send(buf);
+}
+
+void TcpRelay::onHighWaterMark(const TcpConnectionPtr& conn)
+{
+  // queued, may come after stop()
+  if (!started_)
+  {
+    return;
+  }
+  const TcpConnectionPtr& source = peerOf(conn);
+  if (source->isReading())
+  {
+    LOG_DEBUG << conn->name() << " output passed " << highWaterMark_
+              << ", pausing " << source->name();
+    ++numPauses_;
+    source->stopRead();
+  }
+}
+
+void TcpRelay::onLowWaterMark(const TcpConnectionPtr& conn)
+{
+  if (!started_)
+  {
+    return;
+  }
+  const TcpConnectionPtr& source = peerOf(conn);
+  if (!source->isReading())
+  {
+    LOG_DEBUG << conn->name() << " output drained to " << lowWaterMark_
+              << ", resuming " << source->name();
+    source->startRead();
+  }
+}
@@ -0,0 +1,84 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_TCPRELAY_H
+#define MUDUO_NET_TCPRELAY_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/TcpConnection.h>
+
+#include <memory>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Relays bytes between two connections of one loop, both ways,
+/// with flow control.
+///
+/// Input of one side is handed to the output of the other, big buffers
+/// by swapping, not copying. When a side's pending output passes the high
+/// water mark, reading from the other side stops, and resumes when the
+/// output has drained to the low water mark, so a slow consumer holds
+/// at most about highWaterMark plus one read of memory per direction.
+///
+/// start() takes over message and water mark callbacks of both
+/// connections. The owner keeps the relay, and calls stop() from the
+/// connection callback when either side goes down, and before
+/// dropping it if both are still up.
+class TcpRelay : noncopyable,
+                 public std::enable_shared_from_this<TcpRelay>
+{
+ public:
+  static const size_t kDefaultHighWaterMark = 1024 * 1024;
+  static const size_t kDefaultLowWaterMark = 256 * 1024;
+
+  TcpRelay(const TcpConnectionPtr& first, const TcpConnectionPtr& second);
+
+  /// Must be called before @c start
+  void setWaterMarks(size_t highWaterMark, size_t lowWaterMark);
+
+  /// Starts relaying, input buffered so far is sent at once.
+  /// Must be called in the loop thread.
+  void start();
+  /// Stops relaying, shuts down both sides after their pending output,
+  /// and releases them. Must be called in the loop thread.
+  void stop();
+
+  /// valid until @c stop
+  const TcpConnectionPtr& first() const { return first_; }
+  const TcpConnectionPtr& second() const { return second_; }
+
+  // statistics, maintained in the loop thread
+  int64_t bytesToSecond() const { return bytesToSecond_; }
+  int64_t bytesToFirst() const { return bytesToFirst_; }
+  /// times reading from a side was paused
+  int64_t numPauses() const { return numPauses_; }
+
+ private:
+  void onMessage(const TcpConnectionPtr& conn, Buffer* buf);
+  void onHighWaterMark(const TcpConnectionPtr& conn);
+  void onLowWaterMark(const TcpConnectionPtr& conn);
+  const TcpConnectionPtr& peerOf(const TcpConnectionPtr& conn) const;
+
+  EventLoop* loop_;
+  TcpConnectionPtr first_;
+  TcpConnectionPtr second_;
+  size_t highWaterMark_;
+  size_t lowWaterMark_;
+  bool started_;
+  int64_t bytesToSecond_;
+  int64_t bytesToFirst_;
+  int64_t numPauses_;
+};
+
+typedef std::shared_ptr<TcpRelay> TcpRelayPtr;
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TCPRELAY_H
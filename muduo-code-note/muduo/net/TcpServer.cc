@@ -8,11 +8,13 @@
 
 #include <muduo/net/TcpServer.h>
 
+#include <muduo/base/CountDownLatch.h>
 #include <muduo/base/Logging.h>
 #include <muduo/net/Acceptor.h>
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/EventLoopThreadPool.h>
 #include <muduo/net/SocketsOps.h>
+#include <muduo/net/Transport.h>
 
 #include <stdio.h>  // snprintf
 
@@ -24,16 +26,28 @@ TcpServer::TcpServer(EventLoop* loop,
                      const string& nameArg,
                      Option option)
   : loop_(CHECK_NOTNULL(loop)),
+    listenAddr_(listenAddr),
     ipPort_(listenAddr.toIpPort()),
     name_(nameArg),
-    acceptor_(new Acceptor(loop, listenAddr, option == kReusePort)),
+    acceptorPerLoop_(option == kReusePortPerLoop && !listenAddr.isUnixDomain()),
     threadPool_(new EventLoopThreadPool(loop, name_)),
     connectionCallback_(defaultConnectionCallback),
     messageCallback_(defaultMessageCallback),
+    handshakeTimeoutMs_(TcpConnection::kDefaultHandshakeTimeoutMs),
+    completionMode_(false),
+    edgeTriggered_(false),
+    cpuSteering_(false),
+    acceptBatch_(Acceptor::kDefaultAcceptBatch),
+    deferAcceptSeconds_(0),
+    fastOpenQueueLength_(0),
     nextConnId_(1)
 {
-  acceptor_->setNewConnectionCallback(
-      std::bind(&TcpServer::newConnection, this, _1, _2));
+  if (!acceptorPerLoop_)
+  {
+    acceptor_.reset(new Acceptor(loop, listenAddr, option == kReusePort));
+    acceptor_->setNewConnectionCallback(
+        std::bind(&TcpServer::newConnection, this, _1, _2));
+  }
 }
 
 TcpServer::~TcpServer()
@@ -41,7 +55,13 @@ TcpServer::~TcpServer()
   loop_->assertInLoopThread();
   LOG_TRACE << "TcpServer::~TcpServer [" << name_ << "] destructing";
 
-  for (auto& item : connections_)
+  stopAcceptorsPerLoop();
+  ConnectionMap connections;
+  {
+  MutexLockGuard lock(mutex_);
+  connections.swap(connections_);
+  }
+  for (auto& item : connections)
   {
     TcpConnectionPtr conn(item.second);
     item.second.reset();
@@ -56,31 +76,159 @@ void TcpServer::setThreadNum(int numThreads)
   threadPool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setThreadCpuAffinity(const std::vector<std::vector<int>>& cpuSets)
+{
+  threadPool_->setCpuAffinity(cpuSets);
+}
+
+void TcpServer::setLoopSelection(LoopSelection selection)
+{
+  switch (selection)
+  {
+    case kRoundRobin:
+      setLoopSelector(LoopSelector());
+      break;
+    case kLeastConnections:
+      setLoopSelector(EventLoopThreadPool::leastConnections());
+      break;
+    case kLeastPendingFunctors:
+      setLoopSelector(EventLoopThreadPool::leastPendingFunctors());
+      break;
+    case kLeastBusy:
+      setLoopSelector(EventLoopThreadPool::leastBusy());
+      break;
+  }
+}
+
+void TcpServer::setLoopSelector(const LoopSelector& selector)
+{
+  threadPool_->setLoopSelector(selector);
+}
+
 void TcpServer::start()
 {
   if (started_.getAndSet(1) == 0)
   {
     threadPool_->start(threadInitCallback_);
 
-    assert(!acceptor_->listenning());
-    loop_->runInLoop(
-        std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+    if (acceptorPerLoop_)
+    {
+      startAcceptorsPerLoop();
+    }
+    else
+    {
+      assert(!acceptor_->listenning());
+      configureAcceptor(get_pointer(acceptor_));
+      loop_->runInLoop(
+          std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+    }
   }
 }
 
+void TcpServer::configureAcceptor(Acceptor* acceptor)
+{
+  acceptor->setAcceptBatch(acceptBatch_);
+  if (deferAcceptSeconds_ > 0)
+  {
+    acceptor->setDeferAccept(deferAcceptSeconds_);
+  }
+  if (fastOpenQueueLength_ > 0)
+  {
+    acceptor->setFastOpen(fastOpenQueueLength_);
+  }
+}
+
+void TcpServer::startAcceptorsPerLoop()
+{
+  std::vector<EventLoop*> loops = threadPool_->getAllLoops();
+  for (EventLoop* ioLoop : loops)
+  {
+    Acceptor* acceptor = new Acceptor(ioLoop, listenAddr_, true);
+    configureAcceptor(acceptor);
+    acceptor->setNewConnectionCallback(
+        std::bind(&TcpServer::newConnectionInIoLoop, this, ioLoop, _1, _2));
+    loopAcceptors_.emplace_back(acceptor);
+  }
+
+  for (size_t i = 0; i < loops.size(); ++i)
+  {
+    Acceptor* acceptor = get_pointer(loopAcceptors_[i]);
+    if (loops[i]->isInLoopThread() || loops.size() == 1)
+    {
+      loops[i]->runInLoop(std::bind(&Acceptor::listen, acceptor));
+    }
+    else
+    {
+      // one by one, the N-th acceptor joins the SO_REUSEPORT group N-th,
+      // which is the index returned by the filter of setCpuSteering().
+      CountDownLatch latch(1);
+      loops[i]->runInLoop([acceptor, &latch] {
+        acceptor->listen();
+        latch.countDown();
+      });
+      latch.wait();
+    }
+  }
+
+  if (cpuSteering_ && !loopAcceptors_.empty())
+  {
+    loopAcceptors_.front()->attachReusePortCpuFilter();
+  }
+}
+
+void TcpServer::stopAcceptorsPerLoop()
+{
+  // Acceptor must be destroyed in its loop, and before this returns,
+  // as it calls back into this object.
+  CountDownLatch latch(static_cast<int>(loopAcceptors_.size()));
+  for (auto& acceptor : loopAcceptors_)
+  {
+    EventLoop* ioLoop = acceptor->getLoop();
+    if (ioLoop->isInLoopThread())
+    {
+      acceptor.reset();
+      latch.countDown();
+    }
+    else
+    {
+      Acceptor* p = acceptor.release();
+      ioLoop->runInLoop([p, &latch] {
+        delete p;
+        latch.countDown();
+      });
+    }
+  }
+  latch.wait();
+  loopAcceptors_.clear();
+}
+
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
 {
   loop_->assertInLoopThread();
-  EventLoop* ioLoop = threadPool_->getNextLoop();
+  establish(threadPool_->getNextLoop(), sockfd, peerAddr);
+}
+
+void TcpServer::newConnectionInIoLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr)
+{
+  ioLoop->assertInLoopThread();
+  establish(ioLoop, sockfd, peerAddr);
+}
+
+void TcpServer::establish(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr)
+{
   char buf[64];
+  string connName;
+  {
+  MutexLockGuard lock(mutex_);
   snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_);
   ++nextConnId_;
-  string connName = name_ + buf;
+  connName = name_ + buf;
+  }
 
   LOG_INFO << "TcpServer::newConnection [" << name_
            << "] - new connection [" << connName
            << "] from " << peerAddr.toIpPort();
-  InetAddress localAddr(sockets::getLocalAddr(sockfd));
+  InetAddress localAddr(InetAddress::localAddressOf(sockfd));
   // FIXME poll with zero timeout to double confirm the new connection
   // FIXME use make_shared if necessary
   TcpConnectionPtr conn(new TcpConnection(ioLoop,
@@ -88,31 +236,108 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
                                           sockfd,
                                           localAddr,
                                           peerAddr));
+  {
+  MutexLockGuard lock(mutex_);
   connections_[connName] = conn;
+  }
   conn->setConnectionCallback(connectionCallback_);
   conn->setMessageCallback(messageCallback_);
   conn->setWriteCompleteCallback(writeCompleteCallback_);
   conn->setCloseCallback(
       std::bind(&TcpServer::removeConnection, this, _1)); // FIXME: unsafe
+  if (transportFactory_)
+  {
+    conn->setTransport(transportFactory_(), handshakeTimeoutMs_);
+  }
+  conn->setCompletionMode(completionMode_);
+  conn->setEdgeTriggered(edgeTriggered_);
   ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
 }
 
 void TcpServer::removeConnection(const TcpConnectionPtr& conn)
 {
-  // FIXME: unsafe
-  loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+  if (acceptorPerLoop_)
+  {
+    // called in the loop of conn, no trip to the base loop
+    removeConnectionInLoop(conn);
+  }
+  else
+  {
+    // FIXME: unsafe
+    loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+  }
 }
 
 void TcpServer::removeConnectionInLoop(const TcpConnectionPtr& conn)
 {
-  loop_->assertInLoopThread();
+  if (acceptorPerLoop_)
+  {
+    conn->getLoop()->assertInLoopThread();
+  }
+  else
+  {
+    loop_->assertInLoopThread();
+  }
   LOG_INFO << "TcpServer::removeConnectionInLoop [" << name_
            << "] - connection " << conn->name();
-  size_t n = connections_.erase(conn->name());
-  (void)n;
+  size_t n = 0;
+  {
+  MutexLockGuard lock(mutex_);
+  n = connections_.erase(conn->name());
+  }
+  if (n == 0)
+  {
+    // closed while ~TcpServer took it, which destroys it
+    assert(acceptorPerLoop_);
+    return;
+  }
   assert(n == 1);
   EventLoop* ioLoop = conn->getLoop();
   ioLoop->queueInLoop(
       std::bind(&TcpConnection::connectDestroyed, conn));
 }
 
+
+void TcpServer::groupByLoop(ConnectionsByLoop* groups, const TcpConnectionPtr& conn)
+{
+  EventLoop* loop = conn->getLoop();
+  // a few loops, linear search is fine
+  for (auto& group : *groups)
+  {
+    if (group.first == loop)
+    {
+      group.second.push_back(conn);
+      return;
+    }
+  }
+  groups->push_back(std::make_pair(loop, ConnectionList(1, conn)));
+}
+
+void TcpServer::broadcastByLoop(ConnectionsByLoop* groups,
+                                const std::shared_ptr<const string>& message)
+{
+  for (auto& group : *groups)
+  {
+    EventLoop* loop = group.first;
+    if (loop->isInLoopThread())
+    {
+      sendToAll(group.second, message);
+    }
+    else
+    {
+      // one task per loop, queued in order with send() of this thread
+      loop->queueInLoop(
+          std::bind(&TcpServer::sendToAll, std::move(group.second), message));
+    }
+  }
+}
+
+void TcpServer::sendToAll(const ConnectionList& connections,
+                          const std::shared_ptr<const string>& message)
+{
+  for (const TcpConnectionPtr& conn : connections)
+  {
+    // in loop, the unsent part refers to message
+    conn->send(message);
+  }
+}
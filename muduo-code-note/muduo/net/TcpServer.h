@@ -12,10 +12,13 @@
 #define MUDUO_NET_TCPSERVER_H
 
 #include <muduo/base/Atomic.h>
+#include <muduo/base/Mutex.h>
 #include <muduo/base/Types.h>
 #include <muduo/net/TcpConnection.h>
 
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace muduo
 {
@@ -28,6 +31,7 @@ class EventLoopThreadPool;
 
 ///
 /// TCP server, supports single-threaded and thread-pool models.
+/// Listens on a Unix domain socket as well, see InetAddress::unixDomain().
 ///
 /// This is an interface class, so don't expose too much details.
 class TcpServer : noncopyable
@@ -38,6 +42,18 @@ class TcpServer : noncopyable
   {
     kNoReusePort,
     kReusePort,
+    // every I/O loop listens with SO_REUSEPORT and accepts its own connections,
+    // instead of one acceptor in the base loop handing them out.
+    // Unix domain addresses have one acceptor anyway.
+    kReusePortPerLoop,
+  };
+  // how newConnection() picks the I/O loop, see EventLoopThreadPool
+  enum LoopSelection
+  {
+    kRoundRobin,
+    kLeastConnections,
+    kLeastPendingFunctors,
+    kLeastBusy,
   };
 
   //TcpServer(EventLoop* loop, const InetAddress& listenAddr);
@@ -53,7 +69,8 @@ class TcpServer : noncopyable
 
   /// Set the number of threads for handling input.
   ///
-  /// Always accepts new connection in loop's thread.
+  /// Always accepts new connection in loop's thread,
+  /// unless kReusePortPerLoop, with which every I/O loop accepts its own.
   /// Must be called before @c start
   /// @param numThreads
   /// - 0 means all I/O in loop's thread, no thread will created.
@@ -62,12 +79,70 @@ class TcpServer : noncopyable
   /// - N means a thread pool with N threads, new connections
   ///   are assigned on a round-robin basis.
   void setThreadNum(int numThreads);
+  /// Pins the N-th I/O loop thread to cpuSets[N % cpuSets.size()],
+  /// e.g. {{0}, {1}} or ProcessInfo::cpusOfNumaNode(),
+  /// memory of the loop is allocated from the NUMA node of the CPUs.
+  /// Must be called before @c start
+  void setThreadCpuAffinity(const std::vector<std::vector<int>>& cpuSets);
   void setThreadInitCallback(const ThreadInitCallback& cb)
   { threadInitCallback_ = cb; }
+  /// Picks the I/O loop of new connections, kRoundRobin by default.
+  /// Not for kReusePortPerLoop, of which the kernel picks.
+  void setLoopSelection(LoopSelection selection);
+  void setLoopSelector(const LoopSelector& selector);
   /// valid after calling start()
   std::shared_ptr<EventLoopThreadPool> threadPool()
   { return threadPool_; }
 
+  /// Reads and writes of new connections are submitted to the loop,
+  /// instead of done on readiness. Only loops using UringPoller
+  /// (MUDUO_USE_URING) support it, others ignore the setting.
+  /// Must be called before @c start
+  void setCompletionMode(bool on)
+  { completionMode_ = on; }
+
+  /// New connections get a Transport from the factory and handshake
+  /// before the connection callback, e.g. TlsContext::transportFactory().
+  /// Replaces completion mode. Must be called before @c start
+  void setTransportFactory(const TransportFactory& factory)
+  { transportFactory_ = factory; }
+  /// Connections still handshaking after this are closed, 10s by default.
+  /// Must be called before @c start
+  void setHandshakeTimeout(int timeoutMs)
+  { handshakeTimeoutMs_ = timeoutMs; }
+
+  /// New connections register edge triggered interest in reading and
+  /// writing once, see TcpConnection::setEdgeTriggered(). Only loops
+  /// using EPollPoller support it, others ignore the setting.
+  /// Must be called before @c start
+  void setEdgeTriggered(bool on)
+  { edgeTriggered_ = on; }
+
+  /// With kReusePortPerLoop, the kernel gives a connection received
+  /// on CPU N to the N-th I/O loop, see Socket::attachReusePortCpuFilter().
+  /// Pin the N-th loop to CPU N in ThreadInitCallback to make use of it.
+  /// Must be called before @c start
+  void setCpuSteering(bool on)
+  { cpuSteering_ = on; }
+
+  /// Connections accepted per readiness of the listening socket at most,
+  /// see Acceptor::setAcceptBatch().
+  /// Must be called before @c start
+  void setAcceptBatch(int batch)
+  { acceptBatch_ = batch; }
+
+  /// TCP_DEFER_ACCEPT, a connection is handed to a loop only after its
+  /// first data arrives, 0 to disable.
+  /// Must be called before @c start
+  void setDeferAccept(int seconds)
+  { deferAcceptSeconds_ = seconds; }
+
+  /// Server side TCP_FASTOPEN, the first data of a client with a cookie
+  /// comes with its SYN, see Socket::setFastOpen(). 0 to disable.
+  /// Must be called before @c start
+  void setFastOpen(int queueLength)
+  { fastOpenQueueLength_ = queueLength; }
+
   /// Starts the server if it's not listenning.
   ///
   /// It's harmless to call it multiple times.
@@ -89,29 +164,74 @@ class TcpServer : noncopyable
   void setWriteCompleteCallback(const WriteCompleteCallback& cb)
   { writeCompleteCallback_ = cb; }
 
+  /// Sends one shared message to many connections, of any TcpServer or TcpClient.
+  ///
+  /// Connections are grouped by their loops, each loop runs one task
+  /// which sends @c message to its connections without copying it,
+  /// instead of one task and one copy per connection.
+  /// Thread safe.
+  template<typename Container>
+  static void broadcast(const Container& connections,
+                        const std::shared_ptr<const string>& message)
+  {
+    ConnectionsByLoop groups;
+    for (const TcpConnectionPtr& conn : connections)
+    {
+      groupByLoop(&groups, conn);
+    }
+    broadcastByLoop(&groups, message);
+  }
+
  private:
+  typedef std::vector<TcpConnectionPtr> ConnectionList;
+  typedef std::vector<std::pair<EventLoop*, ConnectionList> > ConnectionsByLoop;
+
+  static void groupByLoop(ConnectionsByLoop* groups, const TcpConnectionPtr& conn);
+  static void broadcastByLoop(ConnectionsByLoop* groups,
+                              const std::shared_ptr<const string>& message);
+  static void sendToAll(const ConnectionList& connections,
+                        const std::shared_ptr<const string>& message);
+
   /// Not thread safe, but in loop
   void newConnection(int sockfd, const InetAddress& peerAddr);
+  /// kReusePortPerLoop, in ioLoop
+  void newConnectionInIoLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);
+  void establish(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);
   /// Thread safe.
   void removeConnection(const TcpConnectionPtr& conn);
-  /// Not thread safe, but in loop
+  /// Not thread safe, but in loop, the loop of conn with kReusePortPerLoop
   void removeConnectionInLoop(const TcpConnectionPtr& conn);
+  void configureAcceptor(Acceptor* acceptor);
+  void startAcceptorsPerLoop();
+  void stopAcceptorsPerLoop();
 
   typedef std::map<string, TcpConnectionPtr> ConnectionMap;
 
   EventLoop* loop_;  // the acceptor loop
+  const InetAddress listenAddr_;
   const string ipPort_;
   const string name_;
-  std::unique_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
+  const bool acceptorPerLoop_;
+  std::unique_ptr<Acceptor> acceptor_; // avoid revealing Acceptor, NULL if acceptorPerLoop_
+  std::vector<std::unique_ptr<Acceptor>> loopAcceptors_;  // one per I/O loop
   std::shared_ptr<EventLoopThreadPool> threadPool_;
   ConnectionCallback connectionCallback_;
   MessageCallback messageCallback_;
   WriteCompleteCallback writeCompleteCallback_;
   ThreadInitCallback threadInitCallback_;
+  TransportFactory transportFactory_;
+  int handshakeTimeoutMs_;
   AtomicInt32 started_;
-  // always in loop thread
-  int nextConnId_;
-  ConnectionMap connections_;
+  bool completionMode_;
+  bool edgeTriggered_;
+  bool cpuSteering_;
+  int acceptBatch_;
+  int deferAcceptSeconds_;
+  int fastOpenQueueLength_;
+  // I/O loops add and remove connections with acceptorPerLoop_
+  MutexLock mutex_;
+  int nextConnId_ GUARDED_BY(mutex_);
+  ConnectionMap connections_ GUARDED_BY(mutex_);
 };
 
 }  // namespace net
@@ -13,7 +13,7 @@ using namespace muduo::net;
 
 AtomicInt64 Timer::s_numCreated_;
 
-void Timer::restart(Timestamp now)
+void Timer::restart(MonotonicTime now)
 {
   if (repeat_)
   {
@@ -21,6 +21,21 @@ void Timer::restart(Timestamp now)
   }
   else
   {
-    expiration_ = Timestamp::invalid();
+    expiration_ = MonotonicTime::invalid();
   }
 }
+
+void Timer::reuse(TimerCallback cb, MonotonicTime when, double interval)
+{
+  callback_ = std::move(cb);
+  expiration_ = when;
+  interval_ = interval;
+  repeat_ = interval > 0.0;
+  sequence_ = s_numCreated_.incrementAndGet();
+}
+
+void Timer::release()
+{
+  callback_ = TimerCallback();  // frees what it binds
+  sequence_ = 0;
+}
@@ -12,7 +12,7 @@
 #define MUDUO_NET_TIMER_H
 
 #include <muduo/base/Atomic.h>
-#include <muduo/base/Timestamp.h>
+#include <muduo/base/MonotonicTime.h>
 #include <muduo/net/Callbacks.h>
 
 namespace muduo
@@ -26,33 +26,46 @@ namespace net
 class Timer : noncopyable
 {
  public:
-  Timer(TimerCallback cb, Timestamp when, double interval)
+  Timer(TimerCallback cb, MonotonicTime when, double interval)
     : callback_(std::move(cb)),
       expiration_(when),
       interval_(interval),
       repeat_(interval > 0.0),
-      sequence_(s_numCreated_.incrementAndGet())
+      sequence_(s_numCreated_.incrementAndGet()),
+      next_(NULL),
+      prev_(NULL),
+      slot_(-1)
   { }
 
+  // for recycling by TimerWheel, a stale TimerId never matches a new sequence.
+  void reuse(TimerCallback cb, MonotonicTime when, double interval);
+  void release();
+
   void run() const
   {
     callback_();
   }
 
-  Timestamp expiration() const  { return expiration_; }
+  MonotonicTime expiration() const  { return expiration_; }
   bool repeat() const { return repeat_; }
   int64_t sequence() const { return sequence_; }
 
-  void restart(Timestamp now);
+  void restart(MonotonicTime now);
 
   static int64_t numCreated() { return s_numCreated_.get(); }
 
  private:
-  const TimerCallback callback_;
-  Timestamp expiration_;
-  const double interval_;
-  const bool repeat_;
-  const int64_t sequence_;
+  TimerCallback callback_;
+  MonotonicTime expiration_;
+  double interval_;
+  bool repeat_;
+  int64_t sequence_;
+
+  // intrusive links of TimerWheel
+  friend class TimerWheel;
+  Timer* next_;
+  Timer* prev_;
+  int slot_;  // -1 if not in the wheel
 
   static AtomicInt64 s_numCreated_;
 };
@@ -14,9 +14,12 @@
 
 #include <muduo/base/Logging.h>
 #include <muduo/net/EventLoop.h>
+#include <muduo/net/LoopStats.h>
 #include <muduo/net/Timer.h>
 #include <muduo/net/TimerId.h>
+#include <muduo/net/TimerWheel.h>
 
+#include <stdlib.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
@@ -38,23 +41,23 @@ int createTimerfd()
   return timerfd;
 }
 
-struct timespec howMuchTimeFromNow(Timestamp when)
+struct timespec howMuchTimeFromNow(MonotonicTime when)
 {
-  int64_t microseconds = when.microSecondsSinceEpoch()
-                         - Timestamp::now().microSecondsSinceEpoch();
+  int64_t microseconds = when.microSeconds()
+                         - MonotonicTime::now().microSeconds();
   if (microseconds < 100)
   {
     microseconds = 100;
   }
   struct timespec ts;
   ts.tv_sec = static_cast<time_t>(
-      microseconds / Timestamp::kMicroSecondsPerSecond);
+      microseconds / MonotonicTime::kMicroSecondsPerSecond);
   ts.tv_nsec = static_cast<long>(
-      (microseconds % Timestamp::kMicroSecondsPerSecond) * 1000);
+      (microseconds % MonotonicTime::kMicroSecondsPerSecond) * 1000);
   return ts;
 }
 
-void readTimerfd(int timerfd, Timestamp now)
+void readTimerfd(int timerfd, MonotonicTime now)
 {
   uint64_t howmany;
   ssize_t n = ::read(timerfd, &howmany, sizeof howmany);
@@ -65,7 +68,7 @@ void readTimerfd(int timerfd, Timestamp now)
   }
 }
 
-void resetTimerfd(int timerfd, Timestamp expiration)
+void resetTimerfd(int timerfd, MonotonicTime expiration)
 {
   // wake up loop by timerfd_settime()
   struct itimerspec newValue;
@@ -95,6 +98,10 @@ TimerQueue::TimerQueue(EventLoop* loop)
     timers_(),
     callingExpiredTimers_(false)
 {
+  if (::getenv("MUDUO_USE_TIMERWHEEL"))
+  {
+    wheel_.reset(new TimerWheel(MonotonicTime::now()));
+  }
   timerfdChannel_.setReadCallback(
       std::bind(&TimerQueue::handleRead, this));
   // we are always reading the timerfd, we disarm it with timerfd_settime.
@@ -114,10 +121,13 @@ TimerQueue::~TimerQueue()
 }
 
 TimerId TimerQueue::addTimer(TimerCallback cb,
-                             Timestamp when,
+                             MonotonicTime when,
                              double interval)
 {
-  Timer* timer = new Timer(std::move(cb), when, interval);
+  // TimerWheel recycles timers in the loop thread
+  Timer* timer = wheel_ && loop_->isInLoopThread()
+      ? wheel_->newTimer(std::move(cb), when, interval)
+      : new Timer(std::move(cb), when, interval);
   loop_->runInLoop(
       std::bind(&TimerQueue::addTimerInLoop, this, timer));
   return TimerId(timer, timer->sequence());
@@ -132,6 +142,14 @@ void TimerQueue::cancel(TimerId timerId)
 void TimerQueue::addTimerInLoop(Timer* timer)
 {
   loop_->assertInLoopThread();
+  if (wheel_)
+  {
+    if (wheel_->insert(timer))
+    {
+      resetTimerfd(timerfd_, wheel_->earliest());
+    }
+    return;
+  }
   bool earliestChanged = insert(timer);
 
   if (earliestChanged)
@@ -143,6 +161,11 @@ void TimerQueue::addTimerInLoop(Timer* timer)
 void TimerQueue::cancelInLoop(TimerId timerId)
 {
   loop_->assertInLoopThread();
+  if (wheel_)
+  {
+    cancelInWheel(timerId);
+    return;
+  }
   assert(timers_.size() == activeTimers_.size());
   ActiveTimer timer(timerId.timer_, timerId.sequence_);
   ActiveTimerSet::iterator it = activeTimers_.find(timer);
@@ -163,16 +186,24 @@ void TimerQueue::cancelInLoop(TimerId timerId)
 void TimerQueue::handleRead()
 {
   loop_->assertInLoopThread();
-  Timestamp now(Timestamp::now());
+  // the timerfd fired at or after the earliest expiration, before poll returned
+  MonotonicTime now(loop_->now());
   readTimerfd(timerfd_, now);
+  if (wheel_)
+  {
+    handleWheel(now);
+    return;
+  }
 
   std::vector<Entry> expired = getExpired(now);
 
+  Histogram& lateness = loop_->stats().timerLateness;
   callingExpiredTimers_ = true;
   cancelingTimers_.clear();
   // safe to callback outside critical section
   for (const Entry& it : expired)
   {
+    lateness.record(now.microSeconds() - it.first.microSeconds());
     it.second->run();
   }
   callingExpiredTimers_ = false;
@@ -180,7 +211,7 @@ void TimerQueue::handleRead()
   reset(expired, now);
 }
 
-std::vector<TimerQueue::Entry> TimerQueue::getExpired(Timestamp now)
+std::vector<TimerQueue::Entry> TimerQueue::getExpired(MonotonicTime now)
 {
   assert(timers_.size() == activeTimers_.size());
   std::vector<Entry> expired;
@@ -201,9 +232,9 @@ std::vector<TimerQueue::Entry> TimerQueue::getExpired(Timestamp now)
   return expired;
 }
 
-void TimerQueue::reset(const std::vector<Entry>& expired, Timestamp now)
+void TimerQueue::reset(const std::vector<Entry>& expired, MonotonicTime now)
 {
-  Timestamp nextExpire;
+  MonotonicTime nextExpire;
 
   for (const Entry& it : expired)
   {
@@ -237,7 +268,7 @@ bool TimerQueue::insert(Timer* timer)
   loop_->assertInLoopThread();
   assert(timers_.size() == activeTimers_.size());
   bool earliestChanged = false;
-  Timestamp when = timer->expiration();
+  MonotonicTime when = timer->expiration();
   TimerList::iterator it = timers_.begin();
   if (it == timers_.end() || when < it->first)
   {
@@ -258,3 +289,60 @@ bool TimerQueue::insert(Timer* timer)
   return earliestChanged;
 }
 
+
+void TimerQueue::cancelInWheel(TimerId timerId)
+{
+  // timers are never freed before the wheel, a stale one has another sequence.
+  Timer* timer = timerId.timer_;
+  if (timer == NULL || timer->sequence() != timerId.sequence_)
+  {
+    return;
+  }
+  if (TimerWheel::contains(timer))
+  {
+    wheel_->remove(timer);
+    wheel_->release(timer);
+  }
+  else if (callingExpiredTimers_)
+  {
+    cancelingTimers_.insert(ActiveTimer(timer, timerId.sequence_));
+  }
+}
+
+void TimerQueue::handleWheel(MonotonicTime now)
+{
+  expiredTimers_.clear();
+  wheel_->takeExpired(now, &expiredTimers_);
+
+  Histogram& lateness = loop_->stats().timerLateness;
+  callingExpiredTimers_ = true;
+  cancelingTimers_.clear();
+  for (Timer* timer : expiredTimers_)
+  {
+    lateness.record(now.microSeconds() - timer->expiration().microSeconds());
+    timer->run();
+  }
+  callingExpiredTimers_ = false;
+
+  for (Timer* timer : expiredTimers_)
+  {
+    ActiveTimer key(timer, timer->sequence());
+    if (timer->repeat()
+        && cancelingTimers_.find(key) == cancelingTimers_.end())
+    {
+      timer->restart(now);
+      wheel_->insert(timer);
+    }
+    else
+    {
+      wheel_->release(timer);
+    }
+  }
+  expiredTimers_.clear();
+
+  MonotonicTime nextExpire = wheel_->earliest();
+  if (nextExpire.valid())
+  {
+    resetTimerfd(timerfd_, nextExpire);
+  }
+}
@@ -11,11 +11,12 @@
 #ifndef MUDUO_NET_TIMERQUEUE_H
 #define MUDUO_NET_TIMERQUEUE_H
 
+#include <memory>
 #include <set>
 #include <vector>
 
 #include <muduo/base/Mutex.h>
-#include <muduo/base/Timestamp.h>
+#include <muduo/base/MonotonicTime.h>
 #include <muduo/net/Callbacks.h>
 #include <muduo/net/Channel.h>
 
@@ -27,11 +28,16 @@ namespace net
 class EventLoop;
 class Timer;
 class TimerId;
+class TimerWheel;
 
 ///
 /// A best efforts timer queue.
 /// No guarantee that the callback will be on time.
 ///
+/// Timers are kept in sorted sets, or in a TimerWheel if environment
+/// variable MUDUO_USE_TIMERWHEEL is set, which has O(1) insertion and
+/// cancellation at 1ms resolution, for lots of timers such as idle timeouts.
+///
 class TimerQueue : noncopyable
 {
  public:
@@ -44,7 +50,7 @@ class TimerQueue : noncopyable
   ///
   /// Must be thread safe. Usually be called from other threads.
   TimerId addTimer(TimerCallback cb,
-                   Timestamp when,
+                   MonotonicTime when,
                    double interval);
 
   void cancel(TimerId timerId);
@@ -54,7 +60,7 @@ class TimerQueue : noncopyable
   // FIXME: use unique_ptr<Timer> instead of raw pointers.
   // This requires heterogeneous comparison lookup (N3465) from C++14
   // so that we can find an T* in a set<unique_ptr<T>>.
-  typedef std::pair<Timestamp, Timer*> Entry;
+  typedef std::pair<MonotonicTime, Timer*> Entry;
   typedef std::set<Entry> TimerList;
   typedef std::pair<Timer*, int64_t> ActiveTimer;
   typedef std::set<ActiveTimer> ActiveTimerSet;
@@ -64,11 +70,15 @@ class TimerQueue : noncopyable
   // called when timerfd alarms
   void handleRead();
   // move out all expired timers
-  std::vector<Entry> getExpired(Timestamp now);
-  void reset(const std::vector<Entry>& expired, Timestamp now);
+  std::vector<Entry> getExpired(MonotonicTime now);
+  void reset(const std::vector<Entry>& expired, MonotonicTime now);
 
   bool insert(Timer* timer);
 
+  // TimerWheel counterparts
+  void cancelInWheel(TimerId timerId);
+  void handleWheel(MonotonicTime now);
+
   EventLoop* loop_;
   const int timerfd_;
   Channel timerfdChannel_;
@@ -79,6 +89,10 @@ class TimerQueue : noncopyable
   ActiveTimerSet activeTimers_;
   bool callingExpiredTimers_; /* atomic */
   ActiveTimerSet cancelingTimers_;
+
+  // replaces timers_ and activeTimers_ if not null
+  std::unique_ptr<TimerWheel> wheel_;
+  std::vector<Timer*> expiredTimers_;
 };
 
 }  // namespace net
@@ -0,0 +1,280 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/TimerWheel.h>
+
+#include <muduo/net/Timer.h>
+
+#include <algorithm>
+
+#include <assert.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int TimerWheel::kLevels;
+const int TimerWheel::kBits;
+const int TimerWheel::kSlots;
+const int TimerWheel::kMask;
+
+namespace
+{
+const int64_t kMicroSecondsPerTick = 1000;
+}
+
+TimerWheel::TimerWheel(MonotonicTime now)
+  : startMicroSeconds_(now.microSeconds()),
+    currentTick_(0),
+    earliestTick_(-1),
+    size_(0)
+{
+  std::fill(counts_, counts_ + kLevels, 0);
+  std::fill(slots_, slots_ + kLevels * kSlots, static_cast<Timer*>(NULL));
+}
+
+TimerWheel::~TimerWheel()
+{
+  for (int slot = 0; slot < kLevels * kSlots; ++slot)
+  {
+    Timer* timer = slots_[slot];
+    while (timer)
+    {
+      Timer* next = timer->next_;
+      delete timer;
+      timer = next;
+    }
+  }
+  for (Timer* timer : freeTimers_)
+  {
+    delete timer;
+  }
+}
+
+Timer* TimerWheel::newTimer(TimerCallback cb, MonotonicTime when, double interval)
+{
+  if (freeTimers_.empty())
+  {
+    return new Timer(std::move(cb), when, interval);
+  }
+  Timer* timer = freeTimers_.back();
+  freeTimers_.pop_back();
+  timer->reuse(std::move(cb), when, interval);
+  return timer;
+}
+
+void TimerWheel::release(Timer* timer)
+{
+  assert(!contains(timer));
+  timer->release();
+  freeTimers_.push_back(timer);
+}
+
+bool TimerWheel::insert(Timer* timer)
+{
+  assert(!contains(timer));
+  link(timer);
+  ++size_;
+  int64_t tick = std::max(tickOf(timer->expiration()), currentTick_);
+  if (earliestTick_ < 0 || tick < earliestTick_)
+  {
+    earliestTick_ = tick;
+    return true;
+  }
+  return false;
+}
+
+void TimerWheel::remove(Timer* timer)
+{
+  assert(contains(timer));
+  if (timer->prev_)
+  {
+    timer->prev_->next_ = timer->next_;
+  }
+  else
+  {
+    slots_[timer->slot_] = timer->next_;
+  }
+  if (timer->next_)
+  {
+    timer->next_->prev_ = timer->prev_;
+  }
+  --counts_[timer->slot_ / kSlots];
+  --size_;
+  timer->next_ = NULL;
+  timer->prev_ = NULL;
+  timer->slot_ = -1;
+}
+
+bool TimerWheel::contains(const Timer* timer)
+{
+  return timer->slot_ >= 0;
+}
+
+void TimerWheel::takeExpired(MonotonicTime now, std::vector<Timer*>* expired)
+{
+  const int64_t target = (now.microSeconds() - startMicroSeconds_) / kMicroSecondsPerTick;
+  while (currentTick_ <= target && size_ > 0)
+  {
+    if ((currentTick_ & kMask) == 0)
+    {
+      cascade();
+    }
+    if (counts_[0] == 0)
+    {
+      // nothing in this round, skip to the next cascade that has something
+      int level = 1;
+      while (level < kLevels - 1 && counts_[level] == 0)
+      {
+        ++level;
+      }
+      int64_t next = ((currentTick_ >> (kBits * level)) + 1) << (kBits * level);
+      currentTick_ = std::min(next, target + 1);
+      continue;
+    }
+    Timer* timer = unlinkSlot(static_cast<int>(currentTick_ & kMask));
+    while (timer)
+    {
+      Timer* next = timer->next_;
+      timer->next_ = NULL;
+      timer->prev_ = NULL;
+      expired->push_back(timer);
+      --size_;
+      timer = next;
+    }
+    ++currentTick_;
+  }
+  if (size_ == 0)
+  {
+    currentTick_ = std::max(currentTick_, target + 1);
+  }
+  earliestTick_ = -1;
+}
+
+MonotonicTime TimerWheel::earliest()
+{
+  if (size_ == 0)
+  {
+    earliestTick_ = -1;
+    return MonotonicTime::invalid();
+  }
+  earliestTick_ = nextTick();
+  return timeOf(earliestTick_);
+}
+
+int64_t TimerWheel::tickOf(MonotonicTime when) const
+{
+  int64_t us = when.microSeconds() - startMicroSeconds_;
+  return us <= 0 ? 0 : (us + kMicroSecondsPerTick - 1) / kMicroSecondsPerTick;
+}
+
+MonotonicTime TimerWheel::timeOf(int64_t tick) const
+{
+  return MonotonicTime(startMicroSeconds_ + tick * kMicroSecondsPerTick);
+}
+
+void TimerWheel::link(Timer* timer)
+{
+  const int64_t kMaxDelta = (static_cast<int64_t>(1) << (kBits * kLevels)) - 1;
+  int64_t expires = tickOf(timer->expiration());
+  int64_t delta = expires - currentTick_;
+  if (delta < 0)
+  {
+    expires = currentTick_;
+    delta = 0;
+  }
+  else if (delta > kMaxDelta)
+  {
+    // cascaded again when the last level comes around
+    expires = currentTick_ + kMaxDelta;
+    delta = kMaxDelta;
+  }
+  int level = 0;
+  while (delta >= (static_cast<int64_t>(1) << (kBits * (level + 1))))
+  {
+    ++level;
+  }
+  int slot = level * kSlots + static_cast<int>((expires >> (kBits * level)) & kMask);
+  timer->slot_ = slot;
+  timer->prev_ = NULL;
+  timer->next_ = slots_[slot];
+  if (timer->next_)
+  {
+    timer->next_->prev_ = timer;
+  }
+  slots_[slot] = timer;
+  ++counts_[level];
+}
+
+Timer* TimerWheel::unlinkSlot(int slot)
+{
+  Timer* head = slots_[slot];
+  slots_[slot] = NULL;
+  for (Timer* timer = head; timer; timer = timer->next_)
+  {
+    timer->slot_ = -1;
+    --counts_[slot / kSlots];
+  }
+  return head;
+}
+
+// moves timers of the coming round down to lower levels.
+void TimerWheel::cascade()
+{
+  for (int level = 1; level < kLevels; ++level)
+  {
+    int index = static_cast<int>((currentTick_ >> (kBits * level)) & kMask);
+    Timer* timer = unlinkSlot(level * kSlots + index);
+    while (timer)
+    {
+      Timer* next = timer->next_;
+      link(timer);
+      timer = next;
+    }
+    if (index != 0)
+    {
+      break;
+    }
+  }
+}
+
+// exact for the first level, the next cascade for upper levels.
+int64_t TimerWheel::nextTick() const
+{
+  int64_t result = -1;
+  if (counts_[0] > 0)
+  {
+    for (int k = 0; k < kSlots; ++k)
+    {
+      if (slots_[(currentTick_ + k) & kMask])
+      {
+        result = currentTick_ + k;
+        break;
+      }
+    }
+  }
+  for (int level = 1; level < kLevels; ++level)
+  {
+    if (counts_[level] == 0)
+    {
+      continue;
+    }
+    const int shift = kBits * level;
+    const int64_t round = currentTick_ >> shift;
+    // not cascaded yet if we are right at the boundary
+    int k = (currentTick_ & ((static_cast<int64_t>(1) << shift) - 1)) == 0 ? 0 : 1;
+    for (; k <= kSlots; ++k)
+    {
+      if (slots_[level * kSlots + ((round + k) & kMask)])
+      {
+        int64_t tick = (round + k) << shift;
+        if (result < 0 || tick < result)
+        {
+          result = tick;
+        }
+        break;
+      }
+    }
+  }
+  assert(result >= 0);
+  return result;
+}
@@ -0,0 +1,82 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_TIMERWHEEL_H
+#define MUDUO_NET_TIMERWHEEL_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/net/Callbacks.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+class Timer;
+
+///
+/// Hierarchical timing wheel, an O(1) alternative of the sorted sets
+/// in TimerQueue, see "Hashed and Hierarchical Timing Wheels" by Varghese.
+///
+/// 4 levels of 256 slots with 1ms tick, covers 49 days, later timers
+/// are parked in the last level and cascaded again.
+/// Timers are linked through themselves, and never freed before the wheel,
+/// so a stale TimerId can be checked against Timer::sequence() safely.
+///
+/// Not thread safe, all calls must be in the loop thread.
+class TimerWheel : noncopyable
+{
+ public:
+  explicit TimerWheel(MonotonicTime now);
+  ~TimerWheel();
+
+  /// Recycles a released timer if any.
+  Timer* newTimer(TimerCallback cb, MonotonicTime when, double interval);
+  /// Keeps @c timer for reuse, it must not be in the wheel.
+  void release(Timer* timer);
+
+  /// @return true if @c timer expires before the earliest one so far,
+  /// the timerfd should be reset to earliest().
+  bool insert(Timer* timer);
+  void remove(Timer* timer);
+  static bool contains(const Timer* timer);
+
+  /// Moves timers due at @c now out of the wheel.
+  void takeExpired(MonotonicTime now, std::vector<Timer*>* expired);
+
+  /// Time of the next tick which has something to do, invalid if empty.
+  MonotonicTime earliest();
+
+  size_t size() const { return size_; }
+
+ private:
+  static const int kLevels = 4;
+  static const int kBits = 8;
+  static const int kSlots = 1 << kBits;
+  static const int kMask = kSlots - 1;
+
+  int64_t tickOf(MonotonicTime when) const;
+  MonotonicTime timeOf(int64_t tick) const;
+  void link(Timer* timer);
+  Timer* unlinkSlot(int slot);
+  void cascade();
+  int64_t nextTick() const;
+
+  const int64_t startMicroSeconds_;
+  int64_t currentTick_;  // all ticks before it are done
+  int64_t earliestTick_;  // -1 if unknown
+  size_t size_;
+  int counts_[kLevels];
+  Timer* slots_[kLevels * kSlots];
+  std::vector<Timer*> freeTimers_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TIMERWHEEL_H
@@ -0,0 +1,53 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_TRANSPORT_H
+#define MUDUO_NET_TRANSPORT_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace muduo
+{
+namespace net
+{
+
+class Buffer;
+
+///
+/// Security layer of a TcpConnection, e.g. TLS, see muduo/net/tls.
+///
+/// The connection runs handshake() on socket events until it is done,
+/// then calls back connected. Afterwards it reads with read(), and writes
+/// with writev() unless kernelSend(), where the kernel encrypts plain
+/// writes, so writev(2) and sendfile(2) of the connection go as they are.
+///
+/// Called in the loop thread of the connection only.
+class Transport : noncopyable
+{
+ public:
+  enum HandshakeResult { kHandshakeDone, kWantRead, kWantWrite, kHandshakeFailed };
+
+  virtual ~Transport() { }
+
+  virtual HandshakeResult handshake(int fd) = 0;
+  /// Like Buffer::readFd(), > 0 bytes, 0 at the end, < 0 with *savedErrno,
+  /// EAGAIN while a record is incomplete. Reads all it has decrypted,
+  /// no event comes for data held by the transport.
+  virtual ssize_t read(int fd, Buffer* buf, int* savedErrno) = 0;
+  /// Like writev(2), < 0 with *savedErrno.
+  virtual ssize_t writev(int fd, const struct iovec* iov, int iovcnt, int* savedErrno) = 0;
+  /// valid after the handshake
+  virtual bool kernelSend() const = 0;
+  /// Before shutting down writing, e.g. TLS close_notify.
+  virtual void shutdown(int fd) = 0;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TRANSPORT_H
@@ -0,0 +1,90 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/UdpServer.h>
+
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+
+#include <stdio.h>  // snprintf
+
+using namespace muduo;
+using namespace muduo::net;
+
+UdpServer::UdpServer(EventLoop* loop,
+                     const InetAddress& listenAddr,
+                     const string& nameArg)
+  : loop_(CHECK_NOTNULL(loop)),
+    name_(nameArg),
+    listenAddr_(listenAddr),
+    threadPool_(new EventLoopThreadPool(loop, name_)),
+    maxDatagramSize_(UdpSocket::kDefaultMaxDatagramSize),
+    gso_(false),
+    gro_(false)
+{
+}
+
+UdpServer::~UdpServer()
+{
+  loop_->assertInLoopThread();
+  LOG_TRACE << "UdpServer::~UdpServer [" << name_ << "] destructing";
+
+  // UdpSocket must be destroyed in its loop, and before this returns,
+  // as it calls back into this object.
+  CountDownLatch latch(static_cast<int>(sockets_.size()));
+  for (auto& socket : sockets_)
+  {
+    EventLoop* ioLoop = socket->getLoop();
+    if (ioLoop->isInLoopThread())
+    {
+      socket.reset();
+      latch.countDown();
+    }
+    else
+    {
+      UdpSocket* p = socket.release();
+      ioLoop->runInLoop([p, &latch] {
+        delete p;
+        latch.countDown();
+      });
+    }
+  }
+  latch.wait();
+}
+
+void UdpServer::setThreadNum(int numThreads)
+{
+  assert(0 <= numThreads);
+  threadPool_->setThreadNum(numThreads);
+}
+
+void UdpServer::start()
+{
+  if (started_.getAndSet(1) == 0)
+  {
+    threadPool_->start(threadInitCallback_);
+
+    std::vector<EventLoop*> loops = threadPool_->getAllLoops();
+    for (size_t i = 0; i < loops.size(); ++i)
+    {
+      char buf[64];
+      snprintf(buf, sizeof buf, "-%s#%zd", listenAddr_.toIpPort().c_str(), i);
+      UdpSocket* socket = new UdpSocket(loops[i], name_ + buf, listenAddr_.family());
+      socket->setMaxDatagramSize(maxDatagramSize_);
+      if (gso_)
+      {
+        socket->setGso(true);
+      }
+      if (gro_)
+      {
+        socket->setGro(true);
+      }
+      socket->setDatagramCallback(datagramCallback_);
+      socket->bindAddress(listenAddr_, loops.size() > 1);
+      sockets_.emplace_back(socket);
+      socket->start();
+    }
+  }
+}
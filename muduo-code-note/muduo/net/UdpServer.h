@@ -0,0 +1,93 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_UDPSERVER_H
+#define MUDUO_NET_UDPSERVER_H
+
+#include <muduo/base/Atomic.h>
+#include <muduo/base/Types.h>
+#include <muduo/net/UdpSocket.h>
+
+#include <memory>
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+class EventLoop;
+class EventLoopThreadPool;
+
+///
+/// UDP server, one socket per I/O loop.
+///
+/// With threads, every I/O loop binds its own socket to the address with
+/// SO_REUSEPORT, the kernel spreads peers over them by address hash,
+/// so each loop receives and replies on its own, no datagram crosses
+/// threads. Without, the base loop has the only socket.
+class UdpServer : noncopyable
+{
+ public:
+  typedef std::function<void(EventLoop*)> ThreadInitCallback;
+
+  UdpServer(EventLoop* loop,
+            const InetAddress& listenAddr,
+            const string& nameArg);
+  ~UdpServer();  // force out-line dtor, for std::unique_ptr members.
+
+  const string& name() const { return name_; }
+  EventLoop* getLoop() const { return loop_; }
+
+  /// Set the number of threads, each has a socket.
+  /// Must be called before @c start
+  void setThreadNum(int numThreads);
+  void setThreadInitCallback(const ThreadInitCallback& cb)
+  { threadInitCallback_ = cb; }
+  /// valid after calling start()
+  std::shared_ptr<EventLoopThreadPool> threadPool()
+  { return threadPool_; }
+
+  /// See UdpSocket. Must be called before @c start
+  void setMaxDatagramSize(size_t size)
+  { maxDatagramSize_ = size; }
+  void setGso(bool on)
+  { gso_ = on; }
+  void setGro(bool on)
+  { gro_ = on; }
+
+  /// Called in the loop of the receiving socket, reply with it.
+  /// Not thread safe.
+  void setDatagramCallback(const UdpSocket::DatagramCallback& cb)
+  { datagramCallback_ = cb; }
+
+  /// Starts the server if it's not listenning.
+  ///
+  /// It's harmless to call it multiple times.
+  /// Thread safe.
+  void start();
+
+  /// Sockets of all loops, valid after calling start().
+  const std::vector<std::unique_ptr<UdpSocket>>& sockets() const
+  { return sockets_; }
+
+ private:
+  EventLoop* loop_;  // the base loop
+  const string name_;
+  const InetAddress listenAddr_;
+  std::shared_ptr<EventLoopThreadPool> threadPool_;
+  UdpSocket::DatagramCallback datagramCallback_;
+  ThreadInitCallback threadInitCallback_;
+  AtomicInt32 started_;
+  size_t maxDatagramSize_;
+  bool gso_;
+  bool gro_;
+  std::vector<std::unique_ptr<UdpSocket>> sockets_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_UDPSERVER_H
@@ -0,0 +1,472 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/UdpSocket.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/Socket.h>
+#include <muduo/net/SocketsOps.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+// UDP_MAX_SEGMENTS of older kernels
+const size_t kMaxSegments = 64;
+const size_t kMaxGsoBytes = 65507;
+// per receive batch
+const size_t kReceiveStorageSize = 256 * 1024;
+const size_t kControlSize = CMSG_SPACE(sizeof(int));
+
+bool sameAddress(const struct sockaddr_in6& lhs, const struct sockaddr_in6& rhs)
+{
+  return memcmp(&lhs, &rhs, sizeof lhs) == 0;
+}
+
+}  // namespace
+
+const int UdpSocket::kMaxBatch;
+const size_t UdpSocket::kDefaultMaxDatagramSize;
+
+// Outgoing datagrams of one loop iteration, packed in one storage,
+// which keeps its capacity, so queueing costs no malloc once warmed.
+struct UdpSocket::SendQueue : noncopyable
+{
+  struct Datagram
+  {
+    size_t offset;
+    size_t len;
+    struct sockaddr_in6 peer;
+  };
+
+  explicit SendQueue(int fd)
+    : sockfd(fd), connected(false), gso(false), flushQueued(false),
+      numSent(0), numDropped(0)
+  {
+  }
+
+  void append(const struct sockaddr_in6& peer, const void* data, size_t len)
+  {
+    Datagram d;
+    d.offset = storage.size();
+    d.len = len;
+    d.peer = peer;
+    datagrams.push_back(d);
+    const char* p = static_cast<const char*>(data);
+    storage.insert(storage.end(), p, p + len);
+  }
+
+  size_t size() const { return datagrams.size(); }
+
+  // consecutive datagrams of datagrams[first], which go in one message
+  size_t gsoGroup(size_t first) const
+  {
+    size_t segment = datagrams[first].len;
+    size_t bytes = segment;
+    size_t last = first + 1;
+    while (last < datagrams.size()
+           && last - first < kMaxSegments
+           && datagrams[last - 1].len == segment
+           && datagrams[last].len <= segment
+           && datagrams[last].len > 0
+           && bytes + datagrams[last].len <= kMaxGsoBytes
+           && sameAddress(datagrams[last].peer, datagrams[first].peer))
+    {
+      bytes += datagrams[last].len;
+      ++last;
+    }
+    return last - first;
+  }
+
+  void flush()
+  {
+    flushQueued = false;
+    if (datagrams.empty() || sockfd < 0)
+    {
+      return;
+    }
+    msgs.resize(datagrams.size());
+    iovecs.resize(datagrams.size());
+    controls.resize(datagrams.size() * CMSG_SPACE(sizeof(uint16_t)));
+    std::fill(controls.begin(), controls.end(), 0);
+    // how many datagrams each message carries
+    counts.resize(datagrams.size());
+
+    size_t numMsgs = 0;
+    for (size_t i = 0; i < datagrams.size(); ++numMsgs)
+    {
+      const Datagram& d = datagrams[i];
+      size_t n = gso ? gsoGroup(i) : 1;
+      size_t bytes = 0;
+      for (size_t j = i; j < i + n; ++j)
+      {
+        bytes += datagrams[j].len;
+      }
+      struct msghdr& hdr = msgs[numMsgs].msg_hdr;
+      memZero(&hdr, sizeof hdr);
+      iovecs[numMsgs].iov_base = &storage[d.offset];
+      iovecs[numMsgs].iov_len = bytes;
+      hdr.msg_iov = &iovecs[numMsgs];
+      hdr.msg_iovlen = 1;
+      if (!connected)
+      {
+        hdr.msg_name = const_cast<struct sockaddr_in6*>(&d.peer);
+        hdr.msg_namelen = static_cast<socklen_t>(sizeof d.peer);
+      }
+      if (n > 1)
+      {
+        hdr.msg_control = &controls[numMsgs * CMSG_SPACE(sizeof(uint16_t))];
+        hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+        cm->cmsg_level = IPPROTO_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        uint16_t segment = static_cast<uint16_t>(d.len);
+        memcpy(CMSG_DATA(cm), &segment, sizeof segment);
+      }
+      counts[numMsgs] = n;
+      i += n;
+    }
+
+    size_t sent = 0;
+    while (sent < numMsgs)
+    {
+      int n = ::sendmmsg(sockfd, &msgs[sent], static_cast<unsigned>(numMsgs - sent), 0);
+      if (n > 0)
+      {
+        for (int k = 0; k < n; ++k)
+        {
+          numSent += counts[sent + k];
+        }
+        sent += n;
+      }
+      else if (errno == EAGAIN || errno == ENOBUFS)
+      {
+        // no room in the socket, UDP doesn't wait
+        for (; sent < numMsgs; ++sent)
+        {
+          numDropped += counts[sent];
+        }
+      }
+      else
+      {
+        // fails the first message, maybe too large, or refused by the peer
+        LOG_SYSERR << "UdpSocket sendmmsg";
+        numDropped += counts[sent];
+        ++sent;
+      }
+    }
+    datagrams.clear();
+    storage.clear();
+  }
+
+  int sockfd;  // -1 after the socket is gone
+  bool connected;
+  bool gso;
+  bool flushQueued;
+  int64_t numSent;
+  int64_t numDropped;
+  std::vector<Datagram> datagrams;
+  std::vector<char> storage;
+  std::vector<struct mmsghdr> msgs;
+  std::vector<struct iovec> iovecs;
+  std::vector<char> controls;
+  std::vector<size_t> counts;
+};
+
+UdpSocket::UdpSocket(EventLoop* loop, const string& nameArg, sa_family_t family)
+  : loop_(CHECK_NOTNULL(loop)),
+    name_(nameArg),
+    socket_(new Socket(sockets::createUdpNonblockingOrDie(family))),
+    channel_(new Channel(loop, socket_->fd())),
+    started_(false),
+    connected_(false),
+    gro_(false),
+    maxDatagramSize_(kDefaultMaxDatagramSize),
+    batchSize_(0),
+    slotSize_(0),
+    numReceived_(0),
+    sendQueue_(new SendQueue(socket_->fd()))
+{
+  channel_->setReadCallback(
+      std::bind(&UdpSocket::handleRead, this, _1));
+  channel_->setErrorCallback(
+      std::bind(&UdpSocket::handleError, this));
+}
+
+UdpSocket::~UdpSocket()
+{
+  if (started_)
+  {
+    loop_->assertInLoopThread();
+    sendQueue_->flush();
+    channel_->disableAll();
+    channel_->remove();
+  }
+  sendQueue_->sockfd = -1;
+}
+
+void UdpSocket::bindAddress(const InetAddress& localAddr, bool reusePort)
+{
+  assert(!started_);
+  socket_->setReuseAddr(true);
+  socket_->setReusePort(reusePort);
+  socket_->bindAddress(localAddr);
+}
+
+void UdpSocket::connect(const InetAddress& peerAddr)
+{
+  assert(!started_);
+  if (sockets::connect(socket_->fd(), peerAddr.getSockAddr()) < 0)
+  {
+    LOG_SYSFATAL << "UdpSocket::connect";
+  }
+  connected_ = true;
+  sendQueue_->connected = true;
+}
+
+void UdpSocket::setMaxDatagramSize(size_t size)
+{
+  assert(!started_);
+  assert(size > 0);
+  maxDatagramSize_ = size;
+}
+
+bool UdpSocket::setGso(bool on)
+{
+  if (on)
+  {
+    // probes for support, the segment size goes with each message
+    int optval = 0;
+    if (::setsockopt(socket_->fd(), IPPROTO_UDP, UDP_SEGMENT,
+                     &optval, static_cast<socklen_t>(sizeof optval)) < 0)
+    {
+      LOG_SYSERR << "UDP_SEGMENT is not supported";
+      return false;
+    }
+  }
+  sendQueue_->gso = on;
+  return true;
+}
+
+bool UdpSocket::setGro(bool on)
+{
+  assert(!started_);
+  int optval = on ? 1 : 0;
+  if (::setsockopt(socket_->fd(), IPPROTO_UDP, UDP_GRO,
+                   &optval, static_cast<socklen_t>(sizeof optval)) < 0)
+  {
+    LOG_SYSERR << "UDP_GRO is not supported";
+    return false;
+  }
+  gro_ = on;
+  return true;
+}
+
+int UdpSocket::fd() const
+{
+  return socket_->fd();
+}
+
+InetAddress UdpSocket::localAddress() const
+{
+  return InetAddress(sockets::getLocalAddr(socket_->fd()));
+}
+
+int64_t UdpSocket::numSent() const
+{
+  return sendQueue_->numSent;
+}
+
+int64_t UdpSocket::numDropped() const
+{
+  return sendQueue_->numDropped;
+}
+
+void UdpSocket::start()
+{
+  loop_->runInLoop(std::bind(&UdpSocket::startInLoop, this));
+}
+
+void UdpSocket::startInLoop()
+{
+  loop_->assertInLoopThread();
+  if (!started_)
+  {
+    started_ = true;
+    allocateReceiveBatch();
+    channel_->enableReading();
+  }
+}
+
+void UdpSocket::allocateReceiveBatch()
+{
+  // a coalesced datagram takes up to 64KiB
+  slotSize_ = gro_ ? 65535 : maxDatagramSize_;
+  batchSize_ = static_cast<int>(std::max<size_t>(
+      1, std::min<size_t>(kMaxBatch, kReceiveStorageSize / slotSize_)));
+  size_t n = static_cast<size_t>(batchSize_);
+  recvStorage_.resize(n * slotSize_);
+  recvMsgs_.resize(n);
+  recvIovecs_.resize(n);
+  recvAddrs_.resize(n);
+  recvControl_.resize(n * kControlSize);
+  for (size_t i = 0; i < n; ++i)
+  {
+    recvIovecs_[i].iov_base = &recvStorage_[i * slotSize_];
+    recvIovecs_[i].iov_len = slotSize_;
+  }
+}
+
+void UdpSocket::prepareReceiveBatch()
+{
+  // the kernel updates lengths of the last batch
+  for (int i = 0; i < batchSize_; ++i)
+  {
+    struct msghdr& hdr = recvMsgs_[i].msg_hdr;
+    memZero(&hdr, sizeof hdr);
+    hdr.msg_name = &recvAddrs_[i];
+    hdr.msg_namelen = static_cast<socklen_t>(sizeof recvAddrs_[i]);
+    hdr.msg_iov = &recvIovecs_[i];
+    hdr.msg_iovlen = 1;
+    if (gro_)
+    {
+      hdr.msg_control = &recvControl_[i * kControlSize];
+      hdr.msg_controllen = kControlSize;
+    }
+  }
+}
+
+void UdpSocket::handleRead(Timestamp receiveTime)
+{
+  loop_->assertInLoopThread();
+  prepareReceiveBatch();
+  int n = ::recvmmsg(socket_->fd(), &recvMsgs_[0], static_cast<unsigned>(batchSize_), 0, NULL);
+  if (n < 0)
+  {
+    if (errno != EAGAIN)
+    {
+      LOG_SYSERR << "UdpSocket::handleRead";
+    }
+    return;
+  }
+
+  for (int i = 0; i < n; ++i)
+  {
+    const struct msghdr& hdr = recvMsgs_[i].msg_hdr;
+    size_t len = recvMsgs_[i].msg_len;
+    if (hdr.msg_flags & MSG_TRUNC)
+    {
+      LOG_WARN << "UdpSocket::handleRead [" << name_ << "] - datagram truncated to "
+               << len << " bytes, see setMaxDatagramSize()";
+    }
+    size_t segment = len;
+    if (gro_)
+    {
+      for (struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm != NULL;
+           cm = CMSG_NXTHDR(const_cast<struct msghdr*>(&hdr), cm))
+      {
+        if (cm->cmsg_level == IPPROTO_UDP && cm->cmsg_type == UDP_GRO)
+        {
+          int gsoSize = 0;
+          memcpy(&gsoSize, CMSG_DATA(cm), sizeof gsoSize);
+          if (gsoSize > 0)
+          {
+            segment = static_cast<size_t>(gsoSize);
+          }
+        }
+      }
+    }
+
+    InetAddress peerAddr(recvAddrs_[i]);
+    const char* data = static_cast<const char*>(recvIovecs_[i].iov_base);
+    size_t offset = 0;
+    do
+    {
+      size_t size = std::min(segment, len - offset);
+      ++numReceived_;
+      if (datagramCallback_)
+      {
+        datagramCallback_(this, peerAddr,
+                          StringPiece(data + offset, static_cast<int>(size)),
+                          receiveTime);
+      }
+      offset += size;
+    } while (offset < len);
+  }
+}
+
+void UdpSocket::handleError()
+{
+  // ICMP errors of a connected socket, reading SO_ERROR clears it
+  int err = sockets::getSocketError(socket_->fd());
+  LOG_ERROR << "UdpSocket::handleError [" << name_
+            << "] - SO_ERROR = " << err << " " << strerror_tl(err);
+}
+
+void UdpSocket::send(const InetAddress& peerAddr, const StringPiece& datagram)
+{
+  send(peerAddr, datagram.data(), datagram.size());
+}
+
+void UdpSocket::send(const StringPiece& datagram)
+{
+  assert(connected_);
+  send(InetAddress(), datagram.data(), datagram.size());
+}
+
+void UdpSocket::send(const InetAddress& peerAddr, const void* datagram, size_t len)
+{
+  if (loop_->isInLoopThread())
+  {
+    sendInLoop(peerAddr, datagram, len);
+  }
+  else
+  {
+    void (UdpSocket::*fp)(const InetAddress&, const string&) = &UdpSocket::sendStringInLoop;
+    loop_->runInLoop(
+        std::bind(fp, this, peerAddr, string(static_cast<const char*>(datagram), len)));
+  }
+}
+
+void UdpSocket::sendStringInLoop(const InetAddress& peerAddr, const string& datagram)
+{
+  sendInLoop(peerAddr, datagram.data(), datagram.size());
+}
+
+void UdpSocket::sendInLoop(const InetAddress& peerAddr, const void* datagram, size_t len)
+{
+  loop_->assertInLoopThread();
+  struct sockaddr_in6 peer;
+  memcpy(&peer, peerAddr.getSockAddr(), sizeof peer);
+  sendQueue_->append(peer, datagram, len);
+  if (sendQueue_->size() >= static_cast<size_t>(kMaxBatch))
+  {
+    sendQueue_->flush();
+  }
+  else if (!sendQueue_->flushQueued)
+  {
+    // after the events of this round, typically the received batch
+    sendQueue_->flushQueued = true;
+    std::shared_ptr<SendQueue> queue(sendQueue_);
+    loop_->queueInLoop([queue] { queue->flush(); });
+  }
+}
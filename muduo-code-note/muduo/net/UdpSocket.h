@@ -0,0 +1,131 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#ifndef MUDUO_NET_UDPSOCKET_H
+#define MUDUO_NET_UDPSOCKET_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/StringPiece.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/base/Types.h>
+#include <muduo/net/InetAddress.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace muduo
+{
+namespace net
+{
+
+class Channel;
+class EventLoop;
+class Socket;
+
+///
+/// Non-blocking UDP socket, in an EventLoop.
+///
+/// Datagrams are received in batches with recvmmsg(2), into storage
+/// owned by the socket and reused for every batch, so the datagram
+/// passed to the callback is valid only during the call.
+///
+/// Datagrams sent in the loop thread are copied into a send queue,
+/// which is flushed with sendmmsg(2) when the loop has handled this
+/// round of events, or when it holds kMaxBatch datagrams. Replies sent
+/// from the callback go out in one call for the whole received batch.
+/// UDP doesn't wait for the socket to drain, what the kernel doesn't
+/// take is dropped and counted.
+///
+/// setGso() sends consecutive queued datagrams of the same size to the
+/// same peer as one message with UDP_SEGMENT, the kernel (or the NIC)
+/// splits it, each segment must fit in the path MTU.
+/// setGro() lets the kernel coalesce received datagrams with UDP_GRO,
+/// they are split again before the callback.
+class UdpSocket : noncopyable
+{
+ public:
+  typedef std::function<void (UdpSocket*,
+                              const InetAddress& peerAddr,
+                              StringPiece datagram,
+                              Timestamp receiveTime)> DatagramCallback;
+
+  static const int kMaxBatch = 64;
+  static const size_t kDefaultMaxDatagramSize = 4096;
+
+  UdpSocket(EventLoop* loop, const string& name, sa_family_t family = AF_INET);
+  /// Must be called in the loop thread if started.
+  ~UdpSocket();
+
+  /// Must be called before @c start
+  void bindAddress(const InetAddress& localAddr, bool reusePort = false);
+  /// Fixes the peer, for send(StringPiece), the kernel drops datagrams
+  /// from others. Must be called before @c start
+  void connect(const InetAddress& peerAddr);
+  void setDatagramCallback(const DatagramCallback& cb)
+  { datagramCallback_ = cb; }
+  /// Larger datagrams are truncated. Must be called before @c start
+  void setMaxDatagramSize(size_t size);
+  /// @return false if the kernel doesn't support it
+  bool setGso(bool on);
+  bool setGro(bool on);
+
+  /// Starts receiving, thread safe.
+  void start();
+
+  /// Thread safe, data is copied.
+  void send(const InetAddress& peerAddr, const StringPiece& datagram);
+  void send(const InetAddress& peerAddr, const void* datagram, size_t len);
+  /// To the connected peer, thread safe.
+  void send(const StringPiece& datagram);
+
+  EventLoop* getLoop() const { return loop_; }
+  const string& name() const { return name_; }
+  int fd() const;
+  InetAddress localAddress() const;
+
+  // statistics, maintained in the loop thread
+  int64_t numReceived() const { return numReceived_; }
+  int64_t numSent() const;
+  int64_t numDropped() const;
+
+ private:
+  struct SendQueue;
+
+  void startInLoop();
+  void handleRead(Timestamp receiveTime);
+  void handleError();
+  void sendInLoop(const InetAddress& peerAddr, const void* datagram, size_t len);
+  void sendStringInLoop(const InetAddress& peerAddr, const string& datagram);
+  void allocateReceiveBatch();
+  void prepareReceiveBatch();
+
+  EventLoop* loop_;
+  const string name_;
+  std::unique_ptr<Socket> socket_;
+  std::unique_ptr<Channel> channel_;
+  bool started_;
+  bool connected_;
+  bool gro_;
+  size_t maxDatagramSize_;
+  DatagramCallback datagramCallback_;
+  // receive batch, allocated by start()
+  int batchSize_;
+  size_t slotSize_;
+  std::vector<char> recvStorage_;
+  std::vector<struct mmsghdr> recvMsgs_;
+  std::vector<struct iovec> recvIovecs_;
+  std::vector<struct sockaddr_in6> recvAddrs_;
+  std::vector<char> recvControl_;
+  int64_t numReceived_;
+  // shared with the flush functor, which may run after we are gone
+  std::shared_ptr<SendQueue> sendQueue_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_UDPSOCKET_H
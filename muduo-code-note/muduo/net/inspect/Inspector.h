@@ -22,6 +22,8 @@ namespace muduo
 namespace net
 {
 
+class EventLoop;
+class LoopInspector;
 class ProcessInspector;
 class PerformanceInspector;
 class SystemInspector;
@@ -45,6 +47,11 @@ class Inspector : noncopyable
            const string& help);
   void remove(const string& module, const string& command);
 
+  /// Shows statistics of @c loop under /loop/, the loop must be
+  /// removed before it's destructed.
+  void addEventLoop(const string& name, EventLoop* loop);
+  void removeEventLoop(const string& name);
+
  private:
   typedef std::map<string, Callback> CommandList;
   typedef std::map<string, string> HelpList;
@@ -56,6 +63,7 @@ class Inspector : noncopyable
   std::unique_ptr<ProcessInspector> processInspector_;
   std::unique_ptr<PerformanceInspector> performanceInspector_;
   std::unique_ptr<SystemInspector> systemInspector_;
+  std::unique_ptr<LoopInspector> loopInspector_;
   MutexLock mutex_;
   std::map<string, CommandList> modules_ GUARDED_BY(mutex_);
   std::map<string, HelpList> helps_ GUARDED_BY(mutex_);
@@ -0,0 +1,194 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/inspect/LoopInspector.h>
+
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/net/BufferPool.h>
+#include <muduo/net/ConnectionStats.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/LoopStats.h>
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void LoopInspector::registerCommands(Inspector* ins)
+{
+  ins->add("loop", "pool", std::bind(&LoopInspector::pool, this, _1, _2),
+           "print input buffer pool of each loop");
+  ins->add("loop", "load", std::bind(&LoopInspector::load, this, _1, _2),
+           "print connections, pending functors, busy and spin ratio of each loop");
+  ins->add("loop", "stats", std::bind(&LoopInspector::stats, this, _1, _2),
+           "print poll, handler, queue delay and timer lateness histograms of each loop,"
+           " /loop/stats/<name>/reset starts them over");
+  ins->add("loop", "connections", std::bind(&LoopInspector::connections, this, _1, _2),
+           "print traffic of live and closed connections of each loop");
+  ins->add("loop", "top", std::bind(&LoopInspector::top, this, _1, _2),
+           "print connections of all loops with the largest backlog, bytes or age,"
+           " /loop/top/[backlog|bytes|age]/[N]");
+}
+
+void LoopInspector::addLoop(const string& name, EventLoop* loop)
+{
+  MutexLockGuard lock(mutex_);
+  loops_[name] = loop;
+}
+
+void LoopInspector::removeLoop(const string& name)
+{
+  MutexLockGuard lock(mutex_);
+  loops_.erase(name);
+}
+
+LoopInspector::LoopMap LoopInspector::selectLoops(const Inspector::ArgList& args)
+{
+  MutexLockGuard lock(mutex_);
+  if (args.empty())
+  {
+    return loops_;
+  }
+  LoopMap result;
+  LoopMap::const_iterator it = loops_.find(args[0]);
+  if (it != loops_.end())
+  {
+    result.insert(*it);
+  }
+  return result;
+}
+
+string LoopInspector::pool(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  string result;
+  for (const auto& item : selectLoops(args))
+  {
+    result += item.first;
+    result += " ";
+    result += item.second->bufferPool()->stats();
+    result += "\n";
+  }
+  return result;
+}
+
+string LoopInspector::load(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  string result;
+  for (const auto& item : selectLoops(args))
+  {
+    char buf[128];
+    snprintf(buf, sizeof buf, " connections %d pending %zd busy %.3f spin %.3f\n",
+             item.second->numConnections(),
+             item.second->queueSize(),
+             item.second->busyRatio(),
+             item.second->spinRatio());
+    result += item.first;
+    result += buf;
+  }
+  return result;
+}
+
+string LoopInspector::stats(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  bool reset = args.size() > 1 && args[1] == "reset";
+  string result;
+  for (const auto& item : selectLoops(args))
+  {
+    result += item.first;
+    result += "\n";
+    result += item.second->stats().toString();
+    if (reset)
+    {
+      // record() is not atomic, reset in the recording thread
+      EventLoop* loop = item.second;
+      loop->runInLoop([loop] { loop->stats().reset(); });
+    }
+  }
+  return result;
+}
+
+string LoopInspector::connections(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  string result;
+  for (const auto& item : selectLoops(args))
+  {
+    result += item.first;
+    result += " ";
+    result += item.second->connectionStats().toString();
+    result += "\n";
+  }
+  return result;
+}
+
+namespace
+{
+
+struct ConnectionRow
+{
+  ConnectionStatsPtr stats;
+  int64_t key;
+};
+
+bool largerKey(const ConnectionRow& lhs, const ConnectionRow& rhs)
+{
+  return lhs.key > rhs.key;
+}
+
+}  // namespace
+
+string LoopInspector::top(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  string by = args.empty() ? "backlog" : args[0];
+  if (by != "backlog" && by != "bytes" && by != "age")
+  {
+    return "unknown key " + by + ", backlog, bytes or age\n";
+  }
+  size_t n = 10;
+  if (args.size() > 1)
+  {
+    int value = atoi(args[1].c_str());
+    if (value > 0)
+    {
+      n = static_cast<size_t>(value);
+    }
+  }
+
+  // the IO threads keep running, counters are read as they are.
+  MonotonicTime now = MonotonicTime::now();
+  std::vector<ConnectionRow> rows;
+  for (const auto& item : selectLoops(Inspector::ArgList()))
+  {
+    for (const ConnectionStatsPtr& stats : item.second->connectionStats().snapshot())
+    {
+      ConnectionRow row;
+      row.stats = stats;
+      if (by == "backlog")
+      {
+        row.key = stats->backlog.load(std::memory_order_relaxed);
+      }
+      else if (by == "bytes")
+      {
+        row.key = stats->bytesReceived.load(std::memory_order_relaxed)
+                + stats->bytesSent.load(std::memory_order_relaxed);
+      }
+      else
+      {
+        row.key = stats->ageMicroSeconds(now);
+      }
+      rows.push_back(row);
+    }
+  }
+  n = std::min(n, rows.size());
+  std::partial_sort(rows.begin(), rows.begin() + static_cast<ptrdiff_t>(n), rows.end(), largerKey);
+
+  string result;
+  for (size_t i = 0; i < n; ++i)
+  {
+    result += rows[i].stats->toString(now);
+    result += "\n";
+  }
+  return result;
+}
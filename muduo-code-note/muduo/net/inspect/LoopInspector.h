@@ -0,0 +1,44 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_INSPECT_LOOPINSPECTOR_H
+#define MUDUO_NET_INSPECT_LOOPINSPECTOR_H
+
+#include <muduo/net/inspect/Inspector.h>
+
+namespace muduo
+{
+namespace net
+{
+
+// Per EventLoop statistics, /loop/<command>/[loop name]
+class LoopInspector : noncopyable
+{
+ public:
+  void registerCommands(Inspector* ins);
+
+  void addLoop(const string& name, EventLoop* loop);
+  void removeLoop(const string& name);
+
+  string pool(HttpRequest::Method, const Inspector::ArgList&);
+  string load(HttpRequest::Method, const Inspector::ArgList&);
+  string stats(HttpRequest::Method, const Inspector::ArgList&);
+  string connections(HttpRequest::Method, const Inspector::ArgList&);
+  string top(HttpRequest::Method, const Inspector::ArgList&);
+
+ private:
+  typedef std::map<string, EventLoop*> LoopMap;
+
+  // loops named by args[0], or all loops.
+  LoopMap selectLoops(const Inspector::ArgList& args);
+
+  MutexLock mutex_;
+  LoopMap loops_ GUARDED_BY(mutex_);
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_INSPECT_LOOPINSPECTOR_H
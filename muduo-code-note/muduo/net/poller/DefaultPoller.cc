@@ -9,6 +9,7 @@
 #include <muduo/net/Poller.h>
 #include <muduo/net/poller/PollPoller.h>
 #include <muduo/net/poller/EPollPoller.h>
+#include <muduo/net/poller/UringPoller.h>
 
 #include <stdlib.h>
 
@@ -20,6 +21,10 @@ Poller* Poller::newDefaultPoller(EventLoop* loop)
   {
     return new PollPoller(loop);
   }
+  else if (::getenv("MUDUO_USE_URING"))
+  {
+    return new UringPoller(loop);
+  }
   else
   {
     return new EPollPoller(loop);
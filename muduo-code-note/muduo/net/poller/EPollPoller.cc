@@ -34,6 +34,12 @@ namespace
 const int kNew = -1;
 const int kAdded = 1;
 const int kDeleted = 2;
+
+// epoll_event.data: | generation:32 | fd:32 |, see ChannelTable
+uint64_t makeData(int fd, uint32_t generation)
+{
+  return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(fd);
+}
 }
 
 EPollPoller::EPollPoller(EventLoop* loop)
@@ -52,7 +58,7 @@ EPollPoller::~EPollPoller()
   ::close(epollfd_);
 }
 
-Timestamp EPollPoller::poll(int timeoutMs, ChannelList* activeChannels)
+MonotonicTime EPollPoller::poll(int timeoutMs, ChannelList* activeChannels)
 {
   LOG_TRACE << "fd total count " << channels_.size();
   int numEvents = ::epoll_wait(epollfd_,
@@ -60,7 +66,7 @@ Timestamp EPollPoller::poll(int timeoutMs, ChannelList* activeChannels)
                                static_cast<int>(events_.size()),
                                timeoutMs);
   int savedErrno = errno;
-  Timestamp now(Timestamp::now());
+  MonotonicTime now(MonotonicTime::now());
   if (numEvents > 0)
   {
     LOG_TRACE << numEvents << " events happened";
@@ -92,13 +98,15 @@ void EPollPoller::fillActiveChannels(int numEvents,
   assert(implicit_cast<size_t>(numEvents) <= events_.size());
   for (int i = 0; i < numEvents; ++i)
   {
-    Channel* channel = static_cast<Channel*>(events_[i].data.ptr);
-#ifndef NDEBUG
-    int fd = channel->fd();
-    ChannelMap::const_iterator it = channels_.find(fd);
-    assert(it != channels_.end());
-    assert(it->second == channel);
-#endif
+    uint64_t data = events_[i].data.u64;
+    int fd = static_cast<int>(data & 0xFFFFFFFF);
+    Channel* channel = channels_.find(fd, static_cast<uint32_t>(data >> 32));
+    if (channel == NULL)
+    {
+      LOG_TRACE << "fd = " << fd << " stale event dropped";
+      continue;
+    }
+    assert(channel->fd() == fd);
     channel->set_revents(events_[i].events);
     activeChannels->push_back(channel);
   }
@@ -116,13 +124,12 @@ void EPollPoller::updateChannel(Channel* channel)
     int fd = channel->fd();
     if (index == kNew)
     {
-      assert(channels_.find(fd) == channels_.end());
-      channels_[fd] = channel;
+      assert(channels_.find(fd) == NULL);
+      channels_.add(fd, channel);
     }
     else // index == kDeleted
     {
-      assert(channels_.find(fd) != channels_.end());
-      assert(channels_[fd] == channel);
+      assert(channels_.contains(fd, channel));
     }
 
     channel->set_index(kAdded);
@@ -133,8 +140,7 @@ void EPollPoller::updateChannel(Channel* channel)
     // update existing one with EPOLL_CTL_MOD/DEL
     int fd = channel->fd();
     (void)fd;
-    assert(channels_.find(fd) != channels_.end());
-    assert(channels_[fd] == channel);
+    assert(channels_.contains(fd, channel));
     assert(index == kAdded);
     if (channel->isNoneEvent())
     {
@@ -153,19 +159,16 @@ void EPollPoller::removeChannel(Channel* channel)
   Poller::assertInLoopThread();
   int fd = channel->fd();
   LOG_TRACE << "fd = " << fd;
-  assert(channels_.find(fd) != channels_.end());
-  assert(channels_[fd] == channel);
+  assert(channels_.contains(fd, channel));
   assert(channel->isNoneEvent());
   int index = channel->index();
   assert(index == kAdded || index == kDeleted);
-  size_t n = channels_.erase(fd);
-  (void)n;
-  assert(n == 1);
 
   if (index == kAdded)
   {
     update(EPOLL_CTL_DEL, channel);
   }
+  channels_.remove(fd);
   channel->set_index(kNew);
 }
 
@@ -174,8 +177,12 @@ void EPollPoller::update(int operation, Channel* channel)
   struct epoll_event event;
   memZero(&event, sizeof event);
   event.events = channel->events();
-  event.data.ptr = channel;
+  if (channel->isEdgeTriggered())
+  {
+    event.events |= EPOLLET;
+  }
   int fd = channel->fd();
+  event.data.u64 = makeData(fd, channels_.generation(fd));
   LOG_TRACE << "epoll_ctl op = " << operationToString(operation)
     << " fd = " << fd << " event = { " << channel->eventsToString() << " }";
   if (::epoll_ctl(epollfd_, operation, fd, &event) < 0)
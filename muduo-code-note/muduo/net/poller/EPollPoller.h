@@ -31,9 +31,10 @@ class EPollPoller : public Poller
   EPollPoller(EventLoop* loop);
   ~EPollPoller() override;
 
-  Timestamp poll(int timeoutMs, ChannelList* activeChannels) override;
+  MonotonicTime poll(int timeoutMs, ChannelList* activeChannels) override;
   void updateChannel(Channel* channel) override;
   void removeChannel(Channel* channel) override;
+  bool supportsEdgeTriggered() const override { return true; }
 
  private:
   static const int kInitEventListSize = 16;
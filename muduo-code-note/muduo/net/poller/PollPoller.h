@@ -32,7 +32,7 @@ class PollPoller : public Poller
   PollPoller(EventLoop* loop);
   ~PollPoller() override;
 
-  Timestamp poll(int timeoutMs, ChannelList* activeChannels) override;
+  MonotonicTime poll(int timeoutMs, ChannelList* activeChannels) override;
   void updateChannel(Channel* channel) override;
   void removeChannel(Channel* channel) override;
 
@@ -0,0 +1,444 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/poller/UringPoller.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/Channel.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+// user_data of a sqe: | tag:8 | seq:24 | fd:32 |
+const uint64_t kPollTag = 1;
+const uint64_t kRemoveTag = 2;
+// user_data of an operation: | tag:8 | Operation*:56 |
+const uint64_t kOperationTag = 3;
+
+uint64_t makeUserData(uint64_t tag, uint32_t seq, int fd)
+{
+  return (tag << 56) | (static_cast<uint64_t>(seq & 0xFFFFFF) << 32)
+      | static_cast<uint32_t>(fd);
+}
+
+uint64_t tagOf(uint64_t userData)
+{
+  return userData >> 56;
+}
+
+int fdOf(uint64_t userData)
+{
+  return static_cast<int>(static_cast<uint32_t>(userData));
+}
+
+int sysSetup(unsigned entries, struct io_uring_params* p)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sysEnter(int ringfd, unsigned toSubmit, unsigned minComplete,
+             unsigned flags, const void* arg, size_t argSize)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ringfd, toSubmit,
+                                    minComplete, flags, arg, argSize));
+}
+
+template<typename T>
+T* ringField(void* ring, uint32_t offset)
+{
+  return static_cast<T*>(static_cast<void*>(static_cast<char*>(ring) + offset));
+}
+
+}  // namespace
+
+UringPoller::UringPoller(EventLoop* loop)
+  : Poller(loop),
+    ringfd_(-1),
+    features_(0),
+    nextSeq_(0),
+    sqRingPtr_(MAP_FAILED),
+    sqRingSize_(0),
+    cqRingPtr_(MAP_FAILED),
+    cqRingSize_(0),
+    sqes_(NULL),
+    sqesSize_(0),
+    sqHead_(NULL),
+    sqTail_(NULL),
+    sqMask_(0),
+    sqArray_(NULL),
+    sqLocalTail_(0),
+    cqHead_(NULL),
+    cqTail_(NULL),
+    cqMask_(0),
+    cqes_(NULL)
+{
+  inflight_.result = 0;
+  inflight_.prev = inflight_.next = &inflight_;
+  setupRing();
+}
+
+UringPoller::~UringPoller()
+{
+  // callbacks of unfinished operations are dropped without being called.
+  while (inflight_.next != &inflight_)
+  {
+    Operation* op = inflight_.next;
+    unlinkOperation(op);
+    delete op;
+  }
+  if (sqes_)
+  {
+    ::munmap(sqes_, sqesSize_);
+  }
+  if (cqRingPtr_ != MAP_FAILED && cqRingPtr_ != sqRingPtr_)
+  {
+    ::munmap(cqRingPtr_, cqRingSize_);
+  }
+  if (sqRingPtr_ != MAP_FAILED)
+  {
+    ::munmap(sqRingPtr_, sqRingSize_);
+  }
+  ::close(ringfd_);
+}
+
+void UringPoller::setupRing()
+{
+  struct io_uring_params params;
+  memZero(&params, sizeof params);
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = kRingEntries * 4;
+  ringfd_ = sysSetup(kRingEntries, &params);
+  if (ringfd_ < 0)
+  {
+    LOG_SYSFATAL << "UringPoller::setupRing - io_uring_setup";
+  }
+  features_ = params.features;
+  if (!(features_ & IORING_FEAT_EXT_ARG))
+  {
+    LOG_FATAL << "UringPoller::setupRing - IORING_FEAT_EXT_ARG is not supported";
+  }
+
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (features_ & IORING_FEAT_SINGLE_MMAP)
+  {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+  sqRingPtr_ = ::mmap(NULL, sqRingSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+  if (sqRingPtr_ == MAP_FAILED)
+  {
+    LOG_SYSFATAL << "UringPoller::setupRing - mmap sq ring";
+  }
+  if (features_ & IORING_FEAT_SINGLE_MMAP)
+  {
+    cqRingPtr_ = sqRingPtr_;
+  }
+  else
+  {
+    cqRingPtr_ = ::mmap(NULL, cqRingSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+    if (cqRingPtr_ == MAP_FAILED)
+    {
+      LOG_SYSFATAL << "UringPoller::setupRing - mmap cq ring";
+    }
+  }
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = ::mmap(NULL, sqesSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+  {
+    LOG_SYSFATAL << "UringPoller::setupRing - mmap sqes";
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  sqHead_ = ringField<unsigned>(sqRingPtr_, params.sq_off.head);
+  sqTail_ = ringField<unsigned>(sqRingPtr_, params.sq_off.tail);
+  sqMask_ = *ringField<unsigned>(sqRingPtr_, params.sq_off.ring_mask);
+  sqArray_ = ringField<unsigned>(sqRingPtr_, params.sq_off.array);
+  sqLocalTail_ = *sqTail_;
+  cqHead_ = ringField<unsigned>(cqRingPtr_, params.cq_off.head);
+  cqTail_ = ringField<unsigned>(cqRingPtr_, params.cq_off.tail);
+  cqMask_ = *ringField<unsigned>(cqRingPtr_, params.cq_off.ring_mask);
+  cqes_ = ringField<struct io_uring_cqe>(cqRingPtr_, params.cq_off.cqes);
+}
+
+struct io_uring_sqe* UringPoller::getSqe()
+{
+  unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  if (sqLocalTail_ - head > sqMask_)
+  {
+    // ring is full, hand what we have to the kernel without waiting.
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+    if (sysEnter(ringfd_, sqLocalTail_ - head, 0, 0, NULL, 0) < 0)
+    {
+      LOG_SYSFATAL << "UringPoller::getSqe - io_uring_enter";
+    }
+    head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    assert(sqLocalTail_ - head <= sqMask_);
+  }
+  unsigned index = sqLocalTail_ & sqMask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memZero(sqe, sizeof *sqe);
+  sqArray_[index] = index;
+  ++sqLocalTail_;
+  return sqe;
+}
+
+int UringPoller::submitAndWait(int timeoutMs)
+{
+  __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+
+  struct __kernel_timespec ts;
+  ts.tv_sec = timeoutMs / 1000;
+  ts.tv_nsec = (timeoutMs % 1000) * 1000 * 1000;
+  struct io_uring_getevents_arg arg;
+  memZero(&arg, sizeof arg);
+  arg.sigmask_sz = _NSIG / 8;
+  arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+  unsigned toSubmit = sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  unsigned flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+  return sysEnter(ringfd_, toSubmit, timeoutMs == 0 ? 0 : 1, flags, &arg, sizeof arg);
+}
+
+MonotonicTime UringPoller::poll(int timeoutMs, ChannelList* activeChannels)
+{
+  LOG_TRACE << "fd total count " << channels_.size();
+  rearmFired();
+  int ret = submitAndWait(timeoutMs);
+  int savedErrno = errno;
+  MonotonicTime now(MonotonicTime::now());
+  if (ret < 0 && savedErrno != ETIME && savedErrno != EINTR)
+  {
+    errno = savedErrno;
+    LOG_SYSERR << "UringPoller::poll()";
+  }
+  size_t numBefore = activeChannels->size();
+  fillActiveChannels(activeChannels);
+  if (activeChannels->size() > numBefore)
+  {
+    LOG_TRACE << activeChannels->size() - numBefore << " events happened";
+  }
+  else
+  {
+    LOG_TRACE << "nothing happened";
+  }
+  return now;
+}
+
+void UringPoller::fillActiveChannels(ChannelList* activeChannels)
+{
+  unsigned head = *cqHead_;
+  unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head)
+  {
+    const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+    if (tagOf(cqe.user_data) == kOperationTag)
+    {
+      Operation* op = reinterpret_cast<Operation*>(
+          static_cast<uintptr_t>(cqe.user_data & ((1ULL << 56) - 1)));
+      op->result = cqe.res;
+      completed_.push_back(op);
+      continue;
+    }
+    if (tagOf(cqe.user_data) != kPollTag)
+    {
+      continue;
+    }
+    int fd = fdOf(cqe.user_data);
+    if (static_cast<size_t>(fd) >= entries_.size()
+        || entries_[fd].userData != cqe.user_data)
+    {
+      // completion of a poll we have removed or replaced since.
+      continue;
+    }
+    entries_[fd].userData = 0;
+    fired_.push_back(fd);
+
+    Channel* channel = channels_.find(fd);
+    assert(channel != NULL);
+    if (cqe.res < 0)
+    {
+      errno = -cqe.res;
+      LOG_SYSERR << "UringPoller::fillActiveChannels fd = " << fd;
+      channel->set_revents(POLLERR);
+    }
+    else
+    {
+      channel->set_revents(cqe.res);
+    }
+    activeChannels->push_back(channel);
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+}
+
+void UringPoller::rearmFired()
+{
+  for (int fd : fired_)
+  {
+    Channel* channel = channels_.find(fd);
+    PollEntry& entry = entries_[fd];
+    if (channel != NULL && entry.userData == 0 && !channel->isNoneEvent())
+    {
+      arm(channel, &entry);
+    }
+  }
+  fired_.clear();
+}
+
+UringPoller::PollEntry& UringPoller::entryOf(int fd)
+{
+  assert(fd >= 0);
+  if (static_cast<size_t>(fd) >= entries_.size())
+  {
+    entries_.resize(std::max(static_cast<size_t>(fd) + 1, entries_.size() * 2));
+  }
+  return entries_[fd];
+}
+
+void UringPoller::arm(Channel* channel, PollEntry* entry)
+{
+  assert(entry->userData == 0);
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = channel->fd();
+  sqe->poll32_events = static_cast<uint32_t>(channel->events());
+  entry->userData = makeUserData(kPollTag, ++nextSeq_, channel->fd());
+  entry->events = channel->events();
+  sqe->user_data = entry->userData;
+}
+
+void UringPoller::disarm(PollEntry* entry)
+{
+  if (entry->userData != 0)
+  {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = entry->userData;
+    sqe->user_data = makeUserData(kRemoveTag, 0, fdOf(entry->userData));
+    entry->userData = 0;
+  }
+}
+
+void UringPoller::updateChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd << " events = " << channel->events();
+  if (channel->index() < 0)
+  {
+    // a new one
+    assert(channels_.find(fd) == NULL);
+    channels_.add(fd, channel);
+    PollEntry& entry = entryOf(fd);
+    assert(entry.userData == 0);
+    entry.events = 0;
+    channel->set_index(1);
+    if (!channel->isNoneEvent())
+    {
+      arm(channel, &entry);
+    }
+  }
+  else
+  {
+    // update existing one
+    assert(channels_.contains(fd, channel));
+    PollEntry& entry = entries_[fd];
+    if (entry.userData != 0 && entry.events == channel->events())
+    {
+      return;
+    }
+    disarm(&entry);
+    if (!channel->isNoneEvent())
+    {
+      arm(channel, &entry);
+    }
+  }
+}
+
+void UringPoller::removeChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd;
+  assert(channels_.contains(fd, channel));
+  assert(channel->isNoneEvent());
+  disarm(&entries_[fd]);
+  channels_.remove(fd);
+  channel->set_index(-1);
+}
+
+UringPoller::Operation* UringPoller::newOperation(EventLoop::CompletionCallback&& cb)
+{
+  Operation* op = new Operation;
+  op->callback = std::move(cb);
+  op->result = 0;
+  op->prev = &inflight_;
+  op->next = inflight_.next;
+  inflight_.next->prev = op;
+  inflight_.next = op;
+  return op;
+}
+
+void UringPoller::unlinkOperation(Operation* op)
+{
+  op->prev->next = op->next;
+  op->next->prev = op->prev;
+  op->prev = op->next = NULL;
+}
+
+void UringPoller::submitRead(int fd, void* buf, size_t len,
+                             EventLoop::CompletionCallback cb)
+{
+  Poller::assertInLoopThread();
+  Operation* op = newOperation(std::move(cb));
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(buf);
+  sqe->len = static_cast<uint32_t>(len);
+  sqe->user_data = (kOperationTag << 56) | reinterpret_cast<uintptr_t>(op);
+}
+
+void UringPoller::submitWritev(int fd, const struct iovec* iov, int iovcnt,
+                               EventLoop::CompletionCallback cb)
+{
+  Poller::assertInLoopThread();
+  Operation* op = newOperation(std::move(cb));
+  op->iov.assign(iov, iov + iovcnt);
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(op->iov.data());
+  sqe->len = static_cast<uint32_t>(iovcnt);
+  sqe->user_data = (kOperationTag << 56) | reinterpret_cast<uintptr_t>(op);
+}
+
+size_t UringPoller::handleCompletions()
+{
+  // callbacks may submit, but nothing completes until next poll().
+  size_t n = completed_.size();
+  for (Operation* op : completed_)
+  {
+    unlinkOperation(op);
+    op->callback(op->result);
+    delete op;
+  }
+  completed_.clear();
+  return n;
+}
@@ -0,0 +1,121 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_POLLER_URINGPOLLER_H
+#define MUDUO_NET_POLLER_URINGPOLLER_H
+
+#include <muduo/net/Poller.h>
+
+#include <vector>
+
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// IO Multiplexing with io_uring(7).
+///
+/// Readiness is requested with one-shot IORING_OP_POLL_ADD, which is
+/// level-triggered like poll(2). Channels that fired are re-armed,
+/// and interest changes are queued, then everything is submitted in
+/// the same io_uring_enter(2) that waits for completions, so one
+/// loop iteration costs one syscall no matter how many fds are active.
+///
+/// It also does completion based I/O for TcpConnection, see submitRead().
+///
+/// Requires Linux 5.11 (IORING_FEAT_EXT_ARG).
+class UringPoller : public Poller
+{
+ public:
+  UringPoller(EventLoop* loop);
+  ~UringPoller() override;
+
+  MonotonicTime poll(int timeoutMs, ChannelList* activeChannels) override;
+  void updateChannel(Channel* channel) override;
+  void removeChannel(Channel* channel) override;
+
+  bool supportsCompletion() const override { return true; }
+  void submitRead(int fd, void* buf, size_t len,
+                  EventLoop::CompletionCallback cb) override;
+  void submitWritev(int fd, const struct iovec* iov, int iovcnt,
+                    EventLoop::CompletionCallback cb) override;
+  size_t handleCompletions() override;
+
+ private:
+  static const unsigned kRingEntries = 1024;
+
+  struct PollEntry
+  {
+    PollEntry() : userData(0), events(0) { }
+
+    uint64_t userData;  // of the armed POLL_ADD, 0 if not armed
+    int events;         // armed with
+  };
+  // indexed by fd, like channels_
+  typedef std::vector<PollEntry> PollEntryList;
+
+  // a submitted recv/writev, its address is the user_data
+  struct Operation
+  {
+    EventLoop::CompletionCallback callback;
+    std::vector<struct iovec> iov;  // read by kernel on submission
+    int result;
+    Operation* prev;  // in flight list
+    Operation* next;
+  };
+
+  void setupRing();
+  struct io_uring_sqe* getSqe();
+  int submitAndWait(int timeoutMs);
+  void fillActiveChannels(ChannelList* activeChannels);
+  void rearmFired();
+
+  PollEntry& entryOf(int fd);
+  void arm(Channel* channel, PollEntry* entry);
+  void disarm(PollEntry* entry);
+
+  Operation* newOperation(EventLoop::CompletionCallback&& cb);
+  void unlinkOperation(Operation* op);
+
+  int ringfd_;
+  unsigned features_;
+  uint32_t nextSeq_;
+
+  // mmap(2)-ed rings
+  void* sqRingPtr_;
+  size_t sqRingSize_;
+  void* cqRingPtr_;
+  size_t cqRingSize_;
+  struct io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned sqMask_;
+  unsigned* sqArray_;
+  unsigned sqLocalTail_;  // including sqes not yet handed to the kernel
+
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned cqMask_;
+  struct io_uring_cqe* cqes_;
+
+  PollEntryList entries_;
+  // fds whose one-shot poll completed in the last round, re-armed before waiting
+  std::vector<int> fired_;
+  // all submitted operations, sentinel of a circular list
+  Operation inflight_;
+  std::vector<Operation*> completed_;
+};
+
+}  // namespace net
+}  // namespace muduo
+#endif  // MUDUO_NET_POLLER_URINGPOLLER_H
@@ -9,6 +9,7 @@ project "net"
     headers {
         'Buffer.h',
         'Callbacks.h',
+        'ChainBuffer.h',
         'Channel.h',
         'Endian.h',
         'EventLoop.h',
@@ -24,6 +25,8 @@ project "net"
     files {
         'Acceptor.cc',
         'Buffer.cc',
+        'BufferPool.cc',
+        'ChainBuffer.cc',
         'Channel.cc',
         'Connector.cc',
         'EventLoop.cc',
@@ -34,6 +37,7 @@ project "net"
         'poller/DefaultPoller.cc',
         'poller/EPollPoller.cc',
         'poller/PollPoller.cc',
+        'poller/UringPoller.cc',
         'Socket.cc',
         'SocketsOps.cc',
         'TcpClient.cc',
@@ -41,5 +45,6 @@ project "net"
         'TcpServer.cc',
         'Timer.cc',
         'TimerQueue.cc',
+        'TimerWheel.cc',
      }
 
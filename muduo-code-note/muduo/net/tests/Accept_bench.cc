@@ -0,0 +1,173 @@
+// Rate of short connections, one Acceptor in the base loop
+// vs. one SO_REUSEPORT Acceptor per I/O loop.
+//
+// Then a connection storm, a burst of non-blocking connects, accepted
+// one per readiness event vs. in batches, see TcpServer::setAcceptBatch().
+
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Logging.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Acceptor.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/SocketsOps.h>
+#include <muduo/net/TcpServer.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+// connect, read until EOF, close
+void connectAndRead(const InetAddress& serverAddr)
+{
+  int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+  if (sockets::connect(sockfd, serverAddr.getSockAddr()) < 0)
+  {
+    LOG_SYSFATAL << "connect";
+  }
+  char buf[64];
+  while (::read(sockfd, buf, sizeof buf) > 0)
+  {
+  }
+  sockets::close(sockfd);
+}
+
+void bench(TcpServer::Option option, bool cpuSteering, int numThreads,
+           int numClients, int connectionsPerClient, uint16_t port)
+{
+  EventLoop loop;
+  InetAddress listenAddr(port, true);
+  TcpServer server(&loop, listenAddr, "AcceptBench", option);
+  MutexLock mutex;
+  std::map<EventLoop*, int> perLoop;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      {
+      MutexLockGuard lock(mutex);
+      ++perLoop[conn->getLoop()];
+      }
+      conn->send("hello\n");
+      conn->shutdown();
+    }
+  });
+  server.setThreadNum(numThreads);
+  server.setCpuSteering(cpuSteering);
+  if (cpuSteering)
+  {
+    // loop N on CPU N, as the filter expects
+    int numCpus = static_cast<int>(::sysconf(_SC_NPROCESSORS_ONLN));
+    std::vector<std::vector<int>> cpuSets;
+    for (int i = 0; i < numThreads; ++i)
+    {
+      cpuSets.push_back(std::vector<int>(1, i % numCpus));
+    }
+    server.setThreadCpuAffinity(cpuSets);
+  }
+  server.start();
+
+  std::vector<std::unique_ptr<Thread>> clients;
+  CountDownLatch latch(numClients + 1);
+  for (int i = 0; i < numClients; ++i)
+  {
+    clients.emplace_back(new Thread([&] {
+      latch.countDown();
+      latch.wait();
+      for (int j = 0; j < connectionsPerClient; ++j)
+      {
+        connectAndRead(listenAddr);
+      }
+    }));
+    clients.back()->start();
+  }
+
+  Thread waiter([&] {
+    latch.countDown();
+    latch.wait();
+    Timestamp start(Timestamp::now());
+    for (auto& thr : clients)
+    {
+      thr->join();
+    }
+    double seconds = timeDifference(Timestamp::now(), start);
+    int total = numClients * connectionsPerClient;
+    printf("%-20s%s %d threads %8.0f connections/s, per loop:",
+           option == TcpServer::kReusePortPerLoop ? "kReusePortPerLoop" : "kNoReusePort",
+           cpuSteering ? " cpu steering" : "", numThreads, total / seconds);
+    for (const auto& item : perLoop)
+    {
+      printf(" %d", item.second);
+    }
+    printf("\n");
+    loop.quit();
+  });
+  waiter.start();
+  loop.loop();
+  waiter.join();
+}
+
+void storm(int acceptBatch, int burst, uint16_t port)
+{
+  EventLoop loop;
+  InetAddress listenAddr(port, true);
+  TcpServer server(&loop, listenAddr, "AcceptStorm");
+  server.setAcceptBatch(acceptBatch);
+  int accepted = 0;
+  int64_t iterations = 0;
+  Timestamp start;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected() && ++accepted == burst)
+    {
+      double seconds = timeDifference(Timestamp::now(), start);
+      printf("accept batch %3d: %5d connections in %6.1f ms, %6" PRId64 " loop iterations\n",
+             acceptBatch, burst, seconds * 1000, loop.iteration() - iterations);
+      loop.quit();
+    }
+  });
+  server.start();
+
+  std::vector<int> fds;
+  Thread client([&] {
+    for (int i = 0; i < burst; ++i)
+    {
+      int sockfd = sockets::createNonblockingOrDie(AF_INET);
+      sockets::connect(sockfd, listenAddr.getSockAddr());
+      fds.push_back(sockfd);
+    }
+  });
+  loop.runAfter(0.0, [&] {
+    iterations = loop.iteration();
+    start = Timestamp::now();
+    client.start();
+  });
+  loop.loop();
+  client.join();
+  for (int sockfd : fds)
+  {
+    sockets::close(sockfd);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int numThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int numClients = argc > 2 ? atoi(argv[2]) : 4;
+  int connectionsPerClient = argc > 3 ? atoi(argv[3]) : 5000;
+  uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 2021);
+  bool cpuSteering = argc > 5 && atoi(argv[5]) != 0;
+  bench(TcpServer::kNoReusePort, false, numThreads, numClients, connectionsPerClient, port);
+  bench(TcpServer::kReusePortPerLoop, cpuSteering, numThreads, numClients, connectionsPerClient, port);
+  int burst = argc > 6 ? atoi(argv[6]) : 4000;
+  storm(1, burst, port);
+  storm(Acceptor::kDefaultAcceptBatch, burst, port);
+}
@@ -0,0 +1,104 @@
+// A burst of connections accepted in small batches, then a client with
+// TCP fast open talking to a server with TCP_DEFER_ACCEPT and fast open,
+// the client speaks first, which both options rely on.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/SocketsOps.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void testAcceptBatch()
+{
+  const int kBurst = 200;
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, connections not accepted\n");
+    abort();
+  });
+  InetAddress listenAddr(2037, true);
+  TcpServer server(&loop, listenAddr, "BatchServer");
+  server.setAcceptBatch(4);
+  int accepted = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected() && ++accepted == kBurst)
+    {
+      loop.quit();
+    }
+  });
+  server.start();
+
+  std::vector<int> fds;
+  for (int i = 0; i < kBurst; ++i)
+  {
+    int sockfd = sockets::createNonblockingOrDie(AF_INET);
+    sockets::connect(sockfd, listenAddr.getSockAddr());
+    fds.push_back(sockfd);
+  }
+  loop.loop();
+  for (int sockfd : fds)
+  {
+    sockets::close(sockfd);
+  }
+  printf("accepted %d in batches\n", accepted);
+  assert(accepted == kBurst);
+}
+
+void testFastOpen()
+{
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, fast open connection stuck\n");
+    abort();
+  });
+  InetAddress listenAddr(2038, true);
+  TcpServer server(&loop, listenAddr, "FastOpenServer");
+  server.setDeferAccept(5);
+  server.setFastOpen(16);
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  TcpClient client(&loop, listenAddr, "FastOpenClient");
+  client.setFastOpen(true);
+  string echoed;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->send("hello");
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    echoed += buf->retrieveAllAsString();
+    if (echoed.size() >= 5)
+    {
+      conn->shutdown();
+    }
+  });
+  client.connect();
+  loop.loop();
+  printf("fast open echoed %s\n", echoed.c_str());
+  assert(echoed == "hello");
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  testAcceptBatch();
+  testFastOpen();
+}
@@ -0,0 +1,96 @@
+// Pipelined requests, each answered with several small sends,
+// TcpConnection::setAutoCork() off vs. on.
+//
+// The client keeps a pipeline of requests in flight, sending a new one
+// for each complete response. Server and client share one loop.
+// Writes counts send calls the server's connection made to the kernel.
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kRequestSize = 16;
+const size_t kReplySize = 32;
+
+void bench(bool autoCork, int replies, int pipeline, double seconds, uint16_t port)
+{
+  EventLoop loop;
+  InetAddress serverAddr(port, true);
+  TcpServer server(&loop, serverAddr, "AutoCork");
+  server.setConnectionCallback([autoCork](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setTcpNoDelay(true);
+      conn->setAutoCork(autoCork);
+    }
+  });
+  const string reply(kReplySize, 'r');
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= kRequestSize)
+    {
+      buf->retrieve(kRequestSize);
+      for (int i = 0; i < replies; ++i)
+      {
+        conn->send(reply);
+      }
+    }
+  });
+  server.start();
+
+  const string request(kRequestSize, 'q');
+  const size_t responseSize = kReplySize * replies;
+  int64_t responses = 0;
+  Timestamp start;
+  TcpClient client(&loop, serverAddr, "AutoCorkClient");
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setTcpNoDelay(true);
+      start = Timestamp::now();
+      for (int i = 0; i < pipeline; ++i)
+      {
+        conn->send(request);
+      }
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= responseSize)
+    {
+      buf->retrieve(responseSize);
+      ++responses;
+      conn->send(request);
+    }
+  });
+  client.connect();
+
+  loop.runAfter(seconds, [&] {
+    double elapsed = timeDifference(Timestamp::now(), start);
+    printf("autocork %d replies %2d pipeline %3d: %9.0f requests/s %9.0f replies/s\n",
+           autoCork, replies, pipeline,
+           static_cast<double>(responses) / elapsed,
+           static_cast<double>(responses * replies) / elapsed);
+    // both connections close before the loop quits
+    client.disconnect();
+    loop.runAfter(0.1, [&] { loop.quit(); });
+  });
+  loop.loop();
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int replies = argc > 1 ? atoi(argv[1]) : 8;
+  int pipeline = argc > 2 ? atoi(argv[2]) : 16;
+  double seconds = argc > 3 ? atof(argv[3]) : 3.0;
+  bench(false, replies, pipeline, seconds, 2034);
+  bench(true, replies, pipeline, seconds, 2034);
+}
@@ -0,0 +1,117 @@
+// Auto-corked connections, level and edge triggered. The server answers
+// pipelined requests with many small sends, then a reply larger than
+// socket buffers, and shuts down in the same callback, which must not
+// overtake the corked output.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int kRequests = 2000;
+const size_t kLargeSize = 4 * 1024 * 1024;
+
+string expectedOutput()
+{
+  string output;
+  for (int i = 0; i < kRequests; ++i)
+  {
+    char buf[32];
+    snprintf(buf, sizeof buf, "%d", i);
+    output += '[';
+    output += buf;
+    output += ']';
+  }
+  for (size_t i = 0; i < kLargeSize; ++i)
+  {
+    output.push_back(static_cast<char>('a' + i % 26));
+  }
+  return output;
+}
+
+void runCorked(bool edgeTriggered)
+{
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, corked output stuck\n");
+    abort();
+  });
+
+  const string expected = expectedOutput();
+  InetAddress serverAddr(2035, true);
+  TcpServer server(&loop, serverAddr, "CorkServer");
+  server.setEdgeTriggered(edgeTriggered);
+  server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setAutoCork(true);
+      assert(conn->autoCork());
+    }
+  });
+  int requests = 0;
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= sizeof(int32_t))
+    {
+      int32_t index = buf->readInt32();
+      assert(index == requests);
+      ++requests;
+      char num[32];
+      snprintf(num, sizeof num, "%d", index);
+      conn->send("[");
+      conn->send(num);
+      conn->send("]");
+    }
+    if (requests == kRequests)
+    {
+      conn->send(expected.substr(expected.size() - kLargeSize));
+      conn->shutdown();
+    }
+  });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "CorkClient");
+  string received;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      Buffer pipelined;
+      for (int i = 0; i < kRequests; ++i)
+      {
+        pipelined.appendInt32(i);
+      }
+      conn->send(&pipelined);
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    received.append(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+    if (received.size() >= expected.size())
+    {
+      conn->shutdown();
+    }
+  });
+  client.connect();
+  loop.loop();
+
+  assert(received == expected);
+  printf("edge triggered %d: OK %zd bytes\n", edgeTriggered, received.size());
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  runCorked(false);
+  runCorked(true);
+}
@@ -0,0 +1,145 @@
+// Fan-out of one message to many connections from other thread,
+// send() per connection vs. TcpServer::broadcast().
+
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Logging.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+std::atomic<int64_t> g_allocations(0);
+
+void* operator new(size_t size)
+{
+  ++g_allocations;
+  void* p = ::malloc(size == 0 ? 1 : size);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  ::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  ::free(p);
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int numConnections = argc > 1 ? atoi(argv[1]) : 1000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 100;
+  size_t messageSize = argc > 3 ? atoi(argv[3]) : 1024;
+  uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 2020);
+  const int numThreads = 4;
+
+  EventLoop loop;
+  TcpServer server(&loop, InetAddress(port, true), "Broadcast");
+  std::vector<TcpConnectionPtr> connections;
+  CountDownLatch connected(numConnections);
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      // connection callbacks run in different loops
+      loop.runInLoop([&, conn] {
+        connections.push_back(conn);
+        connected.countDown();
+      });
+    }
+  });
+  server.setThreadNum(numThreads);
+  server.start();
+
+  EventLoopThread clientThread;
+  EventLoop* clientLoop = clientThread.startLoop();
+  std::atomic<int64_t> received(0);
+  std::atomic<int64_t> expected(0);
+  std::unique_ptr<CountDownLatch> done;
+  CountDownLatch closed(numConnections);
+  std::vector<std::unique_ptr<TcpClient>> clients;
+  for (int i = 0; i < numConnections; ++i)
+  {
+    clients.emplace_back(new TcpClient(clientLoop, InetAddress(port, true), "BroadcastClient"));
+    clients.back()->setConnectionCallback([&](const TcpConnectionPtr& conn) {
+      if (!conn->connected())
+      {
+        closed.countDown();
+      }
+    });
+    clients.back()->setMessageCallback(
+        [&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+      if ((received += buf->readableBytes()) == expected)
+      {
+        done->countDown();
+      }
+      buf->retrieveAll();
+    });
+    clients.back()->connect();
+  }
+
+  Thread sender([&] {
+    connected.wait();
+    const string payload(messageSize, 'x');
+    for (int broadcast = 0; broadcast < 2; ++broadcast)
+    {
+      done.reset(new CountDownLatch(1));
+      received = 0;
+      expected = static_cast<int64_t>(payload.size()) * numConnections * rounds;
+      int64_t before = g_allocations.load();
+      Timestamp start(Timestamp::now());
+      for (int r = 0; r < rounds; ++r)
+      {
+        if (broadcast)
+        {
+          std::shared_ptr<const string> message(new string(payload));
+          TcpServer::broadcast(connections, message);
+        }
+        else
+        {
+          for (const TcpConnectionPtr& conn : connections)
+          {
+            conn->send(payload);
+          }
+        }
+      }
+      done->wait();
+      double seconds = timeDifference(Timestamp::now(), start);
+      double sends = static_cast<double>(numConnections) * rounds;
+      printf("%-10s %d connections %zd bytes: %8.1f ns, %.3f allocations per connection\n",
+             broadcast ? "broadcast" : "send", numConnections, payload.size(),
+             seconds * 1e9 / sends,
+             static_cast<double>(g_allocations.load() - before) / sends);
+    }
+    for (const TcpConnectionPtr& conn : connections)
+    {
+      conn->shutdown();
+    }
+    closed.wait();
+    loop.quit();
+  });
+  sender.start();
+  loop.loop();
+  sender.join();
+  connections.clear();
+}
@@ -0,0 +1,119 @@
+#include <muduo/net/BufferPool.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/net/ChainBuffer.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/inspect/LoopInspector.h>
+
+//#define BOOST_TEST_MODULE BufferPoolTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+using muduo::net::Buffer;
+using muduo::net::BufferPool;
+using muduo::net::ChainBuffer;
+using muduo::net::EventLoop;
+using muduo::net::HttpRequest;
+using muduo::net::Inspector;
+using muduo::net::LoopInspector;
+
+BOOST_AUTO_TEST_CASE(testBufferPoolLendAndTakeBack)
+{
+  BufferPool pool;
+  Buffer buf(0);
+  BOOST_CHECK(!BufferPool::hasStorage(buf));
+
+  pool.acquire(&buf);
+  BOOST_CHECK(BufferPool::hasStorage(buf));
+  BOOST_CHECK_EQUAL(buf.writableBytes(), Buffer::kInitialSize);
+  BOOST_CHECK_EQUAL(pool.numAcquired(), 1);
+  BOOST_CHECK_EQUAL(pool.numReused(), 0);
+  BOOST_CHECK_EQUAL(pool.numLent(), 1);
+
+  buf.append(string(3000, 'x'));
+  buf.retrieveAll();
+  pool.release(&buf);
+  BOOST_CHECK(!BufferPool::hasStorage(buf));
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(pool.numLent(), 0);
+  BOOST_CHECK_EQUAL(pool.numCached(), 1);
+  BOOST_CHECK_EQUAL(pool.cachedBytes(), Buffer::kCheapPrepend + 3000);
+
+  // grown storage is lent again
+  Buffer other(0);
+  pool.acquire(&other);
+  BOOST_CHECK_EQUAL(pool.numReused(), 1);
+  BOOST_CHECK_EQUAL(pool.numCached(), 0);
+  BOOST_CHECK_EQUAL(other.writableBytes(), 3000);
+  other.append("hello");
+  BOOST_CHECK_EQUAL(other.retrieveAllAsString(), "hello");
+  pool.release(&other);
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPoolDropBig)
+{
+  BufferPool pool;
+  Buffer buf(0);
+  pool.acquire(&buf);
+  buf.append(string(BufferPool::kMaxStorageSize, 'y'));
+  buf.retrieveAll();
+  pool.release(&buf);
+  BOOST_CHECK_EQUAL(pool.numDropped(), 1);
+  BOOST_CHECK_EQUAL(pool.numCached(), 0);
+  BOOST_CHECK_EQUAL(pool.cachedBytes(), 0);
+
+  // acquiring twice is harmless
+  pool.acquire(&buf);
+  pool.acquire(&buf);
+  BOOST_CHECK_EQUAL(pool.numLent(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPoolStorageTaken)
+{
+  BufferPool pool;
+  ChainBuffer output;
+  Buffer buf(0);
+  for (int i = 0; i < 100; ++i)
+  {
+    pool.acquire(&buf);
+    // big enough for ChainBuffer to take the storage instead of copying
+    buf.append(string(ChainBuffer::kBlockSize, 'z'));
+    output.append(&buf);
+    BOOST_CHECK(!BufferPool::hasStorage(buf));
+    pool.release(&buf);
+    BOOST_CHECK_EQUAL(pool.numLent(), 0);
+  }
+  BOOST_CHECK_EQUAL(pool.numAcquired(), 100);
+  BOOST_CHECK_EQUAL(pool.numReleased(), 100);
+  BOOST_CHECK_EQUAL(pool.numTaken(), 100);
+  BOOST_CHECK_EQUAL(pool.numCached(), 0);
+  BOOST_CHECK_EQUAL(output.readableBytes(), 100 * ChainBuffer::kBlockSize);
+
+  // a buffer never lent is left alone
+  Buffer idle(0);
+  pool.release(&idle);
+  BOOST_CHECK_EQUAL(pool.numReleased(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPoolInspector)
+{
+  EventLoop loop;
+  LoopInspector inspector;
+  inspector.addLoop("main", &loop);
+  Buffer buf(0);
+  loop.bufferPool()->acquire(&buf);
+  string result = inspector.pool(HttpRequest::kGet, Inspector::ArgList());
+  BOOST_CHECK_EQUAL(result.find("main acquired 1 reused 0 released 0"), 0);
+  BOOST_CHECK(result.find(" lent 1 ") != string::npos);
+
+  buf.append("x");
+  buf.retrieveAll();
+  loop.bufferPool()->release(&buf);
+  Inspector::ArgList args;
+  args.push_back("main");
+  result = inspector.pool(HttpRequest::kGet, args);
+  BOOST_CHECK(result.find(" lent 0 cached 1 ") != string::npos);
+  args[0] = "other";
+  BOOST_CHECK_EQUAL(inspector.pool(HttpRequest::kGet, args), "");
+}
@@ -0,0 +1,114 @@
+// Round trip latency of one ping-pong connection,
+// blocking poll() vs. EventLoop::setBusyPollMicroSeconds().
+//
+// Server and client run in two loops, both busy polling, a ping is sent
+// every intervalUs, longer than the budget lets them block in between.
+// On a machine with fewer idle cores than spinning loops, busy polling
+// only steals CPU from the other side, expect it to be worse there.
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void bench(int64_t busyPollUs, int pings, double interval, uint16_t port)
+{
+  InetAddress serverAddr(port, true);
+  EventLoop loop;
+  loop.setBusyPollMicroSeconds(busyPollUs);
+  TcpServer server(&loop, serverAddr, "BusyPoll");
+  server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setTcpNoDelay(true);
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  EventLoopThread clientThread;
+  EventLoop* clientLoop = clientThread.startLoop();
+  clientLoop->setBusyPollMicroSeconds(busyPollUs);
+  TcpClient client(clientLoop, serverAddr, "BusyPollClient");
+  std::vector<int64_t> latencies;
+  latencies.reserve(pings);
+  double serverBusy = 0.0;
+  double serverSpin = 0.0;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setTcpNoDelay(true);
+      Buffer buf;
+      buf.appendInt64(Timestamp::now().microSecondsSinceEpoch());
+      conn->send(&buf);
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= sizeof(int64_t))
+    {
+      int64_t sent = buf->readInt64();
+      latencies.push_back(Timestamp::now().microSecondsSinceEpoch() - sent);
+      if (latencies.size() == static_cast<size_t>(pings) / 2)
+      {
+        // sampled in the middle of the run
+        serverBusy = loop.busyRatio();
+        serverSpin = loop.spinRatio();
+      }
+      if (latencies.size() < static_cast<size_t>(pings))
+      {
+        clientLoop->runAfter(interval, [conn] {
+          Buffer ping;
+          ping.appendInt64(Timestamp::now().microSecondsSinceEpoch());
+          conn->send(&ping);
+        });
+      }
+      else
+      {
+        conn->shutdown();
+      }
+    }
+  });
+  client.connect();
+  loop.loop();
+  clientLoop->setBusyPollMicroSeconds(0);
+
+  std::sort(latencies.begin(), latencies.end());
+  size_t n = latencies.size();
+  if (n > 0)
+  {
+    printf("busy poll %4" PRId64 " us: %zd pings, latency us p50 %4" PRId64
+           " p99 %4" PRId64 " max %5" PRId64 ", server busy %.3f spin %.3f\n",
+           busyPollUs, n, latencies[n / 2], latencies[n * 99 / 100], latencies[n - 1],
+           serverBusy, serverSpin);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int64_t busyPollUs = argc > 1 ? atoll(argv[1]) : 1000;
+  int pings = argc > 2 ? atoi(argv[2]) : 5000;
+  double intervalUs = argc > 3 ? atof(argv[3]) : 200;
+  uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 2023);
+  bench(0, pings, intervalUs * 1e-6, port);
+  bench(busyPollUs, pings, intervalUs * 1e-6, port);
+}
@@ -0,0 +1,281 @@
+#include <muduo/net/ChainBuffer.h>
+#include <muduo/net/Buffer.h>
+
+//#define BOOST_TEST_MODULE ChainBufferTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using muduo::string;
+using muduo::net::Buffer;
+using muduo::net::ChainBuffer;
+
+BOOST_AUTO_TEST_CASE(testChainBufferAppendRetrieve)
+{
+  ChainBuffer buf;
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 0);
+
+  const string str(200, 'x');
+  buf.append(str);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), str.size());
+  BOOST_CHECK_EQUAL(buf.numSegments(), 1);
+
+  const string str2 = buf.retrieveAsString(50);
+  BOOST_CHECK_EQUAL(str2, string(50, 'x'));
+  BOOST_CHECK_EQUAL(buf.readableBytes(), str.size() - str2.size());
+
+  buf.append(string(ChainBuffer::kBlockSize, 'y'));
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 150 + ChainBuffer::kBlockSize);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 2);
+  BOOST_CHECK_EQUAL(buf.internalCapacity(), 2 * ChainBuffer::kBlockSize);
+
+  const string str3 = buf.retrieveAllAsString();
+  BOOST_CHECK_EQUAL(str3, string(150, 'x') + string(ChainBuffer::kBlockSize, 'y'));
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferSlice)
+{
+  ChainBuffer buf;
+  std::shared_ptr<string> payload(new string(100000, 'p'));
+  buf.append("HEAD");
+  buf.append(*payload, payload);
+  BOOST_CHECK_EQUAL(payload.use_count(), 2);
+  buf.append("TAIL");
+  BOOST_CHECK_EQUAL(buf.numSegments(), 3);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 100008);
+
+  struct iovec vec[ChainBuffer::kMaxIovecs];
+  BOOST_CHECK_EQUAL(buf.fillIovec(vec, ChainBuffer::kMaxIovecs), 3);
+  BOOST_CHECK(vec[1].iov_base == payload->data());
+
+  buf.retrieve(4 + payload->size());
+  BOOST_CHECK_EQUAL(payload.use_count(), 1);
+  BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), "TAIL");
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferStealBuffer)
+{
+  ChainBuffer buf;
+  Buffer small;
+  small.append("hello");
+  buf.append(&small);
+  BOOST_CHECK_EQUAL(small.readableBytes(), 0);
+
+  Buffer big;
+  big.append(string(ChainBuffer::kBlockSize * 2, 'b'));
+  const char* data = big.peek();
+  buf.append(&big);
+  BOOST_CHECK_EQUAL(big.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 5 + ChainBuffer::kBlockSize * 2);
+
+  struct iovec vec[ChainBuffer::kMaxIovecs];
+  BOOST_CHECK_EQUAL(buf.fillIovec(vec, ChainBuffer::kMaxIovecs), 2);
+  BOOST_CHECK(vec[1].iov_base == data);
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferPrepend)
+{
+  ChainBuffer buf;
+  buf.append(string(200, 'y'));
+  buf.prependInt32(0x61626364);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 204);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 2);
+
+  buf.retrieve(4);
+  buf.prepend("xyz", 3);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 2);
+  BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), "xyz" + string(200, 'y'));
+
+  const string big(ChainBuffer::kBlockSize + 100, 'z');
+  buf.append("end");
+  buf.prepend(big.data(), big.size());
+  BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), big + "end");
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferPeek)
+{
+  ChainBuffer buf;
+  BOOST_CHECK(buf.findCRLF() == NULL);
+  buf.append(string(ChainBuffer::kBlockSize - 1, 'a'));
+  buf.append("\r\n");
+  buf.append("bcd");
+  BOOST_CHECK_EQUAL(buf.numSegments(), 2);
+
+  const char* crlf = buf.findCRLF();
+  BOOST_CHECK_EQUAL(buf.numSegments(), 1);
+  BOOST_REQUIRE(crlf != NULL);
+  BOOST_CHECK_EQUAL(crlf - buf.peek(), ChainBuffer::kBlockSize - 1);
+  BOOST_CHECK_EQUAL(string(crlf + 2, 3), "bcd");
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferWriteFd)
+{
+  int fds[2];
+  BOOST_REQUIRE(::pipe(fds) == 0);
+
+  ChainBuffer buf;
+  std::shared_ptr<string> payload(new string(10000, 'p'));
+  buf.append("GET");
+  buf.append(*payload, payload);
+  buf.append("END");
+
+  int savedErrno = 0;
+  ssize_t n = buf.writeFd(fds[1], &savedErrno);
+  BOOST_CHECK_EQUAL(n, 10006);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 0);
+
+  Buffer input;
+  while (input.readableBytes() < 10006)
+  {
+    BOOST_REQUIRE(input.readFd(fds[0], &savedErrno) > 0);
+  }
+  BOOST_CHECK_EQUAL(input.retrieveAllAsString(), "GET" + *payload + "END");
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferFile)
+{
+  char name[] = "/tmp/chainbuffer_unittest.XXXXXX";
+  int fd = ::mkstemp(name);
+  BOOST_REQUIRE(fd >= 0);
+  ::unlink(name);
+  string content;
+  for (int i = 0; i < 10000; ++i)
+  {
+    content.push_back(static_cast<char>('a' + i % 26));
+  }
+  BOOST_REQUIRE(::write(fd, content.data(), content.size()) == 10000);
+
+  ChainBuffer buf;
+  buf.append("HEAD");
+  BOOST_REQUIRE(buf.appendFile(fd, 100, 9000));
+  buf.append("TAIL");
+  ::close(fd);  // buffer keeps its own
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 9008);
+  BOOST_CHECK_EQUAL(buf.numSegments(), 3);
+
+  struct iovec vec[ChainBuffer::kMaxIovecs];
+  BOOST_CHECK_EQUAL(buf.fillIovec(vec, ChainBuffer::kMaxIovecs), 1);
+
+  int fds[2];
+  BOOST_REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  int savedErrno = 0;
+  while (buf.readableBytes() > 0)
+  {
+    BOOST_REQUIRE(buf.writeFd(fds[0], &savedErrno) > 0);
+  }
+
+  Buffer input;
+  while (input.readableBytes() < 9008)
+  {
+    BOOST_REQUIRE(input.readFd(fds[1], &savedErrno) > 0);
+  }
+  BOOST_CHECK(input.retrieveAllAsString() == "HEAD" + content.substr(100, 9000) + "TAIL");
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferReadFile)
+{
+  char name[] = "/tmp/chainbuffer_unittest.XXXXXX";
+  int fd = ::mkstemp(name);
+  BOOST_REQUIRE(fd >= 0);
+  ::unlink(name);
+  const string content(ChainBuffer::kBlockSize * 3, 'f');
+  BOOST_REQUIRE(::write(fd, content.data(), content.size()) == 12288);
+
+  ChainBuffer buf;
+  BOOST_REQUIRE(buf.appendFile(fd, 0, content.size()));
+  ::close(fd);
+  BOOST_CHECK(buf.readFileFront(ChainBuffer::kBlockSize));
+  BOOST_CHECK_EQUAL(buf.numSegments(), 2);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), content.size());
+
+  struct iovec vec[ChainBuffer::kMaxIovecs];
+  BOOST_CHECK_EQUAL(buf.fillIovec(vec, ChainBuffer::kMaxIovecs), 1);
+  BOOST_CHECK_EQUAL(vec[0].iov_len, ChainBuffer::kBlockSize);
+
+  buf.retrieve(100);
+  BOOST_CHECK_EQUAL(buf.retrieveAsString(ChainBuffer::kBlockSize), string(ChainBuffer::kBlockSize, 'f'));
+  buf.append("end");
+  BOOST_CHECK(buf.findCRLF() == NULL);
+  BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), string(ChainBuffer::kBlockSize * 2 - 100, 'f') + "end");
+}
+
+BOOST_AUTO_TEST_CASE(testChainBufferSplice)
+{
+  // a pipe, which sendfile(2) doesn't take
+  int source[2];
+  BOOST_REQUIRE(::pipe(source) == 0);
+  string content;
+  for (int i = 0; i < 60000; ++i)
+  {
+    content.push_back(static_cast<char>('a' + i % 26));
+  }
+  BOOST_REQUIRE(::write(source[1], content.data(), content.size()) == 60000);
+  ::close(source[1]);
+
+  ChainBuffer buf;
+  buf.append("HEAD");
+  BOOST_REQUIRE(buf.appendFile(source[0], 0, content.size()));
+  ::close(source[0]);
+  buf.append("TAIL");
+  const string expected = "HEAD" + content + "TAIL";
+
+  // takes a page at a time, the rest stays in the pipe of the file
+  int fds[2];
+  BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+  BOOST_REQUIRE(::fcntl(fds[1], F_SETPIPE_SZ, 4096) >= 0);
+
+  size_t sent = 0;
+  size_t takenAt = 0;  // of 100 bytes read out of the buffer instead
+  string received;
+  int savedErrno = 0;
+  while (buf.readableBytes() > 0)
+  {
+    ssize_t n = buf.writeFd(fds[1], &savedErrno);
+    if (n < 0)
+    {
+      BOOST_REQUIRE_EQUAL(savedErrno, EAGAIN);
+    }
+    else
+    {
+      sent += n;
+    }
+    if (takenAt == 0 && sent > 20000)
+    {
+      // after some short writes of the file, its pipe isn't empty
+      BOOST_REQUIRE_LT(sent, expected.size() - 100);
+      BOOST_CHECK_EQUAL(buf.retrieveAsString(100), expected.substr(sent, 100));
+      takenAt = sent;
+    }
+    char chunk[8192];
+    ssize_t nr = 0;
+    while ((nr = ::read(fds[0], chunk, sizeof chunk)) > 0)
+    {
+      received.append(chunk, nr);
+    }
+  }
+  char chunk[8192];
+  ssize_t nr = 0;
+  while ((nr = ::read(fds[0], chunk, sizeof chunk)) > 0)
+  {
+    received.append(chunk, nr);
+  }
+  BOOST_CHECK_GT(takenAt, 0);
+  BOOST_CHECK(received == expected.substr(0, takenAt) + expected.substr(takenAt + 100));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
@@ -0,0 +1,60 @@
+#include <muduo/net/ChannelTable.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+
+//#define BOOST_TEST_MODULE ChannelTableTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::net::Channel;
+using muduo::net::ChannelTable;
+using muduo::net::EventLoop;
+
+BOOST_AUTO_TEST_CASE(testChannelTableAddAndRemove)
+{
+  EventLoop loop;
+  Channel a(&loop, 3);
+  Channel b(&loop, 1000);
+  ChannelTable table;
+  BOOST_CHECK(table.find(3) == NULL);
+  BOOST_CHECK(table.find(100000) == NULL);
+
+  table.add(3, &a);
+  table.add(1000, &b);
+  BOOST_CHECK_EQUAL(table.size(), 2);
+  BOOST_CHECK(table.find(3) == &a);
+  BOOST_CHECK(table.find(1000) == &b);
+  BOOST_CHECK(table.find(4) == NULL);
+  BOOST_CHECK(table.contains(3, &a));
+  BOOST_CHECK(!table.contains(3, &b));
+  BOOST_CHECK(!table.contains(4, NULL));
+
+  table.remove(3);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+  BOOST_CHECK(table.find(3) == NULL);
+  BOOST_CHECK(!table.contains(3, &a));
+  table.remove(1000);
+  BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testChannelTableGeneration)
+{
+  EventLoop loop;
+  Channel old(&loop, 5);
+  Channel reused(&loop, 5);
+  ChannelTable table;
+
+  uint32_t g1 = table.add(5, &old);
+  BOOST_CHECK_EQUAL(table.generation(5), g1);
+  BOOST_CHECK(table.find(5, g1) == &old);
+  table.remove(5);
+  BOOST_CHECK(table.find(5, g1) == NULL);
+
+  // fd reused by another channel, events of the old one are stale
+  uint32_t g2 = table.add(5, &reused);
+  BOOST_CHECK_NE(g1, g2);
+  BOOST_CHECK(table.find(5, g1) == NULL);
+  BOOST_CHECK(table.find(5, g2) == &reused);
+  table.remove(5);
+}
@@ -29,7 +29,7 @@ namespace net
 namespace detail
 {
 int createTimerfd();
-void readTimerfd(int timerfd, Timestamp now);
+void readTimerfd(int timerfd, MonotonicTime now);
 }
 }
 }
@@ -38,12 +38,12 @@ void readTimerfd(int timerfd, Timestamp now);
 class PeriodicTimer
 {
  public:
-  PeriodicTimer(EventLoop* loop, double interval, const TimerCallback& cb)
+  PeriodicTimer(EventLoop* loop, double interval, TimerCallback cb)
     : loop_(loop),
       timerfd_(muduo::net::detail::createTimerfd()),
       timerfdChannel_(loop, timerfd_),
       interval_(interval),
-      cb_(cb)
+      cb_(std::move(cb))
   {
     timerfdChannel_.setReadCallback(
         std::bind(&PeriodicTimer::handleRead, this));
@@ -74,7 +74,7 @@ class PeriodicTimer
   void handleRead()
   {
     loop_->assertInLoopThread();
-    muduo::net::detail::readTimerfd(timerfd_, Timestamp::now());
+    muduo::net::detail::readTimerfd(timerfd_, MonotonicTime::now());
     if (cb_)
       cb_();
   }
@@ -0,0 +1,148 @@
+// Completion mode on UringPoller for both ends. The client sends a
+// message larger than socket buffers, the server echoes it after a
+// file, so reads and writes are split over many completions and the
+// server's output is still in flight when it shuts down.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <linux/io_uring.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kFileSize = 1024 * 1024;
+const size_t kMessageSize = 4 * 1024 * 1024;
+
+char expectedByte(size_t offset)
+{
+  return offset < kFileSize
+      ? static_cast<char>('a' + offset % 26)
+      : static_cast<char>('0' + (offset - kFileSize) % 10);
+}
+
+// UringPoller aborts without io_uring, e.g. in containers that forbid it
+bool uringAvailable()
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof params);
+  int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 4, &params));
+  if (fd < 0)
+  {
+    return false;
+  }
+  ::close(fd);
+  return (params.features & IORING_FEAT_EXT_ARG) != 0;
+}
+
+int createFile()
+{
+  char name[] = "/tmp/muduo_completion_XXXXXX";
+  int fd = ::mkstemp(name);
+  assert(fd >= 0);
+  ::unlink(name);
+  string content;
+  for (size_t i = 0; i < kFileSize; ++i)
+  {
+    content.push_back(expectedByte(i));
+  }
+  ssize_t n = ::write(fd, content.data(), content.size());
+  assert(n == static_cast<ssize_t>(kFileSize)); (void) n;
+  return fd;
+}
+
+int main()
+{
+  if (!uringAvailable())
+  {
+    printf("io_uring is not available, skipped\n");
+    return 0;
+  }
+  ::setenv("MUDUO_USE_URING", "1", 1);
+  Logger::setLogLevel(Logger::WARN);
+  EventLoop loop;
+  assert(loop.supportsCompletion());
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, a completion is lost\n");
+    abort();
+  });
+
+  const int fileFd = createFile();
+  InetAddress serverAddr(2043, true);
+  TcpServer server(&loop, serverAddr, "CompletionServer");
+  server.setCompletionMode(true);
+  int closed = 0;
+  // quits after both connections are destroyed
+  auto onClose = [&] {
+    if (++closed == 2)
+    {
+      loop.runAfter(0.05, [&loop] { loop.quit(); });
+    }
+  };
+  size_t echoed = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      assert(conn->completionMode());
+      conn->sendFile(fileFd, 0, kFileSize);
+    }
+    else
+    {
+      onClose();
+    }
+  });
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    echoed += buf->readableBytes();
+    conn->send(buf);
+    if (echoed == kMessageSize)
+    {
+      conn->shutdown();
+    }
+  });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "CompletionClient");
+  client.setCompletionMode(true);
+  size_t received = 0;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      assert(conn->completionMode());
+      string message;
+      for (size_t i = 0; i < kMessageSize; ++i)
+      {
+        message.push_back(expectedByte(kFileSize + i));
+      }
+      conn->send(message);
+    }
+    else
+    {
+      onClose();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    for (size_t i = 0; i < buf->readableBytes(); ++i)
+    {
+      assert(buf->peek()[i] == expectedByte(received + i));
+    }
+    received += buf->readableBytes();
+    buf->retrieveAll();
+  });
+  client.connect();
+  loop.loop();
+
+  ::close(fileFd);
+  assert(echoed == kMessageSize);
+  assert(received == kFileSize + kMessageSize);
+  printf("OK %zd bytes\n", received);
+}
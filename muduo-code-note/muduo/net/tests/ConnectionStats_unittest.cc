@@ -0,0 +1,107 @@
+// Traffic counters of connections. The client pauses reading, so the
+// server's output stays above the high water mark for a while, then
+// drains it and closes. Counters stay readable after the connection is
+// gone, the loop keeps the totals.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/ConnectionStats.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kMessageSize = 4 * 1024 * 1024;
+const size_t kHighWaterMark = 64 * 1024;
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout\n");
+    abort();
+  });
+
+  InetAddress serverAddr(2039, true);
+  TcpServer server(&loop, serverAddr, "StatsServer");
+  ConnectionStatsPtr serverStats;
+  int highWater = 0;
+  int closed = 0;
+  // quits after both connections are destroyed
+  auto onClose = [&] {
+    if (++closed == 2)
+    {
+      loop.runAfter(0.05, [&loop] { loop.quit(); });
+    }
+  };
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      serverStats = conn->stats();
+      conn->setHighWaterMarkCallback([&highWater](const TcpConnectionPtr&, size_t) {
+        ++highWater;
+      }, kHighWaterMark);
+      conn->send(string(kMessageSize, 'x'));
+      conn->shutdown();
+    }
+    else
+    {
+      onClose();
+    }
+  });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "StatsClient");
+  ConnectionStatsPtr clientStats;
+  size_t received = 0;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      clientStats = conn->stats();
+      conn->stopRead();
+      loop.runAfter(0.2, [conn] { conn->startRead(); });
+    }
+    else
+    {
+      onClose();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    received += buf->readableBytes();
+    buf->retrieveAll();
+  });
+  client.connect();
+
+  loop.runAfter(0.1, [&] {
+    // both connections are live, the server is stuck above the mark
+    assert(loop.connectionStats().snapshot().size() == 2);
+    assert(serverStats->backlog.load() >= static_cast<int64_t>(kHighWaterMark));
+    assert(serverStats->highWaterSince.load() != 0);
+  });
+  loop.loop();
+
+  assert(received == kMessageSize);
+  assert(highWater == 1);
+  assert(serverStats->bytesSent.load() == static_cast<int64_t>(kMessageSize));
+  assert(serverStats->writes.load() > 1);
+  assert(serverStats->backlog.load() == 0);
+  assert(serverStats->maxBacklog.load() >= static_cast<int64_t>(kHighWaterMark));
+  assert(serverStats->highWaterSince.load() == 0);
+  // paused for 0.2s, minus the time to fill the socket buffers
+  assert(serverStats->highWaterMicroSeconds.load() > 100 * 1000);
+  assert(clientStats->bytesReceived.load() == static_cast<int64_t>(kMessageSize));
+  assert(clientStats->reads.load() > 1);
+
+  assert(loop.connectionStats().snapshot().empty());
+  string total = loop.connectionStats().toString();
+  printf("%s\n", total.c_str());
+  printf("%s\n", serverStats->toString(MonotonicTime::now()).c_str());
+  assert(total.find("connections 0 closed 2") == 0);
+}
@@ -0,0 +1,132 @@
+// Edge triggered connections on both ends, transfers a file and
+// an echoed message larger than socket buffers, the client pauses
+// reading on the way, nothing must get stuck waiting for an edge.
+// The file alone is past the server's high water mark, it's the first
+// to cross it, before any echo.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kFileSize = 1024 * 1024;
+const size_t kMessageSize = 4 * 1024 * 1024;
+
+char expectedByte(size_t offset)
+{
+  return offset < kFileSize
+      ? static_cast<char>('a' + offset % 26)
+      : static_cast<char>('0' + (offset - kFileSize) % 10);
+}
+
+int createFile()
+{
+  char name[] = "/tmp/muduo_edge_triggered_XXXXXX";
+  int fd = ::mkstemp(name);
+  assert(fd >= 0);
+  ::unlink(name);
+  string content;
+  for (size_t i = 0; i < kFileSize; ++i)
+  {
+    content.push_back(expectedByte(i));
+  }
+  ssize_t n = ::write(fd, content.data(), content.size());
+  assert(n == static_cast<ssize_t>(kFileSize)); (void) n;
+  return fd;
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  EventLoop loop;
+  if (!loop.supportsEdgeTriggered())
+  {
+    printf("poller doesn't support edge triggered, skipped\n");
+    return 0;
+  }
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, stuck waiting for an edge\n");
+    abort();
+  });
+
+  const int fileFd = createFile();
+  InetAddress serverAddr(2031, true);
+  TcpServer server(&loop, serverAddr, "EdgeServer");
+  server.setEdgeTriggered(true);
+  size_t highWater = 0;  // of the first crossing
+  server.setConnectionCallback([fileFd, &highWater](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      assert(conn->edgeTriggered());
+      conn->setHighWaterMarkCallback(
+          [&highWater](const TcpConnectionPtr&, size_t len) {
+            if (highWater == 0)
+            {
+              highWater = len;
+            }
+          },
+          kFileSize / 2);
+      conn->sendFile(fileFd, 0, kFileSize);
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "EdgeClient");
+  client.setEdgeTriggered(true);
+  size_t received = 0;
+  bool paused = false;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      assert(conn->edgeTriggered());
+      string message;
+      for (size_t i = 0; i < kMessageSize; ++i)
+      {
+        message.push_back(expectedByte(kFileSize + i));
+      }
+      conn->send(message);
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    for (size_t i = 0; i < buf->readableBytes(); ++i)
+    {
+      assert(buf->peek()[i] == expectedByte(received + i));
+    }
+    received += buf->readableBytes();
+    buf->retrieveAll();
+    if (!paused && received > kFileSize / 2)
+    {
+      // the edge of data arriving meanwhile is gone, startRead() re-arms
+      paused = true;
+      conn->stopRead();
+      loop.runAfter(0.1, [conn] { conn->startRead(); });
+    }
+    if (received == kFileSize + kMessageSize)
+    {
+      conn->shutdown();
+    }
+  });
+  client.connect();
+  loop.loop();
+
+  ::close(fileFd);
+  assert(received == kFileSize + kMessageSize);
+  assert(highWater == kFileSize);
+  printf("OK %zd bytes\n", received);
+}
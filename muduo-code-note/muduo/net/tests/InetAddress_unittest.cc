@@ -33,6 +33,23 @@ BOOST_AUTO_TEST_CASE(testInetAddress)
   BOOST_CHECK_EQUAL(addr3.toPort(), 65535);
 }
 
+BOOST_AUTO_TEST_CASE(testInetAddressUnixDomain)
+{
+  InetAddress addr0 = InetAddress::unixDomain("/tmp/muduo.sock");
+  BOOST_CHECK(addr0.isUnixDomain());
+  BOOST_CHECK_EQUAL(addr0.unixPath(), string("/tmp/muduo.sock"));
+  BOOST_CHECK_EQUAL(addr0.toIpPort(), string("unix:/tmp/muduo.sock"));
+  BOOST_CHECK_EQUAL(addr0.toPort(), 0);
+
+  InetAddress addr1 = InetAddress::unixDomain("muduo", true);
+  BOOST_CHECK(addr1.isUnixDomain());
+  BOOST_CHECK_EQUAL(addr1.unixPath(), string("@muduo"));
+  BOOST_CHECK_EQUAL(addr1.toIpPort(), string("unix:@muduo"));
+
+  InetAddress addr2(1234);
+  BOOST_CHECK(!addr2.isUnixDomain());
+}
+
 BOOST_AUTO_TEST_CASE(testInetAddressResolve)
 {
   InetAddress addr(80);
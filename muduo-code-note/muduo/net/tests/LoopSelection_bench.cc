@@ -0,0 +1,211 @@
+// Latency of light connections, sharing I/O loops with heavy ones,
+// under each TcpServer::LoopSelection.
+//
+// Heavy connections come first and keep half of the loops busy, asking for
+// kHeavyMicroSeconds of CPU per request, back to back.
+// Light connections come next, send a ping every millisecond and record
+// the round trip, round-robin puts half of them with heavy ones.
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Endian.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int64_t kHeavyMicroSeconds = 500;
+const size_t kMessageSize = 1 + sizeof(int64_t);  // type, timestamp
+
+void spin(int64_t microSeconds)
+{
+  Timestamp start(Timestamp::now());
+  while (Timestamp::now().microSecondsSinceEpoch() - start.microSecondsSinceEpoch() < microSeconds)
+  {
+  }
+}
+
+void sendMessage(const TcpConnectionPtr& conn, char type)
+{
+  Buffer buf;
+  buf.appendInt8(type);
+  buf.appendInt64(Timestamp::now().microSecondsSinceEpoch());
+  conn->send(&buf);
+}
+
+void onServerMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+  while (buf->readableBytes() >= kMessageSize)
+  {
+    if (*buf->peek() == 'H')
+    {
+      spin(kHeavyMicroSeconds);
+    }
+    conn->send(buf->peek(), static_cast<int>(kMessageSize));
+    buf->retrieve(kMessageSize);
+  }
+}
+
+// all clients run in one loop
+class Clients : noncopyable
+{
+ public:
+  Clients(EventLoop* loop, const InetAddress& serverAddr)
+    : loop_(loop),
+      serverAddr_(serverAddr),
+      recording_(false)
+  {
+  }
+
+  void connect(bool heavy)
+  {
+    TcpClient* client = new TcpClient(loop_, serverAddr_, heavy ? "heavy" : "light");
+    client->setConnectionCallback([heavy](const TcpConnectionPtr& conn) {
+      if (conn->connected())
+      {
+        sendMessage(conn, heavy ? 'H' : 'L');
+      }
+    });
+    client->setMessageCallback(std::bind(&Clients::onMessage, this, _1, _2, _3));
+    clients_.emplace_back(client);
+    client->connect();
+  }
+
+  void record(bool on)
+  {
+    loop_->runInLoop([this, on] {
+      recording_ = on;
+      if (on)
+      {
+        latencies_.clear();
+      }
+    });
+  }
+
+  // valid after record(false)
+  std::vector<int64_t>& latencies()
+  { return latencies_; }
+
+  void disconnect()
+  {
+    for (auto& client : clients_)
+    {
+      client->disconnect();
+    }
+  }
+
+ private:
+  void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+  {
+    while (buf->readableBytes() >= kMessageSize)
+    {
+      char type = buf->readInt8();
+      int64_t sent = buf->readInt64();
+      if (type == 'H')
+      {
+        sendMessage(conn, 'H');
+      }
+      else
+      {
+        if (recording_)
+        {
+          latencies_.push_back(Timestamp::now().microSecondsSinceEpoch() - sent);
+        }
+        loop_->runAfter(0.001, [conn] {
+          if (conn->connected())
+          {
+            sendMessage(conn, 'L');
+          }
+        });
+      }
+    }
+  }
+
+  EventLoop* loop_;
+  const InetAddress serverAddr_;
+  std::vector<std::unique_ptr<TcpClient>> clients_;
+  bool recording_;
+  std::vector<int64_t> latencies_;
+};
+
+void bench(const char* name, TcpServer::LoopSelection selection,
+           int numThreads, int numConnections, double seconds, uint16_t port)
+{
+  EventLoop loop;
+  InetAddress serverAddr(port, true);
+  TcpServer server(&loop, serverAddr, "LoopSelection");
+  server.setMessageCallback(onServerMessage);
+  server.setThreadNum(numThreads);
+  server.setLoopSelection(selection);
+  server.start();
+  std::vector<EventLoop*> loops = server.threadPool()->getAllLoops();
+
+  EventLoopThread clientThread;
+  Clients clients(clientThread.startLoop(), serverAddr);
+
+  Thread driver([&] {
+    int numHeavy = std::max(numThreads / 2, 1);
+    for (int i = 0; i < numConnections; ++i)
+    {
+      // one at a time, for the order of accepting and the busy ratio
+      clients.connect(i < numHeavy);
+      usleep(50 * 1000);
+    }
+    usleep(500 * 1000);
+    clients.record(true);
+    usleep(static_cast<useconds_t>(seconds * 1e6));
+    clients.record(false);
+    usleep(100 * 1000);
+
+    std::vector<int64_t>& latencies = clients.latencies();
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    if (n > 0)
+    {
+      printf("%-22s %6zd pings, latency us p50 %6" PRId64 " p90 %6" PRId64
+             " p99 %6" PRId64 " max %6" PRId64 "\n",
+             name, n, latencies[n / 2], latencies[n * 9 / 10],
+             latencies[n * 99 / 100], latencies[n - 1]);
+    }
+    printf("%-22s connections per loop:", "");
+    for (EventLoop* ioLoop : loops)
+    {
+      printf(" %d", ioLoop->numConnections());
+    }
+    printf("\n");
+    clients.disconnect();
+    usleep(100 * 1000);
+    loop.quit();
+  });
+  driver.start();
+  loop.loop();
+  driver.join();
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int numThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int numConnections = argc > 2 ? atoi(argv[2]) : 16;
+  double seconds = argc > 3 ? atof(argv[3]) : 3.0;
+  uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 2022);
+  bench("kRoundRobin", TcpServer::kRoundRobin, numThreads, numConnections, seconds, port);
+  bench("kLeastConnections", TcpServer::kLeastConnections, numThreads, numConnections, seconds, port);
+  bench("kLeastPendingFunctors", TcpServer::kLeastPendingFunctors, numThreads, numConnections, seconds, port);
+  bench("kLeastBusy", TcpServer::kLeastBusy, numThreads, numConnections, seconds, port);
+}
@@ -0,0 +1,56 @@
+// Histograms of an EventLoop after some timers and cross thread functors.
+
+#include <muduo/base/Thread.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/LoopStats.h>
+
+//#define BOOST_TEST_MODULE LoopStatsTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+BOOST_AUTO_TEST_CASE(testLoopStats)
+{
+  const int kTimers = 20;
+  const int kFunctors = 1000;
+  EventLoop loop;
+  int fired = 0;
+  for (int i = 0; i < kTimers; ++i)
+  {
+    loop.runAfter(0.001 * i, [&fired] { ++fired; });
+  }
+  int called = 0;
+  Thread producer([&] {
+    for (int i = 0; i < kFunctors; ++i)
+    {
+      loop.queueInLoop([&called] { ++called; });
+      if (i % 100 == 0)
+      {
+        ::usleep(1000);
+      }
+    }
+  });
+  producer.start();
+  loop.runAfter(0.5, [&loop] { loop.quit(); });
+  loop.loop();
+  producer.join();
+
+  const LoopStats& stats = loop.stats();
+  printf("%s", stats.toString().c_str());
+  BOOST_CHECK_EQUAL(fired, kTimers);
+  BOOST_CHECK_EQUAL(called, kFunctors);
+  BOOST_CHECK_EQUAL(stats.timerLateness.count(), kTimers + 1);
+  // one functor in 16 of the producer is sampled, the first one included
+  BOOST_CHECK_EQUAL(stats.queueDelay.count(), (kFunctors + 15) / 16);
+  BOOST_CHECK_GT(stats.pollWait.count(), 0);
+  BOOST_CHECK_EQUAL(stats.pollWait.count(), stats.activeChannels.count());
+  BOOST_CHECK_GT(stats.handleEvent.count(), 0);
+  // a timer is late by a poll return at most, far less than its period here
+  BOOST_CHECK_LT(stats.timerLateness.percentile(50), 100*1000);
+}
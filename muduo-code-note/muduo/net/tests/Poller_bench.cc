@@ -0,0 +1,94 @@
+// Cost of the Poller's channel registry with many registered fds:
+// each round makes some eventfds readable, and toggles write interest
+// of as many channels, all found by fd in the registry.
+
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+int main(int argc, char* argv[])
+{
+  int numChannels = argc > 1 ? atoi(argv[1]) : 10000;
+  int perRound = argc > 2 ? atoi(argv[2]) : 64;
+  int rounds = argc > 3 ? atoi(argv[3]) : 20000;
+
+  EventLoop loop;
+  std::vector<int> fds;
+  std::vector<std::unique_ptr<Channel>> channels;
+  int64_t events = 0;
+  for (int i = 0; i < numChannels; ++i)
+  {
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+      perror("eventfd, raise ulimit -n");
+      exit(1);
+    }
+    fds.push_back(fd);
+    channels.emplace_back(new Channel(&loop, fd));
+    channels.back()->setReadCallback([fd, &events](Timestamp) {
+      uint64_t one = 0;
+      ssize_t n = ::read(fd, &one, sizeof one);
+      assert(n == sizeof one); (void) n;
+      ++events;
+    });
+    channels.back()->enableReading();
+  }
+
+  std::minstd_rand rand;
+  int round = 0;
+  Timestamp start;
+  std::function<void()> kick = [&] {
+    if (round == 0)
+    {
+      start = Timestamp::now();
+    }
+    if (++round > rounds)
+    {
+      loop.quit();
+      return;
+    }
+    for (int i = 0; i < perRound; ++i)
+    {
+      size_t idx = rand() % channels.size();
+      uint64_t one = 1;
+      ssize_t n = ::write(fds[idx], &one, sizeof one);
+      assert(n == sizeof one); (void) n;
+      Channel* channel = channels[rand() % channels.size()].get();
+      channel->enableWriting();
+      channel->disableWriting();
+    }
+    loop.queueInLoop(kick);
+  };
+  // not queueInLoop(), which doesn't wake up a loop not yet looping
+  loop.runAfter(0.0, kick);
+  loop.loop();
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("%d channels, %lld events, %.1f ns per event and 2 updates\n",
+         numChannels, static_cast<long long>(events),
+         seconds * 1e9 / static_cast<double>(events));
+
+  for (auto& channel : channels)
+  {
+    channel->disableAll();
+    channel->remove();
+  }
+  for (int fd : fds)
+  {
+    ::close(fd);
+  }
+}
@@ -0,0 +1,155 @@
+// Benchmark of cross-thread task queues,
+// MpscQueue used by EventLoop vs. the former mutex protected vector.
+
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/MpscQueue.h>
+#include <muduo/base/Mutex.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+typedef std::function<void()> Functor;
+
+// what EventLoop::queueInLoop() did before
+class MutexQueue : noncopyable
+{
+ public:
+  void push(Functor f)
+  {
+    MutexLockGuard lock(mutex_);
+    functors_.push_back(std::move(f));
+  }
+
+  template<typename Func>
+  size_t consume(Func&& func)
+  {
+    std::vector<Functor> functors;
+    {
+    MutexLockGuard lock(mutex_);
+    functors.swap(functors_);
+    }
+    for (const Functor& f : functors)
+    {
+      func(f);
+    }
+    return functors.size();
+  }
+
+ private:
+  MutexLock mutex_;
+  std::vector<Functor> functors_ GUARDED_BY(mutex_);
+};
+
+int64_t g_sum = 0;
+
+void add(int x)
+{
+  g_sum += x;
+}
+
+template<typename Queue>
+void benchQueue(const char* name, int numProducers, int numPerProducer)
+{
+  Queue queue;
+  CountDownLatch latch(numProducers + 1);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < numProducers; ++i)
+  {
+    threads.emplace_back(new Thread([&queue, &latch, numPerProducer] {
+      latch.countDown();
+      latch.wait();
+      for (int j = 0; j < numPerProducer; ++j)
+      {
+        queue.push(std::bind(add, 1));
+      }
+    }));
+    threads.back()->start();
+  }
+
+  g_sum = 0;
+  const int64_t total = static_cast<int64_t>(numProducers) * numPerProducer;
+  latch.countDown();
+  latch.wait();
+  Timestamp start(Timestamp::now());
+  int64_t rounds = 0;
+  while (g_sum < total)
+  {
+    queue.consume([](const Functor& f) { f(); });
+    ++rounds;
+  }
+  double seconds = timeDifference(Timestamp::now(), start);
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  printf("%-12s %2d producers %10.0f ops/s, %8.1f ns/op, %" PRId64 " rounds\n",
+         name, numProducers, static_cast<double>(total) / seconds,
+         seconds * 1e9 / static_cast<double>(total), rounds);
+}
+
+void benchEventLoop(int numProducers, int numPerProducer)
+{
+  EventLoopThread loopThread;
+  EventLoop* loop = loopThread.startLoop();
+  std::atomic<int64_t> done(0);
+  const int64_t total = static_cast<int64_t>(numProducers) * numPerProducer;
+  CountDownLatch finished(1);
+  CountDownLatch latch(numProducers + 1);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < numProducers; ++i)
+  {
+    threads.emplace_back(new Thread([&, numPerProducer] {
+      latch.countDown();
+      latch.wait();
+      for (int j = 0; j < numPerProducer; ++j)
+      {
+        loop->queueInLoop([&] {
+          if (++done == total)
+          {
+            finished.countDown();
+          }
+        });
+      }
+    }));
+    threads.back()->start();
+  }
+
+  int64_t iterations = loop->iteration();
+  latch.countDown();
+  latch.wait();
+  Timestamp start(Timestamp::now());
+  finished.wait();
+  double seconds = timeDifference(Timestamp::now(), start);
+  iterations = loop->iteration() - iterations;
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  printf("queueInLoop  %2d producers %10.0f ops/s, %8.1f ns/op, %" PRId64 " loop iterations\n",
+         numProducers, static_cast<double>(total) / seconds,
+         seconds * 1e9 / static_cast<double>(total), iterations);
+}
+
+int main(int argc, char* argv[])
+{
+  int numPerProducer = argc > 1 ? atoi(argv[1]) : 1000000;
+  int maxProducers = argc > 2 ? atoi(argv[2]) : 8;
+  for (int producers = 1; producers <= maxProducers; producers *= 2)
+  {
+    benchQueue<MutexQueue>("mutex", producers, numPerProducer);
+    benchQueue<MpscQueue<Functor>>("mpsc", producers, numPerProducer);
+    benchEventLoop(producers, numPerProducer);
+  }
+}
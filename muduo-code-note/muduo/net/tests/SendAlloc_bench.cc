@@ -0,0 +1,161 @@
+// Counts heap allocations per cross-thread TcpConnection::send(),
+// and per cross-thread task with std::function vs. EventLoop::Functor.
+
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Logging.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <atomic>
+#include <functional>
+#include <new>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+std::atomic<int64_t> g_allocations(0);
+
+void* operator new(size_t size)
+{
+  ++g_allocations;
+  void* p = ::malloc(size == 0 ? 1 : size);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  ::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  ::free(p);
+}
+
+class Sink
+{
+ public:
+  Sink() : bytes_(0) { }
+
+  void sendInLoop(const string& message)
+  {
+    bytes_ += message.size();
+  }
+
+  size_t bytes() const { return bytes_; }
+
+ private:
+  size_t bytes_;
+};
+
+// the closure of a cross-thread TcpConnection::send(), type erased as before and now.
+void benchClosure(const string& message, int times)
+{
+  Sink sink;
+  void (Sink::*fp)(const string&) = &Sink::sendInLoop;
+
+  int64_t before = g_allocations.load();
+  {
+    std::vector<std::function<void()>> functors;
+    functors.reserve(times);
+    before = g_allocations.load();
+    for (int i = 0; i < times; ++i)
+    {
+      functors.push_back(std::bind(fp, &sink, message));
+    }
+  }
+  double stdFunction = static_cast<double>(g_allocations.load() - before) / times;
+
+  {
+    std::vector<EventLoop::Functor> functors;
+    functors.reserve(times);
+    before = g_allocations.load();
+    for (int i = 0; i < times; ++i)
+    {
+      functors.push_back(std::bind(fp, &sink, message));
+    }
+  }
+  double inlineFunction = static_cast<double>(g_allocations.load() - before) / times;
+
+  printf("closure with %4zd bytes message: std::function %.2f, EventLoop::Functor %.2f allocations\n",
+         message.size(), stdFunction, inlineFunction);
+}
+
+// a real connection, sending from other thread to the loop of the connection,
+// counts allocations of the whole process, including the receiving side.
+void benchSend(const string& message, int times, uint16_t port)
+{
+  EventLoop loop;
+  EventLoopThread clientThread;
+  EventLoop* clientLoop = clientThread.startLoop();
+
+  TcpServer server(&loop, InetAddress(port, true), "SendAlloc");
+  TcpConnectionPtr connection;
+  CountDownLatch connected(1);
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      connection = conn;
+      connected.countDown();
+    }
+  });
+  server.start();
+
+  const size_t total = message.size() * times;
+  size_t received = 0;
+  CountDownLatch done(1);
+  TcpClient client(clientLoop, InetAddress(port, true), "SendAllocClient");
+  client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    received += buf->readableBytes();
+    buf->retrieveAll();
+    if (received == total)
+    {
+      done.countDown();
+    }
+  });
+  client.connect();
+
+  Thread sender([&] {
+    connected.wait();
+    int64_t before = g_allocations.load();
+    Timestamp start(Timestamp::now());
+    for (int i = 0; i < times; ++i)
+    {
+      connection->send(message);
+    }
+    done.wait();
+    double seconds = timeDifference(Timestamp::now(), start);
+    double perSend = static_cast<double>(g_allocations.load() - before) / times;
+    printf("send() from other thread, %4zd bytes message: %.2f allocations, %.0f ns\n",
+           message.size(), perSend, seconds * 1e9 / times);
+    client.disconnect();
+    loop.quit();
+  });
+  sender.start();
+  loop.loop();
+  sender.join();
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  int times = argc > 1 ? atoi(argv[1]) : 100000;
+  uint16_t port = static_cast<uint16_t>(argc > 2 ? atoi(argv[2]) : 2019);
+  benchClosure("hello", times);
+  benchClosure(string(100, 'x'), times);
+  benchSend("hello", times, port);
+  benchSend(string(100, 'x'), times, port);
+}
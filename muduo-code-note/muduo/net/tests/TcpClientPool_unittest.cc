@@ -0,0 +1,190 @@
+// A pool of four clients to two echo servers, in two loop threads.
+// Requests are 4-byte ids, leased from the base thread and released when
+// their echo comes back; they spread over all clients. Two failed
+// requests in a row evict their connection, which comes back after a
+// while. A failed lease of the evicted connection doesn't count against
+// the new one.
+
+#include <muduo/base/Histogram.h>
+#include <muduo/base/Logging.h>
+#include <muduo/base/Mutex.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClientPool.h>
+#include <muduo/net/TcpServer.h>
+
+#include <map>
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int kClients = 4;
+const int kRequests = 400;
+const int kHeld = 4;  // leases per client held in the evicting step
+
+void onEcho(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+  conn->send(buf);
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout\n");
+    abort();
+  });
+
+  InetAddress addr1(2040, true);
+  InetAddress addr2(2041, true);
+  TcpServer server1(&loop, addr1, "Echo1");
+  TcpServer server2(&loop, addr2, "Echo2");
+  server1.setMessageCallback(onEcho);
+  server2.setMessageCallback(onEcho);
+  server1.start();
+  server2.start();
+
+  TcpClientPool pool(&loop, "Pool");
+  pool.addServer(addr1);
+  pool.addServer(addr2);
+  pool.setConnectionsPerServer(kClients / 2);
+  pool.setThreadNum(2);
+  pool.setRetryDelay(10, 100);
+  pool.setMaxFailures(2);
+
+  MutexLock mutex;
+  std::map<int32_t, TcpClientPool::Lease> leases;
+  AtomicInt32 answered;
+  pool.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    while (buf->readableBytes() >= sizeof(int32_t))
+    {
+      int32_t id = buf->readInt32();
+      TcpClientPool::Lease lease;
+      {
+        MutexLockGuard lock(mutex);
+        lease = leases[id];
+        leases.erase(id);
+      }
+      pool.release(lease, true);
+      answered.increment();
+    }
+  });
+  pool.start();
+  assert(pool.numClients() == kClients);
+
+  int perClient[kClients] = { 0 };
+  std::vector<TcpClientPool::Lease> held;
+  int victim = -1;
+  // release in the loop of the connection, in order
+  auto release = [&pool](const TcpClientPool::Lease& lease, bool success) {
+    lease.connection->getLoop()->runInLoop([&pool, lease, success] {
+      pool.release(lease, success);
+    });
+  };
+  enum { kConnecting, kRequesting, kEvicting, kStale, kStopping } step = kConnecting;
+  loop.runEvery(0.01, [&] {
+    if (step == kConnecting && pool.numConnected() == kClients)
+    {
+      for (int32_t id = 0; id < kRequests; ++id)
+      {
+        TcpClientPool::Lease lease = pool.acquire();
+        assert(lease.connection);
+        ++perClient[lease.index];
+        {
+          MutexLockGuard lock(mutex);
+          leases[id] = lease;
+        }
+        Buffer request;
+        request.appendInt32(id);
+        lease.connection->send(&request);
+      }
+      step = kRequesting;
+    }
+    else if (step == kRequesting && answered.get() == kRequests)
+    {
+      // fewest pending first, every client gets kHeld
+      int perIndex[kClients] = { 0 };
+      for (int i = 0; i < kClients * kHeld; ++i)
+      {
+        held.push_back(pool.acquire());
+        ++perIndex[held.back().index];
+      }
+      for (int i = 0; i < kClients; ++i)
+      {
+        assert(perIndex[i] == kHeld);
+      }
+      victim = held[0].index;
+      int failed = 0;
+      for (const auto& lease : held)
+      {
+        if (lease.index == victim && failed < 2)
+        {
+          release(lease, false);
+          ++failed;
+        }
+      }
+      step = kEvicting;
+    }
+    else if (step == kEvicting && pool.stats().find("evicted 1") != string::npos &&
+             pool.numConnected() == kClients)
+    {
+      // evicted and connected again, the new connection has no pending
+      TcpClientPool::Lease fresh = pool.acquire();
+      assert(fresh.index == victim);
+      int skipped = 0;
+      for (const auto& lease : held)
+      {
+        if (lease.index == victim && ++skipped == 3)
+        {
+          // stale, of the evicted connection
+          release(lease, false);
+        }
+      }
+      // the first failure of the new connection, no eviction
+      release(fresh, false);
+      int victimLeases = 0;
+      for (const auto& lease : held)
+      {
+        if (lease.index != victim || ++victimLeases > 3)
+        {
+          release(lease, true);
+        }
+      }
+      step = kStale;
+    }
+    else if (step == kStale &&
+             pool.stats().find("requests 417 failed 4") != string::npos)
+    {
+      // a lease keeps its connection, and the socket of the evicted one, open
+      held.clear();
+      pool.stop();
+      step = kStopping;
+    }
+    else if (step == kStopping && pool.numConnected() == 0 &&
+             loop.numConnections() == 0)
+    {
+      TcpClientPool::Lease none = pool.acquire();
+      assert(!none.connection && none.index < 0);
+      loop.quit();
+    }
+  });
+  loop.loop();
+
+  for (int i = 0; i < kClients; ++i)
+  {
+    // least pending first, not necessarily an even split
+    assert(perClient[i] > 0);
+  }
+  Histogram latency;
+  pool.latency(&latency);
+  assert(latency.count() == kRequests + kClients * kHeld + 1);
+  string stats = pool.stats();
+  printf("%s\n", stats.c_str());
+  assert(stats.find("requests 417 failed 4 evicted 1 unavailable 1") != string::npos);
+}
@@ -0,0 +1,143 @@
+// A producer writes fast into a relay, a consumer reads slowly out of it.
+// The relay must pause the producer instead of queueing everything,
+// and deliver every byte in order, then close both sides.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpRelay.h>
+#include <muduo/net/TcpServer.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kTotal = 32 * 1024 * 1024;
+const size_t kChunk = 1024 * 1024;
+const size_t kHighWaterMark = 256 * 1024;
+const size_t kLowWaterMark = 64 * 1024;
+
+char expectedByte(size_t offset)
+{
+  return static_cast<char>('a' + offset % 26);
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  EventLoop loop;
+  loop.runAfter(60.0, [] {
+    fprintf(stderr, "timeout, relay stuck\n");
+    abort();
+  });
+
+  // all four connections are closed before quitting
+  int disconnected = 0;
+  auto onDisconnected = [&] {
+    if (++disconnected == 4)
+    {
+      loop.quit();
+    }
+  };
+
+  InetAddress relayAddr(2036, true);
+  TcpServer server(&loop, relayAddr, "RelayServer");
+  TcpConnectionPtr producerSide;
+  TcpRelayPtr relay;
+  size_t maxPending = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      if (!producerSide)
+      {
+        // holds input until the consumer is there
+        conn->stopRead();
+        producerSide = conn;
+      }
+      else
+      {
+        relay.reset(new TcpRelay(producerSide, conn));
+        producerSide.reset();
+        relay->setWaterMarks(kHighWaterMark, kLowWaterMark);
+        relay->start();
+        std::weak_ptr<TcpConnection> consumerSide(conn);
+        loop.runEvery(0.001, [consumerSide, &maxPending] {
+          TcpConnectionPtr c(consumerSide.lock());
+          if (c)
+          {
+            maxPending = std::max(maxPending, c->outputBuffer()->readableBytes());
+          }
+        });
+      }
+    }
+    else
+    {
+      if (relay)
+      {
+        relay->stop();
+      }
+      onDisconnected();
+    }
+  });
+  server.start();
+
+  TcpClient consumer(&loop, relayAddr, "Consumer");
+  size_t received = 0;
+  consumer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (!conn->connected())
+    {
+      onDisconnected();
+    }
+  });
+  consumer.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    size_t n = buf->readableBytes();
+    for (size_t i = 0; i < n; ++i)
+    {
+      assert(buf->peek()[i] == expectedByte(received + i));
+    }
+    buf->retrieveAll();
+    if ((received + n) / kChunk != received / kChunk)
+    {
+      // slow consumer
+      conn->stopRead();
+      loop.runAfter(0.01, [conn] { conn->startRead(); });
+    }
+    received += n;
+  });
+
+  TcpClient producer(&loop, relayAddr, "Producer");
+  producer.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      consumer.connect();
+      string data;
+      for (size_t i = 0; i < kTotal; ++i)
+      {
+        data.push_back(expectedByte(i));
+      }
+      conn->send(data);
+      conn->shutdown();
+    }
+    else
+    {
+      onDisconnected();
+    }
+  });
+  producer.connect();
+  loop.loop();
+
+  printf("received %zd bytes, relayed %" PRId64 ", paused %" PRId64 " times, max pending %zd\n",
+         received, relay->bytesToSecond(), relay->numPauses(), maxPending);
+  assert(received == kTotal);
+  assert(relay->bytesToSecond() == static_cast<int64_t>(kTotal));
+  assert(relay->numPauses() > 0);
+  // a read may land on top of the high water mark
+  assert(maxPending < kHighWaterMark + 256 * 1024);
+}
@@ -0,0 +1,132 @@
+#include <muduo/net/TimerWheel.h>
+#include <muduo/net/Timer.h>
+
+//#define BOOST_TEST_MODULE TimerWheelTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using muduo::MonotonicTime;
+using muduo::net::Timer;
+using muduo::net::TimerWheel;
+
+namespace
+{
+const MonotonicTime kStart(1500000000LL * MonotonicTime::kMicroSecondsPerSecond);
+
+MonotonicTime after(double seconds)
+{
+  return muduo::addTime(kStart, seconds);
+}
+
+void noop()
+{
+}
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelExpire)
+{
+  TimerWheel wheel(kStart);
+  std::vector<Timer*> expired;
+  Timer* t1 = wheel.newTimer(noop, after(0.0105), 0.0);
+  BOOST_CHECK(wheel.insert(t1));
+  BOOST_CHECK(TimerWheel::contains(t1));
+  BOOST_CHECK(wheel.earliest() == after(0.011));
+
+  Timer* t2 = wheel.newTimer(noop, after(0.5), 0.0);
+  BOOST_CHECK(!wheel.insert(t2));
+  BOOST_CHECK_EQUAL(wheel.size(), 2);
+
+  wheel.takeExpired(after(0.010), &expired);
+  BOOST_CHECK(expired.empty());
+  wheel.takeExpired(after(0.011), &expired);
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK(expired[0] == t1);
+  BOOST_CHECK(!TimerWheel::contains(t1));
+  wheel.release(t1);
+
+  // stays in the second level until cascaded
+  BOOST_CHECK(wheel.earliest() <= after(0.5));
+  expired.clear();
+  wheel.takeExpired(after(0.499), &expired);
+  BOOST_CHECK(expired.empty());
+  wheel.takeExpired(after(0.6), &expired);
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  BOOST_CHECK(expired[0] == t2);
+  wheel.release(t2);
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+  BOOST_CHECK(!wheel.earliest().valid());
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelCancel)
+{
+  TimerWheel wheel(kStart);
+  Timer* t1 = wheel.newTimer(noop, after(3.0), 0.0);
+  int64_t seq = t1->sequence();
+  wheel.insert(t1);
+  wheel.remove(t1);
+  BOOST_CHECK(!TimerWheel::contains(t1));
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+  wheel.release(t1);
+  BOOST_CHECK_EQUAL(t1->sequence(), 0);
+
+  // recycled, with a new sequence
+  Timer* t2 = wheel.newTimer(noop, after(1.0), 0.0);
+  BOOST_CHECK(t2 == t1);
+  BOOST_CHECK(t2->sequence() > seq);
+  wheel.insert(t2);
+
+  std::vector<Timer*> expired;
+  wheel.takeExpired(after(5.0), &expired);
+  BOOST_REQUIRE_EQUAL(expired.size(), 1);
+  wheel.release(t2);
+}
+
+// jumps from wakeup to wakeup, like the timerfd does
+BOOST_AUTO_TEST_CASE(testTimerWheelCascade)
+{
+  TimerWheel wheel(kStart);
+  std::vector<Timer*> timers;
+  uint32_t seed = 1;
+  for (int i = 0; i < 2000; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    double seconds = (seed >> 8) % 100000000 / 1000.0;  // up to 27 hours
+    if (i % 4 == 0)
+    {
+      seconds /= 1000.0;
+    }
+    Timer* timer = wheel.newTimer(noop, after(seconds), 0.0);
+    wheel.insert(timer);
+    timers.push_back(timer);
+  }
+  Timer* far = wheel.newTimer(noop, after(60 * 86400.0), 0.0);  // beyond the last level
+  wheel.insert(far);
+
+  std::vector<Timer*> expired;
+  size_t fired = 0;
+  int wakeups = 0;
+  MonotonicTime last = kStart;
+  while (wheel.size() > 0)
+  {
+    MonotonicTime now = wheel.earliest();
+    BOOST_REQUIRE(now.valid());
+    BOOST_REQUIRE(!(now < last));
+    last = now;
+    expired.clear();
+    wheel.takeExpired(now, &expired);
+    ++wakeups;
+    for (Timer* timer : expired)
+    {
+      BOOST_CHECK(!(now < timer->expiration()));
+      BOOST_CHECK(muduo::timeDifference(now, timer->expiration()) < 0.001);
+      wheel.release(timer);
+      ++fired;
+    }
+  }
+  BOOST_CHECK_EQUAL(fired, timers.size() + 1);
+  BOOST_CHECK(last == after(60 * 86400.0));
+  BOOST_CHECK(wakeups < 10000);
+}
@@ -0,0 +1,99 @@
+// Echoes datagrams over loopback with UdpServer, in rounds of a batch,
+// once plain and once with GSO/GRO when the kernel supports them,
+// every datagram must come back whole and in its own callback.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/UdpServer.h>
+#include <muduo/net/UdpSocket.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int kRounds = 40;
+const int kPerRound = 16;
+const size_t kDatagramSize = 1200;
+
+// the last datagram of a round is shorter, it still fits a GSO group
+size_t datagramSize(int index)
+{
+  return index % kPerRound == kPerRound - 1 ? kDatagramSize / 2 : kDatagramSize;
+}
+
+string makeDatagram(int index)
+{
+  string datagram(datagramSize(index), static_cast<char>('a' + index % 26));
+  memcpy(&datagram[0], &index, sizeof index);
+  return datagram;
+}
+
+void runEcho(bool offload)
+{
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, datagrams lost\n");
+    abort();
+  });
+
+  InetAddress serverAddr(2032, true);
+  UdpServer server(&loop, serverAddr, "UdpEchoServer");
+  server.setGso(offload);
+  server.setGro(offload);
+  server.setDatagramCallback([](UdpSocket* sock, const InetAddress& peerAddr,
+                                StringPiece datagram, Timestamp) {
+    sock->send(peerAddr, datagram);
+  });
+  server.start();
+
+  UdpSocket client(&loop, "UdpEchoClient");
+  client.connect(serverAddr);
+  bool gso = offload && client.setGso(true);
+  bool gro = offload && client.setGro(true);
+  int received = 0;
+  client.setDatagramCallback([&](UdpSocket*, const InetAddress& peerAddr,
+                                 StringPiece datagram, Timestamp) {
+    assert(peerAddr.toIpPort() == serverAddr.toIpPort()); (void) peerAddr;
+    int index = -1;
+    assert(datagram.size() >= static_cast<int>(sizeof index));
+    memcpy(&index, datagram.data(), sizeof index);
+    assert(datagram == makeDatagram(index));
+    ++received;
+    if (received == kRounds * kPerRound)
+    {
+      loop.quit();
+    }
+  });
+  client.start();
+
+  int round = 0;
+  loop.runEvery(0.005, [&] {
+    if (round < kRounds)
+    {
+      for (int i = 0; i < kPerRound; ++i)
+      {
+        client.send(makeDatagram(round * kPerRound + i));
+      }
+      ++round;
+    }
+  });
+  loop.loop();
+
+  printf("gso %d gro %d: sent %" PRId64 " received %d dropped %" PRId64 "\n",
+         gso, gro, client.numSent(), received, client.numDropped());
+  assert(received == kRounds * kPerRound);
+  assert(client.numSent() == kRounds * kPerRound);
+  assert(client.numDropped() == 0);
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  runEcho(false);
+  runEcho(true);
+}
@@ -0,0 +1,129 @@
+// Datagrams per second echoed by one UDP server loop,
+// one recvfrom/sendto per datagram vs. UdpSocket batches vs. GSO/GRO.
+//
+// The client keeps a window of datagrams in flight, sending a new one
+// for each echo, both ends in one loop, so the cost per datagram
+// of both sides is measured.
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/Socket.h>
+#include <muduo/net/SocketsOps.h>
+#include <muduo/net/UdpSocket.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void naiveEcho(int sockfd)
+{
+  char buf[65536];
+  while (true)
+  {
+    struct sockaddr_in6 peer;
+    socklen_t len = static_cast<socklen_t>(sizeof peer);
+    ssize_t n = ::recvfrom(sockfd, buf, sizeof buf, 0, sockets::sockaddr_cast(&peer), &len);
+    if (n < 0)
+    {
+      if (errno != EAGAIN)
+      {
+        LOG_SYSERR << "recvfrom";
+      }
+      break;
+    }
+    if (::sendto(sockfd, buf, static_cast<size_t>(n), 0, sockets::sockaddr_cast(&peer), len) < 0)
+    {
+      LOG_SYSERR << "sendto";
+    }
+  }
+}
+
+void bench(const char* mode, size_t size, int window, double seconds, uint16_t port)
+{
+  EventLoop loop;
+  InetAddress serverAddr(port, true);
+  const bool naive = strcmp(mode, "naive") == 0;
+  const bool offload = strcmp(mode, "gso") == 0;
+
+  UdpSocket server(&loop, "UdpBenchServer");
+  server.bindAddress(serverAddr);
+  server.setGso(offload);
+  server.setGro(offload);
+  server.setMaxDatagramSize(size);
+  Channel naiveChannel(&loop, server.fd());
+  if (naive)
+  {
+    naiveChannel.setReadCallback(std::bind(naiveEcho, server.fd()));
+    naiveChannel.enableReading();
+  }
+  else
+  {
+    server.setDatagramCallback([](UdpSocket* sock, const InetAddress& peerAddr,
+                                  StringPiece datagram, Timestamp) {
+      sock->send(peerAddr, datagram);
+    });
+    server.start();
+  }
+
+  const string message(size, 'x');
+  UdpSocket client(&loop, "UdpBenchClient");
+  client.connect(serverAddr);
+  client.setGso(offload);
+  client.setGro(offload);
+  client.setMaxDatagramSize(size);
+  int64_t echoed = 0;
+  client.setDatagramCallback([&](UdpSocket* sock, const InetAddress&,
+                                 StringPiece, Timestamp) {
+    ++echoed;
+    sock->send(message);
+  });
+  client.start();
+
+  Timestamp start;
+  loop.runAfter(0.0, [&] {
+    start = Timestamp::now();
+    for (int i = 0; i < window; ++i)
+    {
+      client.send(message);
+    }
+  });
+  loop.runAfter(seconds, [&] { loop.quit(); });
+  loop.loop();
+
+  double elapsed = timeDifference(Timestamp::now(), start);
+  printf("%-5s size %5zd window %3d: %10.0f datagrams/s %8.2f MiB/s, client dropped %" PRId64 "\n",
+         mode, size, window, static_cast<double>(echoed) / elapsed,
+         static_cast<double>(echoed) * static_cast<double>(size) / elapsed / 1024 / 1024,
+         client.numDropped());
+  if (naive)
+  {
+    naiveChannel.disableAll();
+    naiveChannel.remove();
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Logger::setLogLevel(Logger::WARN);
+  size_t size = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 1200;
+  int window = argc > 2 ? atoi(argv[2]) : 64;
+  double seconds = argc > 3 ? atof(argv[3]) : 3.0;
+  if (argc > 4)
+  {
+    bench(argv[4], size, window, seconds, 2033);
+  }
+  else
+  {
+    bench("naive", size, window, seconds, 2033);
+    bench("batch", size, window, seconds, 2033);
+    bench("gso", size, window, seconds, 2033);
+  }
+}
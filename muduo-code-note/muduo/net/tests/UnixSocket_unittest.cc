@@ -0,0 +1,137 @@
+// TcpServer and TcpClient over Unix domain sockets, a path and an abstract
+// name, then a pipe handed from the client to the server with SCM_RIGHTS.
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+void testEcho(const InetAddress& listenAddr)
+{
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, echo over unix domain stuck\n");
+    abort();
+  });
+  TcpServer server(&loop, listenAddr, "UnixServer");
+  string serverLocal;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      serverLocal = conn->localAddress().toIpPort();
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  TcpClient client(&loop, listenAddr, "UnixClient");
+  string echoed;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->send("hello");
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    echoed += buf->retrieveAllAsString();
+    if (echoed.size() >= 5)
+    {
+      conn->shutdown();
+    }
+  });
+  client.connect();
+  loop.loop();
+  printf("%s echoed %s\n", serverLocal.c_str(), echoed.c_str());
+  assert(echoed == "hello");
+  assert(serverLocal == listenAddr.toIpPort());
+}
+
+void testFdPassing(const InetAddress& listenAddr)
+{
+  EventLoop loop;
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout, fd passing stuck\n");
+    abort();
+  });
+  TcpServer server(&loop, listenAddr, "FdServer");
+  server.setConnectionCallback([](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->setFdPassing(true);
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    buf->retrieveAll();
+    std::vector<int> fds = conn->takeReceivedFds();
+    for (int fd : fds)
+    {
+      // reads what the client wrote into the pipe it passed us
+      char data[64];
+      ssize_t n = ::read(fd, data, sizeof data);
+      assert(n > 0);
+      conn->send(data, static_cast<int>(n));
+      ::close(fd);
+    }
+  });
+  server.start();
+
+  TcpClient client(&loop, listenAddr, "FdClient");
+  string echoed;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      int pipefd[2];
+      int ret = ::pipe(pipefd);
+      assert(ret == 0); (void)ret;
+      ssize_t n = ::write(pipefd[1], "through the pipe", 16);
+      assert(n == 16); (void)n;
+      bool sent = conn->sendFd(pipefd[0], "fd");
+      assert(sent); (void)sent;
+      ::close(pipefd[0]);
+      ::close(pipefd[1]);
+    }
+    else
+    {
+      loop.quit();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    echoed += buf->retrieveAllAsString();
+    if (echoed.size() >= 16)
+    {
+      conn->shutdown();
+    }
+  });
+  client.connect();
+  loop.loop();
+  printf("passed fd, read back %s\n", echoed.c_str());
+  assert(echoed == "through the pipe");
+}
+
+int main()
+{
+  Logger::setLogLevel(Logger::WARN);
+  char path[64];
+  snprintf(path, sizeof path, "/tmp/muduo_unixsocket_unittest.%d", getpid());
+  testEcho(InetAddress::unixDomain(path));
+  testEcho(InetAddress::unixDomain("muduo_unixsocket_unittest", true));
+  testFdPassing(InetAddress::unixDomain(path));
+  ::unlink(path);
+}
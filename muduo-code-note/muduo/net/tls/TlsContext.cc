@@ -0,0 +1,162 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/tls/TlsContext.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/tls/TlsTransport.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+string lastError()
+{
+  char buf[256];
+  ERR_error_string_n(ERR_get_error(), buf, sizeof buf);
+  ERR_clear_error();
+  return buf;
+}
+
+// fails verification, for clients that wouldn't know whom they verified
+int rejectPeer(int, X509_STORE_CTX* store)
+{
+  X509_STORE_CTX_set_error(store, X509_V_ERR_HOSTNAME_MISMATCH);
+  return 0;
+}
+
+}  // namespace
+
+TlsContext::TlsContext(Role role)
+  : ctx_(SSL_CTX_new(role == kServer ? TLS_server_method() : TLS_client_method())),
+    role_(role),
+    numHandshakes_(0),
+    numKernelSend_(0),
+    numKernelRecv_(0)
+{
+  if (ctx_ == NULL)
+  {
+    LOG_FATAL << "SSL_CTX_new " << lastError();
+  }
+  SSL_CTX_set_min_proto_version(ctx_, TLS1_2_VERSION);
+  // a write that can't finish is retried from another place in the
+  // output buffer, with at least as many bytes.
+  SSL_CTX_set_mode(ctx_, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                         SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER |
+                         SSL_MODE_RELEASE_BUFFERS);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+  // a peer closing without close_notify is an ordinary end of stream
+  SSL_CTX_set_options(ctx_, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+  setKernelTls(true);
+  if (role_ == kClient)
+  {
+    setVerifyPeer(true);
+    SSL_CTX_set_default_verify_paths(ctx_);
+  }
+}
+
+TlsContext::~TlsContext()
+{
+  SSL_CTX_free(ctx_);
+}
+
+bool TlsContext::loadCertificate(const string& certFile, const string& keyFile)
+{
+  if (SSL_CTX_use_certificate_chain_file(ctx_, certFile.c_str()) != 1)
+  {
+    LOG_ERROR << "TlsContext::loadCertificate " << certFile << " " << lastError();
+    return false;
+  }
+  if (SSL_CTX_use_PrivateKey_file(ctx_, keyFile.c_str(), SSL_FILETYPE_PEM) != 1 ||
+      SSL_CTX_check_private_key(ctx_) != 1)
+  {
+    LOG_ERROR << "TlsContext::loadCertificate " << keyFile << " " << lastError();
+    return false;
+  }
+  return true;
+}
+
+bool TlsContext::loadVerifyLocations(const string& caFile)
+{
+  int ret = caFile.empty() ? SSL_CTX_set_default_verify_paths(ctx_)
+                           : SSL_CTX_load_verify_locations(ctx_, caFile.c_str(), NULL);
+  if (ret != 1)
+  {
+    LOG_ERROR << "TlsContext::loadVerifyLocations " << caFile << " " << lastError();
+    return false;
+  }
+  return true;
+}
+
+void TlsContext::setVerifyPeer(bool on)
+{
+  int mode = SSL_VERIFY_NONE;
+  if (on)
+  {
+    mode = SSL_VERIFY_PEER;
+    if (role_ == kServer)
+    {
+      mode |= SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
+    }
+  }
+  SSL_CTX_set_verify(ctx_, mode, NULL);
+}
+
+void TlsContext::setKernelTls(bool on)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+  if (on)
+  {
+    SSL_CTX_set_options(ctx_, SSL_OP_ENABLE_KTLS);
+  }
+  else
+  {
+    SSL_CTX_clear_options(ctx_, SSL_OP_ENABLE_KTLS);
+  }
+#else
+  (void)on;
+#endif
+}
+
+TransportFactory TlsContext::transportFactory()
+{
+  return std::bind(&TlsContext::newTransport, this);
+}
+
+std::unique_ptr<Transport> TlsContext::newTransport()
+{
+  SSL* ssl = SSL_new(ctx_);
+  if (ssl == NULL)
+  {
+    LOG_FATAL << "SSL_new " << lastError();
+  }
+  if (role_ == kServer)
+  {
+    SSL_set_accept_state(ssl);
+  }
+  else
+  {
+    SSL_set_connect_state(ssl);
+    if (!serverName_.empty())
+    {
+      // SSL_set_tlsext_host_name(), without its old-style cast
+      SSL_ctrl(ssl, SSL_CTRL_SET_TLSEXT_HOSTNAME, TLSEXT_NAMETYPE_host_name,
+               const_cast<char*>(serverName_.c_str()));
+      SSL_set1_host(ssl, serverName_.c_str());
+    }
+    else if (SSL_CTX_get_verify_mode(ctx_) & SSL_VERIFY_PEER)
+    {
+      // any certificate the CAs signed would do, that's no check at all
+      LOG_ERROR << "TlsContext::newTransport no server name to verify, "
+                   "setServerName() or setVerifyPeer(false)";
+      SSL_set_verify(ssl, SSL_VERIFY_PEER, rejectPeer);
+    }
+  }
+  return std::unique_ptr<Transport>(new TlsTransport(this, ssl));
+}
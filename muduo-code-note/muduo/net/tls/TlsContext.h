@@ -0,0 +1,80 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_TLS_TLSCONTEXT_H
+#define MUDUO_NET_TLS_TLSCONTEXT_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Types.h>
+#include <muduo/net/Callbacks.h>
+
+#include <atomic>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// TLS settings shared by connections of a TcpServer or TcpClient.
+///
+/// Connections handshake with OpenSSL in their loop, then OpenSSL hands
+/// the record layer to kernel TLS (TCP_ULP "tls") where the kernel and
+/// the cipher allow, writes and sendfile(2) of the connection then go
+/// straight to the socket. Otherwise records are encrypted in user space.
+///
+/// Must outlive the connections it makes.
+class TlsContext : noncopyable
+{
+ public:
+  enum Role { kServer, kClient };
+
+  explicit TlsContext(Role role);
+  ~TlsContext();
+
+  /// PEM files, the server's chain and private key.
+  /// @return false if they can't be used, the reason is logged.
+  bool loadCertificate(const string& certFile, const string& keyFile);
+  /// Peers are verified against CAs in the PEM file, the system's CAs
+  /// if it's empty. Clients verify the server by default.
+  bool loadVerifyLocations(const string& caFile);
+  void setVerifyPeer(bool on);
+  /// Client only, sent as SNI and checked against the server's certificate.
+  /// Required while the server is verified, handshakes fail without it,
+  /// as any certificate of the CAs would pass.
+  void setServerName(const string& hostname)
+  { serverName_ = hostname; }
+  /// On by default, off always encrypts in user space.
+  void setKernelTls(bool on);
+
+  /// For TcpServer::setTransportFactory(), thread safe.
+  TransportFactory transportFactory();
+
+  SSL_CTX* nativeHandle() { return ctx_; }
+
+  // statistics, of finished handshakes
+  int64_t numHandshakes() const { return numHandshakes_.load(std::memory_order_relaxed); }
+  int64_t numKernelSend() const { return numKernelSend_.load(std::memory_order_relaxed); }
+  int64_t numKernelRecv() const { return numKernelRecv_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class TlsTransport;
+
+  std::unique_ptr<Transport> newTransport();
+
+  SSL_CTX* ctx_;
+  const Role role_;
+  string serverName_;
+  std::atomic<int64_t> numHandshakes_;
+  std::atomic<int64_t> numKernelSend_;
+  std::atomic<int64_t> numKernelRecv_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TLS_TLSCONTEXT_H
@@ -0,0 +1,236 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+#include <muduo/net/tls/TlsTransport.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/net/tls/TlsContext.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+// the largest TLS record, a write retried after EAGAIN must cover
+// the record that was pending.
+const size_t kMaxRecord = 16 * 1024;
+// stop reading once this much is in the buffer, unless OpenSSL holds
+// decrypted bytes, the socket stays readable for the rest.
+const size_t kMaxRead = 64 * 1024;
+
+void increment(std::atomic<int64_t>* counter)
+{
+  counter->fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+TlsTransport::TlsTransport(TlsContext* context, SSL* ssl)
+  : context_(context),
+    ssl_(ssl),
+    attached_(false),
+    kernelSend_(false)
+{
+}
+
+TlsTransport::~TlsTransport()
+{
+  SSL_free(ssl_);
+}
+
+Transport::HandshakeResult TlsTransport::handshake(int fd)
+{
+  if (!attached_)
+  {
+    // a socket BIO, which OpenSSL switches to kernel TLS after the handshake
+    SSL_set_fd(ssl_, fd);
+    attached_ = true;
+  }
+  ERR_clear_error();
+  int ret = SSL_do_handshake(ssl_);
+  if (ret == 1)
+  {
+    kernelSend_ = BIO_get_ktls_send(SSL_get_wbio(ssl_));
+    bool kernelRecv = BIO_get_ktls_recv(SSL_get_rbio(ssl_));
+    increment(&context_->numHandshakes_);
+    if (kernelSend_)
+    {
+      increment(&context_->numKernelSend_);
+    }
+    if (kernelRecv)
+    {
+      increment(&context_->numKernelRecv_);
+    }
+    LOG_DEBUG << "fd " << fd << " " << SSL_get_version(ssl_) << " "
+              << SSL_get_cipher_name(ssl_) << " kernel send " << kernelSend_
+              << " kernel recv " << kernelRecv;
+    return kHandshakeDone;
+  }
+  int err = SSL_get_error(ssl_, ret);
+  if (err == SSL_ERROR_WANT_READ)
+  {
+    return kWantRead;
+  }
+  if (err == SSL_ERROR_WANT_WRITE)
+  {
+    return kWantWrite;
+  }
+  char buf[256];
+  ERR_error_string_n(ERR_get_error(), buf, sizeof buf);
+  LOG_ERROR << "TlsTransport::handshake fd " << fd << " " << buf
+            << " verify " << X509_verify_cert_error_string(SSL_get_verify_result(ssl_));
+  return kHandshakeFailed;
+}
+
+ssize_t TlsTransport::read(int fd, Buffer* buf, int* savedErrno)
+{
+  size_t total = 0;
+  while (true)
+  {
+    buf->ensureWritableBytes(kMaxRecord);
+    size_t n = 0;
+    ERR_clear_error();
+    int ret = SSL_read_ex(ssl_, buf->beginWrite(), buf->writableBytes(), &n);
+    if (ret == 1)
+    {
+      buf->hasWritten(n);
+      total += n;
+      if (total >= kMaxRead && SSL_pending(ssl_) == 0)
+      {
+        break;
+      }
+      continue;
+    }
+
+    int err = SSL_get_error(ssl_, ret);
+    if (err == SSL_ERROR_ZERO_RETURN ||
+        (err == SSL_ERROR_SYSCALL && errno == 0))
+    {
+      if (total > 0)
+      {
+        // the end comes with the next event
+        ::shutdown(fd, SHUT_RD);
+        break;
+      }
+      return 0;
+    }
+    int e = errorToErrno(ret, "TlsTransport::read");
+    if (total > 0)
+    {
+      break;
+    }
+    if (e == EIO)
+    {
+      // the stream can't be decrypted any more, as if it ended
+      return 0;
+    }
+    *savedErrno = e;
+    return -1;
+  }
+  return static_cast<ssize_t>(total);
+}
+
+ssize_t TlsTransport::writev(int fd, const struct iovec* iov, int iovcnt, int* savedErrno)
+{
+  if (kernelSend_)
+  {
+    ssize_t n = ::writev(fd, iov, iovcnt);
+    if (n < 0)
+    {
+      *savedErrno = errno;
+    }
+    return n;
+  }
+
+  size_t total = 0;
+  int i = 0;
+  size_t offset = 0;  // in iov[i]
+  while (i < iovcnt)
+  {
+    const char* data = static_cast<const char*>(iov[i].iov_base) + offset;
+    size_t len = iov[i].iov_len - offset;
+    if (len < kMaxRecord && i + 1 < iovcnt)
+    {
+      // gather small pieces into one record
+      scratch_.resize(kMaxRecord);
+      len = 0;
+      for (int j = i; j < iovcnt && len < kMaxRecord; ++j)
+      {
+        const char* start = static_cast<const char*>(iov[j].iov_base) + (j == i ? offset : 0);
+        size_t piece = std::min(iov[j].iov_len - (j == i ? offset : 0), kMaxRecord - len);
+        memcpy(&scratch_[len], start, piece);
+        len += piece;
+      }
+      data = scratch_.data();
+    }
+    len = std::min(len, kMaxRecord);
+
+    size_t n = 0;
+    ERR_clear_error();
+    int ret = SSL_write_ex(ssl_, data, len, &n);
+    if (ret != 1)
+    {
+      int e = errorToErrno(ret, "TlsTransport::writev");
+      if (total > 0)
+      {
+        break;
+      }
+      *savedErrno = e;
+      return -1;
+    }
+    total += n;
+    // advance over what the record took
+    while (n > 0 && i < iovcnt)
+    {
+      size_t step = std::min(n, iov[i].iov_len - offset);
+      n -= step;
+      offset += step;
+      if (offset == iov[i].iov_len)
+      {
+        ++i;
+        offset = 0;
+      }
+    }
+  }
+  return static_cast<ssize_t>(total);
+}
+
+void TlsTransport::shutdown(int)
+{
+  if (SSL_is_init_finished(ssl_))
+  {
+    ERR_clear_error();
+    // sends close_notify, doesn't wait for the peer's
+    SSL_shutdown(ssl_);
+  }
+}
+
+int TlsTransport::errorToErrno(int ret, const char* where)
+{
+  int err = SSL_get_error(ssl_, ret);
+  switch (err)
+  {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+      return EAGAIN;
+    case SSL_ERROR_SYSCALL:
+      return errno != 0 ? errno : EPIPE;
+    default:
+    {
+      char buf[256];
+      ERR_error_string_n(ERR_get_error(), buf, sizeof buf);
+      LOG_ERROR << where << " " << buf;
+      // TcpConnection drops output and closes on EIO
+      return EIO;
+    }
+  }
+}
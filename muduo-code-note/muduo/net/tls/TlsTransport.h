@@ -0,0 +1,52 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_TLS_TLSTRANSPORT_H
+#define MUDUO_NET_TLS_TLSTRANSPORT_H
+
+#include <muduo/net/Transport.h>
+
+#include <vector>
+
+typedef struct ssl_st SSL;
+
+namespace muduo
+{
+namespace net
+{
+
+class TlsContext;
+
+///
+/// Transport of one connection, an SSL on the socket.
+///
+class TlsTransport : public Transport
+{
+ public:
+  // takes ssl
+  TlsTransport(TlsContext* context, SSL* ssl);
+  ~TlsTransport() override;
+
+  HandshakeResult handshake(int fd) override;
+  ssize_t read(int fd, Buffer* buf, int* savedErrno) override;
+  ssize_t writev(int fd, const struct iovec* iov, int iovcnt, int* savedErrno) override;
+  bool kernelSend() const override { return kernelSend_; }
+  void shutdown(int fd) override;
+
+ private:
+  // errno for an SSL_read/SSL_write error, EAGAIN if it has to wait
+  int errorToErrno(int ret, const char* where);
+
+  TlsContext* context_;
+  SSL* ssl_;
+  bool attached_;
+  bool kernelSend_;
+  std::vector<char> scratch_;  // small pieces gathered into one record
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TLS_TLSTRANSPORT_H
@@ -0,0 +1,292 @@
+// TLS connections with a self-signed certificate. The server answers
+// "hello" with a message and a file larger than socket buffers, then
+// closes, level and edge triggered. A client expecting another host
+// name, or none, fails the handshake, neither side sees a connection.
+// A peer that never handshakes is closed after the timeout.
+// Kernel TLS is used where the kernel has the "tls" ULP, otherwise
+// records are encrypted in user space, the bytes must be the same.
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/MonotonicTime.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+#include <muduo/net/TcpServer.h>
+#include <muduo/net/tls/TlsContext.h>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+//#define BOOST_TEST_MODULE TlsTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t kMessageSize = 2 * 1024 * 1024;
+const size_t kFileSize = 1024 * 1024;
+
+char expectedByte(size_t offset)
+{
+  return offset < kMessageSize
+      ? static_cast<char>('0' + offset % 10)
+      : static_cast<char>('a' + (offset - kMessageSize) % 26);
+}
+
+string tempFile(const char* pattern, FILE** fp)
+{
+  char name[64];
+  snprintf(name, sizeof name, "/tmp/muduo_tls_%s_XXXXXX", pattern);
+  int fd = ::mkstemp(name);
+  BOOST_REQUIRE(fd >= 0);
+  *fp = ::fdopen(fd, "w");
+  BOOST_REQUIRE(*fp != NULL);
+  return name;
+}
+
+// self-signed, CN=localhost
+void createCertificate(string* certFile, string* keyFile)
+{
+  EVP_PKEY* key = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256");
+  BOOST_REQUIRE(key != NULL);
+  X509* cert = X509_new();
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+  X509_set_pubkey(cert, key);
+  X509_NAME* name = X509_get_subject_name(cert);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+  BOOST_REQUIRE(X509_sign(cert, key, EVP_sha256()) > 0);
+
+  FILE* fp = NULL;
+  *keyFile = tempFile("key", &fp);
+  PEM_write_PrivateKey(fp, key, NULL, NULL, 0, NULL, NULL);
+  ::fclose(fp);
+  *certFile = tempFile("cert", &fp);
+  PEM_write_X509(fp, cert);
+  ::fclose(fp);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+}
+
+int createFile()
+{
+  char name[] = "/tmp/muduo_tls_file_XXXXXX";
+  int fd = ::mkstemp(name);
+  BOOST_REQUIRE(fd >= 0);
+  ::unlink(name);
+  string content;
+  for (size_t i = 0; i < kFileSize; ++i)
+  {
+    content.push_back(expectedByte(kMessageSize + i));
+  }
+  ssize_t n = ::write(fd, content.data(), content.size());
+  BOOST_REQUIRE_EQUAL(n, static_cast<ssize_t>(kFileSize));
+  return fd;
+}
+
+// a server with a self-signed certificate, and a client trusting it
+struct TlsFixture
+{
+  TlsFixture()
+    : fileFd(createFile()),
+      serverContext(TlsContext::kServer),
+      clientContext(TlsContext::kClient)
+  {
+    createCertificate(&certFile, &keyFile);
+    BOOST_REQUIRE(serverContext.loadCertificate(certFile, keyFile));
+    BOOST_REQUIRE(clientContext.loadVerifyLocations(certFile));
+    clientContext.setServerName("localhost");
+  }
+
+  ~TlsFixture()
+  {
+    ::close(fileFd);
+    ::unlink(certFile.c_str());
+    ::unlink(keyFile.c_str());
+  }
+
+  string certFile;
+  string keyFile;
+  const int fileFd;
+  TlsContext serverContext;
+  TlsContext clientContext;
+};
+
+void testTransfer(TlsContext* serverContext, TlsContext* clientContext,
+                  int fileFd, bool edgeTriggered)
+{
+  EventLoop loop;
+  if (edgeTriggered && !loop.supportsEdgeTriggered())
+  {
+    printf("poller doesn't support edge triggered, skipped\n");
+    return;
+  }
+  loop.runAfter(30.0, [] {
+    fprintf(stderr, "timeout\n");
+    abort();
+  });
+
+  InetAddress serverAddr(2042, true);
+  TcpServer server(&loop, serverAddr, "TlsServer");
+  server.setTransportFactory(serverContext->transportFactory());
+  server.setEdgeTriggered(edgeTriggered);
+  int closed = 0;
+  // quits after both connections are destroyed
+  auto onClose = [&] {
+    if (++closed == 2)
+    {
+      loop.runAfter(0.05, [&loop] { loop.quit(); });
+    }
+  };
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->disconnected())
+    {
+      onClose();
+    }
+  });
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    if (buf->readableBytes() < 5)
+    {
+      return;
+    }
+    BOOST_CHECK_EQUAL(buf->retrieveAsString(5), "hello");
+    string message;
+    for (size_t i = 0; i < kMessageSize; ++i)
+    {
+      message.push_back(expectedByte(i));
+    }
+    conn->send(message);
+    conn->sendFile(fileFd, 0, kFileSize);
+    conn->shutdown();
+  });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "TlsClient");
+  client.setTransportFactory(clientContext->transportFactory());
+  client.setEdgeTriggered(edgeTriggered);
+  size_t received = 0;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      conn->send("hello");
+    }
+    else
+    {
+      onClose();
+    }
+  });
+  client.setMessageCallback([&](const TcpConnectionPtr&, Buffer* buf, Timestamp) {
+    for (size_t i = 0; i < buf->readableBytes(); ++i)
+    {
+      if (buf->peek()[i] != expectedByte(received + i))
+      {
+        BOOST_FAIL("wrong byte at " << received + i);
+      }
+    }
+    received += buf->readableBytes();
+    buf->retrieveAll();
+  });
+  client.connect();
+  loop.loop();
+
+  BOOST_CHECK_EQUAL(received, kMessageSize + kFileSize);
+  printf("%s OK %zd bytes\n", edgeTriggered ? "edge" : "level", received);
+}
+
+// an empty serverName sets none
+void testWrongHost(TlsContext* serverContext, const string& certFile,
+                   const string& serverName)
+{
+  TlsContext clientContext(TlsContext::kClient);
+  clientContext.loadVerifyLocations(certFile);
+  if (!serverName.empty())
+  {
+    clientContext.setServerName(serverName);
+  }
+
+  EventLoop loop;
+  InetAddress serverAddr(2042, true);
+  TcpServer server(&loop, serverAddr, "TlsServer");
+  server.setTransportFactory(serverContext->transportFactory());
+  int connections = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr&) { ++connections; });
+  server.start();
+
+  TcpClient client(&loop, serverAddr, "TlsClient");
+  client.setTransportFactory(clientContext.transportFactory());
+  client.setConnectionCallback([&](const TcpConnectionPtr&) { ++connections; });
+  client.connect();
+  int64_t before = serverContext->numHandshakes();
+  loop.runAfter(1.0, [&loop] { loop.quit(); });
+  loop.loop();
+
+  BOOST_CHECK_EQUAL(connections, 0);
+  BOOST_CHECK_EQUAL(serverContext->numHandshakes(), before);
+  BOOST_CHECK_EQUAL(clientContext.numHandshakes(), 0);
+  printf("wrong host '%s' OK\n", serverName.c_str());
+}
+
+void testHandshakeTimeout(TlsContext* serverContext)
+{
+  EventLoop loop;
+  InetAddress serverAddr(2042, true);
+  TcpServer server(&loop, serverAddr, "TlsServer");
+  server.setTransportFactory(serverContext->transportFactory());
+  server.setHandshakeTimeout(100);
+  server.start();
+
+  // plain TCP, says nothing
+  TcpClient client(&loop, serverAddr, "SilentClient");
+  MonotonicTime connected;
+  double closedAfter = 0;
+  client.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      connected = MonotonicTime::now();
+    }
+    else
+    {
+      closedAfter = timeDifference(MonotonicTime::now(), connected);
+      loop.quit();
+    }
+  });
+  client.connect();
+  loop.runAfter(5.0, [] {
+    fprintf(stderr, "handshake timeout doesn't close\n");
+    abort();
+  });
+  loop.loop();
+
+  BOOST_CHECK(closedAfter >= 0.09 && closedAfter < 1.0);
+  printf("handshake timeout OK %.3fs\n", closedAfter);
+}
+
+BOOST_FIXTURE_TEST_CASE(testTlsTransfer, TlsFixture)
+{
+  Logger::setLogLevel(Logger::FATAL);
+  testTransfer(&serverContext, &clientContext, fileFd, false);
+  testTransfer(&serverContext, &clientContext, fileFd, true);
+  BOOST_CHECK_GT(serverContext.numHandshakes(), 0);
+  printf("handshakes %" PRId64 " kernel send %" PRId64 " kernel recv %" PRId64 "\n",
+         serverContext.numHandshakes(), serverContext.numKernelSend(),
+         serverContext.numKernelRecv());
+}
+
+BOOST_FIXTURE_TEST_CASE(testTlsRejected, TlsFixture)
+{
+  Logger::setLogLevel(Logger::FATAL);
+  testWrongHost(&serverContext, certFile, "example.com");
+  testWrongHost(&serverContext, certFile, "");
+  testHandshakeTimeout(&serverContext);
+}